@@ -0,0 +1,67 @@
+#include "CaseFoldedMatcher.h"
+
+#include <QtAlgorithms>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+CaseFoldedMatcher::CaseFoldedMatcher(const QString &pattern) {
+    m_folded.reserve(pattern.size());
+    for (const QChar ch : pattern) m_folded.append(fold(ch.unicode()));
+    if (m_folded.isEmpty()) return;
+
+    m_first = m_folded.first();
+    m_firstAlt = m_first;
+    if (m_first >= 'a' && m_first <= 'z') m_firstAlt = ushort(m_first - 'a' + 'A');
+    // 开尔文符号 K (U+212A) 和长 s (U+017F) 也会折叠成 k、s，只比较两种写法会漏掉它们
+    m_vectorScan = m_first < 0x80 && m_first != 'k' && m_first != 's';
+}
+
+ushort CaseFoldedMatcher::fold(ushort unit) {
+    if (unit < 0x80) return (unit >= 'A' && unit <= 'Z') ? ushort(unit + ('a' - 'A')) : unit;
+    return QChar(unit).toCaseFolded().unicode();
+}
+
+bool CaseFoldedMatcher::matchesAt(const ushort *text, int pos) const {
+    const int length = m_folded.size();
+    const ushort *pattern = m_folded.constData();
+    for (int i = 1; i < length; ++i) {
+        if (fold(text[pos + i]) != pattern[i]) return false;
+    }
+    return true;
+}
+
+int CaseFoldedMatcher::scanScalar(const ushort *text, int from, int last) const {
+    for (int pos = from; pos <= last; ++pos) {
+        if (fold(text[pos]) == m_first && matchesAt(text, pos)) return pos;
+    }
+    return -1;
+}
+
+bool CaseFoldedMatcher::matches(const QString &text) const {
+    if (m_folded.isEmpty()) return true;
+    const int last = text.size() - m_folded.size();  // 最后一个可能的起始位置
+    if (last < 0) return false;
+    const ushort *data = reinterpret_cast<const ushort *>(text.constData());
+
+    int pos = 0;
+#ifdef __SSE2__
+    if (m_vectorScan) {
+        const __m128i first = _mm_set1_epi16(short(m_first));
+        const __m128i firstAlt = _mm_set1_epi16(short(m_firstAlt));
+        // 起始位置 pos..pos+7 都不超过 last 时，读取的 8 个单元也都在字符串内
+        for (; pos + 8 <= last + 1; pos += 8) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+            const __m128i hits = _mm_or_si128(_mm_cmpeq_epi16(chunk, first), _mm_cmpeq_epi16(chunk, firstAlt));
+            quint32 mask = quint32(_mm_movemask_epi8(hits));
+            while (mask) {
+                const int bit = qCountTrailingZeroBits(mask);
+                if (matchesAt(data, pos + bit / 2)) return true;
+                mask &= ~(3u << bit);  // 每个 16 位单元占两个掩码位
+            }
+        }
+    }
+#endif
+    return scanScalar(data, pos, last) >= 0;
+}
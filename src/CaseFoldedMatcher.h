@@ -0,0 +1,28 @@
+#ifndef CASEFOLDEDMATCHER_H
+#define CASEFOLDEDMATCHER_H
+
+#include <QString>
+#include <QVector>
+
+// 忽略大小写的子串匹配，用于目录内筛选。模式在构造时折叠一次；
+// 匹配时先用 SSE2 一次比较 8 个 UTF-16 单元找出首字符的候选位置，再逐个核对。
+// 首字符不是 ASCII（或存在非 ASCII 大小写变体，如 k/s）时退回逐字符比较
+class CaseFoldedMatcher {
+public:
+    explicit CaseFoldedMatcher(const QString &pattern = QString());
+
+    bool isEmpty() const { return m_folded.isEmpty(); }
+    bool matches(const QString &text) const;
+
+private:
+    static ushort fold(ushort unit);
+    bool matchesAt(const ushort *text, int pos) const;
+    int scanScalar(const ushort *text, int from, int last) const;
+
+    QVector<ushort> m_folded;
+    ushort m_first {0};     // 折叠后的首字符
+    ushort m_firstAlt {0};  // 首字符的另一种大小写
+    bool m_vectorScan {false};
+};
+
+#endif // CASEFOLDEDMATCHER_H
@@ -0,0 +1,138 @@
+#include "ContentSearchView.h"
+#include "FileSizeFormat.h"
+#include "TextPreviewer.h"
+
+#include <QCheckBox>
+#include <QDir>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QSettings>
+#include <QSplitter>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace {
+constexpr int kPathRole = Qt::UserRole;
+constexpr int kLineRole = Qt::UserRole + 1;
+}
+
+ContentSearchView::ContentSearchView(QWidget *parent) : QWidget(parent) {
+    // 超过该大小的文件不搜索（MB），可在配置文件中调整
+    QSettings settings;
+    m_maxFileBytes = settings.value("search/contentMaxMB", 50).toLongLong() * 1024 * 1024;
+
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    auto *topBar = new QHBoxLayout();
+    m_regex = new QCheckBox(tr("正则"), this);
+    m_caseSensitive = new QCheckBox(tr("区分大小写"), this);
+    m_btnStop = new QPushButton(tr("停止"), this);
+    m_btnStop->setEnabled(false);
+    topBar->addWidget(m_regex);
+    topBar->addWidget(m_caseSensitive);
+    topBar->addStretch();
+    topBar->addWidget(m_btnStop);
+    layout->addLayout(topBar);
+
+    m_summary = new QLabel(this);
+    m_summary->setWordWrap(true);
+    layout->addWidget(m_summary);
+
+    auto *splitter = new QSplitter(Qt::Vertical, this);
+    m_results = new QTreeWidget(splitter);
+    m_results->setHeaderHidden(true);
+    m_results->setUniformRowHeights(true);
+    m_results->setTextElideMode(Qt::ElideMiddle);
+    m_preview = new TextPreviewer(splitter);
+    splitter->addWidget(m_results);
+    splitter->addWidget(m_preview);
+    splitter->setStretchFactor(0, 1);
+    splitter->setStretchFactor(1, 1);
+    layout->addWidget(splitter, 1);
+
+    m_searcher = new ContentSearcher(this);
+    connect(m_searcher, &ContentSearcher::matchesFound, this, &ContentSearchView::addMatches);
+    connect(m_searcher, &ContentSearcher::progress, this, [this](qint64 files, qint64 bytes) {
+        m_summary->setText(tr("正在搜索... 已读取 %1 个文件（%2），%3 个文件有匹配")
+                           .arg(files).arg(FileSizeFormat::format(bytes)).arg(m_fileItems.size()));
+    });
+    connect(m_searcher, &ContentSearcher::finished, this,
+            [this](qint64 files, qint64 bytes, int matches, bool truncated, qint64 elapsedMs) {
+        m_btnStop->setEnabled(false);
+        m_summary->setText(tr("%1 个文件中共 %2 处匹配；搜索了 %3 个文件（%4），用时 %5 毫秒%6")
+                           .arg(m_fileItems.size()).arg(matches).arg(files).arg(FileSizeFormat::format(bytes)).arg(elapsedMs)
+                           .arg(truncated ? tr("（结果过多，已提前停止）") : QString()));
+    });
+    connect(m_btnStop, &QPushButton::clicked, this, [this]() {
+        cancel();
+        m_summary->setText(tr("已停止：%1 个文件有匹配").arg(m_fileItems.size()));
+    });
+    connect(m_regex, &QCheckBox::toggled, this, &ContentSearchView::restart);
+    connect(m_caseSensitive, &QCheckBox::toggled, this, &ContentSearchView::restart);
+    connect(m_results, &QTreeWidget::currentItemChanged, this, &ContentSearchView::showMatch);
+    connect(m_results, &QTreeWidget::itemDoubleClicked, this, [this](QTreeWidgetItem *item) {
+        emit locateRequested(item->data(0, kPathRole).toString());
+    });
+}
+
+void ContentSearchView::search(const QString &root, const QString &pattern) {
+    m_root = root;
+    m_pattern = pattern;
+    restart();
+}
+
+void ContentSearchView::cancel() {
+    m_searcher->cancel();
+    m_btnStop->setEnabled(false);
+}
+
+void ContentSearchView::restart() {
+    cancel();
+    m_results->clear();
+    m_fileItems.clear();
+    m_previewPath.clear();
+    if (m_root.isEmpty() || m_pattern.isEmpty()) return;
+
+    ContentSearcher::Options options;
+    options.pattern = m_pattern;
+    options.regex = m_regex->isChecked();
+    options.caseSensitive = m_caseSensitive->isChecked();
+    options.maxFileBytes = m_maxFileBytes;
+    QString error;
+    if (!ContentSearcher::validate(options, &error)) {
+        m_summary->setText(tr("无效的搜索条件：%1").arg(error));
+        return;
+    }
+    m_summary->setText(tr("正在搜索 %1 ...").arg(m_root));
+    m_btnStop->setEnabled(true);
+    m_searcher->start(m_root, options);
+}
+
+void ContentSearchView::addMatches(const QVector<ContentSearcher::Match> &matches) {
+    const QDir root(m_root);
+    for (const ContentSearcher::Match &match : matches) {
+        QTreeWidgetItem *&fileItem = m_fileItems[match.path];
+        if (!fileItem) {
+            fileItem = new QTreeWidgetItem(m_results, {root.relativeFilePath(match.path)});
+            fileItem->setData(0, kPathRole, match.path);
+            fileItem->setData(0, kLineRole, 0);
+            fileItem->setToolTip(0, match.path);
+            fileItem->setExpanded(true);
+        }
+        auto *lineItem = new QTreeWidgetItem(fileItem, {QString("%1: %2").arg(match.line).arg(match.text.trimmed())});
+        lineItem->setData(0, kPathRole, match.path);
+        lineItem->setData(0, kLineRole, match.line);
+    }
+}
+
+void ContentSearchView::showMatch(QTreeWidgetItem *item) {
+    if (!item) return;
+    const QString path = item->data(0, kPathRole).toString();
+    if (path != m_previewPath) {
+        if (!m_preview->loadText(path)) return;
+        m_previewPath = path;
+    }
+    const int line = item->data(0, kLineRole).toInt();
+    if (line > 0) m_preview->highlightLine(line);
+}
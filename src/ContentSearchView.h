@@ -0,0 +1,50 @@
+#ifndef CONTENTSEARCHVIEW_H
+#define CONTENTSEARCHVIEW_H
+
+#include <QHash>
+#include <QWidget>
+
+#include "ContentSearcher.h"
+
+class TextPreviewer;
+class QCheckBox;
+class QLabel;
+class QPushButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+// 文件内容搜索结果：按文件分组列出匹配的行，结果在搜索过程中陆续加入。
+// 单击某行在下方的文本预览中定位到该行，双击在主窗口中打开所在目录
+class ContentSearchView : public QWidget {
+    Q_OBJECT
+public:
+    explicit ContentSearchView(QWidget *parent = nullptr);
+
+    // 在 root 下搜索 pattern（取消之前的搜索）
+    void search(const QString &root, const QString &pattern);
+    void cancel();
+
+signals:
+    void locateRequested(const QString &path);
+
+private:
+    void restart();
+    void addMatches(const QVector<ContentSearcher::Match> &matches);
+    void showMatch(QTreeWidgetItem *item);
+
+    ContentSearcher *m_searcher {nullptr};
+    QLabel *m_summary {nullptr};
+    QCheckBox *m_regex {nullptr};
+    QCheckBox *m_caseSensitive {nullptr};
+    QPushButton *m_btnStop {nullptr};
+    QTreeWidget *m_results {nullptr};
+    TextPreviewer *m_preview {nullptr};
+
+    QString m_root;
+    QString m_pattern;
+    qint64 m_maxFileBytes {0};
+    QHash<QString, QTreeWidgetItem *> m_fileItems;
+    QString m_previewPath;
+};
+
+#endif // CONTENTSEARCHVIEW_H
@@ -0,0 +1,483 @@
+#include "ContentSearcher.h"
+#include "DirectoryReader.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+// 结果和进度的最小发送间隔
+constexpr qint64 kPublishIntervalMs = 100;
+// 小于该大小的文件直接读入缓冲区，映射的开销反而更大
+constexpr qint64 kMapThreshold = 64 * 1024;
+// 只检查开头这么多字节是否含 NUL 来判断二进制文件
+constexpr qint64 kBinarySniffBytes = 8192;
+constexpr int kMaxMatchesPerFile = 200;
+constexpr int kMaxPreviewChars = 300;
+
+inline char foldAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+// 字面量扫描：SSE2 下同时比较候选位置的首字节和末字节（16 个位置一组），两者都相符再逐字节核对，
+// 与 memchr 只看首字节相比误报少得多。不区分大小写时只折叠 ASCII 字母
+class LiteralScanner {
+public:
+    LiteralScanner(const QByteArray &needle, bool foldCase) : m_needle(needle), m_foldCase(foldCase) {
+        if (foldCase) {
+            for (char &c : m_needle) c = foldAscii(c);
+        }
+    }
+
+    bool isEmpty() const { return m_needle.isEmpty(); }
+
+    // 从 from 开始查找，返回匹配的起始位置，找不到返回 -1
+    qint64 find(const char *data, qint64 size, qint64 from) const {
+        const qint64 n = m_needle.size();
+        const qint64 last = size - n;  // 最后一个可能的起始位置
+        qint64 pos = from;
+#ifdef __SSE2__
+        const char head = m_needle.at(0);
+        const char tail = m_needle.at(int(n - 1));
+        const __m128i headBytes = _mm_set1_epi8(head);
+        const __m128i tailBytes = _mm_set1_epi8(tail);
+        // 字母不区分大小写时把输入的 0x20 位置 1 再与小写字母比较，只有对应的大小写字母会相等
+        const __m128i headCase = _mm_set1_epi8(m_foldCase && head >= 'a' && head <= 'z' ? 0x20 : 0);
+        const __m128i tailCase = _mm_set1_epi8(m_foldCase && tail >= 'a' && tail <= 'z' ? 0x20 : 0);
+        for (; pos + 16 <= last + 1; pos += 16) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos + n - 1));
+            const __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(_mm_or_si128(a, headCase), headBytes),
+                                               _mm_cmpeq_epi8(_mm_or_si128(b, tailCase), tailBytes));
+            quint32 mask = quint32(_mm_movemask_epi8(hits));
+            while (mask) {
+                const int bit = qCountTrailingZeroBits(mask);
+                if (matchesAt(data + pos + bit)) return pos + bit;
+                mask &= mask - 1;
+            }
+        }
+#endif
+        if (!m_foldCase) {
+            // 剩余部分（或没有 SSE2 时）由 memchr 定位首字节
+            const char first = m_needle.at(0);
+            while (pos <= last) {
+                const void *hit = std::memchr(data + pos, first, size_t(last - pos + 1));
+                if (!hit) return -1;
+                pos = static_cast<const char *>(hit) - data;
+                if (matchesAt(data + pos)) return pos;
+                ++pos;
+            }
+            return -1;
+        }
+        for (; pos <= last; ++pos) {
+            if (matchesAt(data + pos)) return pos;
+        }
+        return -1;
+    }
+
+private:
+    bool matchesAt(const char *p) const {
+        const int n = m_needle.size();
+        if (!m_foldCase) return std::memcmp(p, m_needle.constData(), size_t(n)) == 0;
+        const char *needle = m_needle.constData();
+        for (int i = 0; i < n; ++i) {
+            if (foldAscii(p[i]) != needle[i]) return false;
+        }
+        return true;
+    }
+
+    QByteArray m_needle;
+    bool m_foldCase;
+};
+
+// 取出正则表达式中每次匹配都必须出现的最长一段字面量，用于预筛选；
+// 含分支、内联选项等无法简单判断的结构时返回空（逐行用正则匹配）
+QString requiredLiteral(const QString &pattern) {
+    if (pattern.contains('|') || pattern.contains(QLatin1String("(?"))) return QString();
+    const QString meta = QStringLiteral(".^$*+?()[]{}\\");
+    QString best;
+    QString run;
+    int depth = 0;  // 分组可能整体可选，其中的字面量不采用
+    auto endRun = [&]() {
+        if (run.size() > best.size()) best = run;
+        run.clear();
+    };
+    for (int i = 0; i < pattern.size(); ++i) {
+        const QChar c = pattern.at(i);
+        QChar literal;
+        if (c == '\\' && i + 1 < pattern.size()) {
+            // 转义的标点是字面量，\d \w \n 等字符类不是。\x41 \p{Lu} \Q…\E 等带参数的转义、
+            // 反向引用及不认识的转义，其后的字符不是字面文本，无法可靠提取，整个模式不做预筛选
+            static const QString plainEscapes = QStringLiteral("dDwWsSbBhHvVRnrtfeaAzZGK");
+            const QChar next = pattern.at(++i);
+            if (next.isLetterOrNumber()) {
+                if (!plainEscapes.contains(next)) return QString();
+                endRun();
+                continue;
+            }
+            literal = next;
+        } else if (c == '[') {
+            endRun();
+            // 跳过字符集合
+            int j = i + 1;
+            if (j < pattern.size() && pattern.at(j) == '^') ++j;
+            if (j < pattern.size() && pattern.at(j) == ']') ++j;
+            while (j < pattern.size() && pattern.at(j) != ']') {
+                if (pattern.at(j) == '\\') ++j;
+                ++j;
+            }
+            i = j;
+            continue;
+        } else if (c == '{') {
+            // 量词 {n} {n,} {n,m} 中的数字不是字面量，整体跳过（前面的字符已因后跟 { 而不计入）；
+            // 不构成量词的 { 是字面量，这类写法少见，整个模式不做预筛选
+            int j = i + 1;
+            const int digitsStart = j;
+            while (j < pattern.size() && pattern.at(j).isDigit()) ++j;
+            if (j == digitsStart) return QString();
+            if (j < pattern.size() && pattern.at(j) == ',') {
+                ++j;
+                while (j < pattern.size() && pattern.at(j).isDigit()) ++j;
+            }
+            if (j >= pattern.size() || pattern.at(j) != '}') return QString();
+            endRun();
+            i = j;
+            continue;
+        } else if (meta.contains(c)) {
+            if (c == '(') ++depth;
+            if (c == ')' && depth > 0) --depth;
+            endRun();
+            continue;
+        } else {
+            literal = c;
+        }
+        // 后面跟着 ? * { 的字符可以不出现，不能算在字面量里；跟着 + 时至少出现一次，但之后不再连续
+        const QChar quantifier = i + 1 < pattern.size() ? pattern.at(i + 1) : QChar();
+        if (quantifier == '?' || quantifier == '*' || quantifier == '{') {
+            endRun();
+            continue;
+        }
+        if (depth > 0) continue;
+        run.append(literal);
+        if (quantifier == '+') endRun();
+    }
+    endRun();
+    return best;
+}
+
+QString previewText(const char *data, qint64 length) {
+    QString text = QString::fromUtf8(data, int(qMin<qint64>(length, kMaxPreviewChars * 4)));
+    if (text.size() > kMaxPreviewChars) text = text.left(kMaxPreviewChars) + QStringLiteral("…");
+    return text;
+}
+}
+
+struct ContentSearcher::Job {
+    QString root;
+    Options options;
+    QByteArray literal;  // 预筛选用的字面量（UTF-8），为空时逐行匹配正则
+    std::atomic_bool cancelled {false};
+    std::atomic_bool limitReached {false};
+
+    QMutex mutex;
+    QWaitCondition wake;
+    std::deque<QByteArray> pendingFiles;  // 先处理文件，避免待读文件在队列中积压
+    std::deque<QByteArray> pendingDirs;
+    int busy {0};
+    int workers {0};
+
+    std::atomic<qint64> files {0};
+    std::atomic<qint64> bytes {0};
+    std::atomic<int> matches {0};
+
+    QElapsedTimer timer;
+    std::atomic<qint64> nextPublishMs {kPublishIntervalMs};
+    QMutex outboxMutex;
+    QVector<Match> outbox;
+};
+
+ContentSearcher::ContentSearcher(QObject *parent) : QObject(parent) {
+    // 文件内容多半已在页缓存中，主要消耗 CPU，按核心数开线程
+    m_pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+}
+
+ContentSearcher::~ContentSearcher() {
+    cancel();
+    m_pool.waitForDone();
+}
+
+bool ContentSearcher::validate(const Options &options, QString *error) {
+    if (options.pattern.isEmpty()) {
+        if (error) *error = tr("搜索内容为空");
+        return false;
+    }
+    if (!options.regex) return true;
+    const QRegularExpression re(options.pattern);
+    if (!re.isValid()) {
+        if (error) *error = re.errorString();
+        return false;
+    }
+    return true;
+}
+
+void ContentSearcher::start(const QString &root, const Options &options) {
+    cancel();
+    if (!validate(options, nullptr)) return;
+
+    auto job = std::make_shared<Job>();
+    job->root = root;
+    job->options = options;
+    job->literal = (options.regex ? requiredLiteral(options.pattern) : options.pattern).toUtf8();
+    // 正则不区分大小写时非 ASCII 字母也会折叠，字面量扫描只折叠 ASCII，此时不做预筛选
+    if (options.regex && !options.caseSensitive
+        && std::any_of(job->literal.cbegin(), job->literal.cend(), [](char c) { return uchar(c) >= 0x80; })) {
+        job->literal.clear();
+    }
+    job->pendingDirs.push_back(QFile::encodeName(root));
+    job->timer.start();
+    job->workers = m_pool.maxThreadCount();
+    m_job = job;
+    for (int i = 0; i < job->workers; ++i) {
+        m_pool.start([this, job]() { workerLoop(job); });
+    }
+}
+
+void ContentSearcher::cancel() {
+    if (!m_job) return;
+    m_job->cancelled.store(true);
+    {
+        QMutexLocker locker(&m_job->mutex);
+        m_job->wake.wakeAll();
+    }
+    m_job.reset();
+}
+
+void ContentSearcher::workerLoop(const std::shared_ptr<Job> &job) {
+    // 每个线程使用自己的正则表达式对象
+    QRegularExpression re;
+    if (job->options.regex) {
+        re.setPattern(job->options.pattern);
+        if (!job->options.caseSensitive) re.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+        re.optimize();
+    }
+    QVector<Match> matches;
+
+    for (;;) {
+        QByteArray path;
+        bool isDir = false;
+        {
+            QMutexLocker locker(&job->mutex);
+            while (job->pendingFiles.empty() && job->pendingDirs.empty() && job->busy > 0
+                   && !job->cancelled.load() && !job->limitReached.load()) {
+                job->wake.wait(&job->mutex);
+            }
+            if (job->cancelled.load() || job->limitReached.load()
+                || (job->pendingFiles.empty() && job->pendingDirs.empty())) {
+                job->wake.wakeAll();
+                const bool last = --job->workers == 0;
+                locker.unlock();
+                publish(job, matches, true);
+                if (last && !job->cancelled.load()) finishJob(job);
+                return;
+            }
+            if (!job->pendingFiles.empty()) {
+                path = job->pendingFiles.front();
+                job->pendingFiles.pop_front();
+            } else {
+                path = job->pendingDirs.front();
+                job->pendingDirs.pop_front();
+                isDir = true;
+            }
+            ++job->busy;
+        }
+
+        if (isDir) {
+            scanDirectory(job, path);
+        } else {
+            searchFile(job, path, re, matches);
+        }
+        publish(job, matches, false);
+
+        QMutexLocker locker(&job->mutex);
+        if (--job->busy == 0 && job->pendingFiles.empty() && job->pendingDirs.empty()) {
+            job->wake.wakeAll();
+        }
+    }
+}
+
+void ContentSearcher::scanDirectory(const std::shared_ptr<Job> &job, const QByteArray &dir) {
+    std::vector<QByteArray> files;
+    std::vector<QByteArray> subdirs;
+    const QByteArray prefix = dir.endsWith('/') ? dir : dir + '/';
+
+    DirectoryReader::read(dir, [&](const DirectoryEntry &entry) {
+        if (job->cancelled.load(std::memory_order_relaxed)) return false;
+        // 与 ripgrep 的默认行为一样跳过隐藏文件和目录（.git 等）；不跟随指向目录的符号链接
+        if (entry.name[0] == '.') return true;
+        (entry.isDir ? subdirs : files).push_back(prefix + entry.name);
+        return true;
+    });
+    if (files.empty() && subdirs.empty()) return;
+
+    QMutexLocker locker(&job->mutex);
+    for (QByteArray &file : files) job->pendingFiles.push_back(std::move(file));
+    for (QByteArray &subdir : subdirs) job->pendingDirs.push_back(std::move(subdir));
+    job->wake.wakeAll();
+}
+
+void ContentSearcher::searchFile(const std::shared_ptr<Job> &job, const QByteArray &path,
+                                 const QRegularExpression &re, QVector<Match> &out) {
+    const char *data = nullptr;
+    qint64 size = 0;
+    QByteArray buffer;
+#ifdef Q_OS_UNIX
+    // 非阻塞打开：遇到 FIFO 等特殊文件时不会卡住，随后按 fstat 结果跳过
+    const int fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) return;
+    struct stat st;
+    void *mapped = MAP_FAILED;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0 || st.st_size > job->options.maxFileBytes) {
+        ::close(fd);
+        return;
+    }
+    size = st.st_size;
+    if (size < kMapThreshold) {
+        buffer.resize(int(size));
+        qint64 done = 0;
+        while (done < size) {
+            const ssize_t n = ::read(fd, buffer.data() + done, size_t(size - done));
+            if (n <= 0) break;
+            done += n;
+        }
+        size = done;
+        data = buffer.constData();
+    } else {
+        mapped = ::mmap(nullptr, size_t(size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            ::madvise(mapped, size_t(size), MADV_SEQUENTIAL);
+            data = static_cast<const char *>(mapped);
+        }
+    }
+    ::close(fd);
+    if (!data) return;
+#else
+    QFile file(QFile::decodeName(path));
+    if (!file.open(QIODevice::ReadOnly)) return;
+    size = file.size();
+    if (size == 0 || size > job->options.maxFileBytes) return;
+    const uchar *mapped = file.map(0, size);
+    if (mapped) {
+        data = reinterpret_cast<const char *>(mapped);
+    } else {
+        buffer = file.readAll();
+        data = buffer.constData();
+        size = buffer.size();
+    }
+#endif
+
+    ++job->files;
+    job->bytes += size;
+
+    // 开头出现 NUL 字节视为二进制文件
+    if (!std::memchr(data, 0, size_t(qMin(size, kBinarySniffBytes)))) {
+        const LiteralScanner scanner(job->literal, !job->options.caseSensitive);
+        const QString filePath = QFile::decodeName(path);
+        qint64 pos = 0;
+        qint64 counted = 0;
+        int line = 1;
+        int fileMatches = 0;
+        while (pos < size && !job->cancelled.load(std::memory_order_relaxed)) {
+            qint64 hit = pos;
+            if (!scanner.isEmpty()) {
+                hit = scanner.find(data, size, pos);
+                if (hit < 0) break;
+            }
+            // 命中所在行的范围；pos 总是位于行首，向前找换行符不会越过 pos
+            qint64 lineStart = hit;
+            while (lineStart > pos && data[lineStart - 1] != '\n') --lineStart;
+            const void *newline = std::memchr(data + hit, '\n', size_t(size - hit));
+            const qint64 lineEnd = newline ? static_cast<const char *>(newline) - data : size;
+            line += int(std::count(data + counted, data + lineStart, '\n'));
+            counted = lineStart;
+            pos = lineEnd + 1;
+
+            qint64 length = lineEnd - lineStart;
+            if (length > 0 && data[lineStart + length - 1] == '\r') --length;
+            if (job->options.regex) {
+                const QString text = QString::fromUtf8(data + lineStart, int(length));
+                if (!re.match(text).hasMatch()) continue;
+            }
+            out.append({filePath, line, previewText(data + lineStart, length)});
+            if (++job->matches >= job->options.maxMatches) {
+                job->limitReached.store(true);
+                break;
+            }
+            if (++fileMatches >= kMaxMatchesPerFile) break;
+        }
+    }
+
+#ifdef Q_OS_UNIX
+    if (mapped != MAP_FAILED) ::munmap(mapped, size_t(size));
+#endif
+}
+
+void ContentSearcher::publish(const std::shared_ptr<Job> &job, QVector<Match> &matches, bool force) {
+    if (!matches.isEmpty()) {
+        QMutexLocker locker(&job->outboxMutex);
+        job->outbox += matches;
+        matches.clear();
+    }
+    // 只有抢到本次时间片的线程发送结果和进度
+    qint64 next = job->nextPublishMs.load();
+    const qint64 now = job->timer.elapsed();
+    if (!force && (now < next || !job->nextPublishMs.compare_exchange_strong(next, now + kPublishIntervalMs))) return;
+
+    QVector<Match> batch;
+    {
+        QMutexLocker locker(&job->outboxMutex);
+        batch.swap(job->outbox);
+    }
+    const qint64 files = job->files.load();
+    const qint64 bytes = job->bytes.load();
+    QMetaObject::invokeMethod(this, [this, job, batch, files, bytes]() {
+        if (job != m_job) return;
+        if (!batch.isEmpty()) emit matchesFound(batch);
+        emit progress(files, bytes);
+    }, Qt::QueuedConnection);
+}
+
+void ContentSearcher::finishJob(const std::shared_ptr<Job> &job) {
+    const qint64 files = job->files.load();
+    const qint64 bytes = job->bytes.load();
+    const int matches = qMin(job->matches.load(), job->options.maxMatches);
+    const bool truncated = job->limitReached.load();
+    const qint64 elapsed = job->timer.elapsed();
+    // 排在各线程最后一批结果之后发出
+    QMetaObject::invokeMethod(this, [this, job, files, bytes, matches, truncated, elapsed]() {
+        if (job != m_job) return;
+        m_job.reset();
+        emit finished(files, bytes, matches, truncated, elapsed);
+    }, Qt::QueuedConnection);
+}
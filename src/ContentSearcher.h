@@ -0,0 +1,66 @@
+#ifndef CONTENTSEARCHER_H
+#define CONTENTSEARCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include <memory>
+
+class QRegularExpression;
+
+// 在目录树中搜索文件内容（类似 grep/ripgrep）：多个线程并行遍历目录和读取文件，
+// 大文件内存映射、小文件整块读入，先用 SIMD 扫描字面量（正则表达式取其中必须出现的一段字面量）
+// 找到候选行再核对。跳过隐藏文件、含 NUL 字节的二进制文件和超过大小上限的文件。
+// 匹配结果分批发出，超过结果上限时提前结束
+class ContentSearcher : public QObject {
+    Q_OBJECT
+public:
+    struct Options {
+        QString pattern;
+        bool regex {false};
+        bool caseSensitive {false};  // 不区分大小写时只折叠 ASCII 字母
+        qint64 maxFileBytes {50 * 1024 * 1024};
+        int maxMatches {10000};
+    };
+
+    struct Match {
+        QString path;
+        int line {0};     // 从 1 开始
+        QString text;     // 该行内容（过长时截断）
+    };
+
+    explicit ContentSearcher(QObject *parent = nullptr);
+    ~ContentSearcher() override;
+
+    // 检查模式是否可用（正则表达式能否编译）
+    static bool validate(const Options &options, QString *error);
+
+    // 开始在 root 下搜索（取消之前的任务）
+    void start(const QString &root, const Options &options);
+    void cancel();
+    bool isRunning() const { return m_job != nullptr; }
+
+signals:
+    void matchesFound(const QVector<ContentSearcher::Match> &matches);
+    void progress(qint64 files, qint64 bytes);
+    // truncated 为 true 表示达到结果上限后提前结束
+    void finished(qint64 files, qint64 bytes, int matches, bool truncated, qint64 elapsedMs);
+
+private:
+    struct Job;
+
+    void workerLoop(const std::shared_ptr<Job> &job);
+    void scanDirectory(const std::shared_ptr<Job> &job, const QByteArray &dir);
+    void searchFile(const std::shared_ptr<Job> &job, const QByteArray &path, const QRegularExpression &re,
+                    QVector<Match> &out);
+    void publish(const std::shared_ptr<Job> &job, QVector<Match> &matches, bool force);
+    void finishJob(const std::shared_ptr<Job> &job);
+
+    QThreadPool m_pool;
+    // 只在界面线程访问
+    std::shared_ptr<Job> m_job;
+};
+
+#endif // CONTENTSEARCHER_H
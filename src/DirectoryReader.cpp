@@ -0,0 +1,196 @@
+#include "DirectoryReader.h"
+
+#include <QDateTime>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_LINUX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef Q_OS_LINUX
+// getdents64 返回的目录项布局（glibc 未导出该结构）
+struct LinuxDirent64 {
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+// 相对于已打开的目录读取条目属性，不跟随符号链接；优先使用只请求所需字段的 statx
+bool statAt(int dirFd, const char *name, DirectoryEntry &out) {
+#ifdef STATX_BLOCKS
+    struct statx stx;
+    if (::statx(dirFd, name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT | AT_STATX_DONT_SYNC,
+                STATX_TYPE | STATX_INO | STATX_NLINK | STATX_BLOCKS | STATX_MTIME, &stx) != 0) {
+        return false;
+    }
+    out.isDir = S_ISDIR(stx.stx_mode);
+    out.dev = (quint64(stx.stx_dev_major) << 32) | stx.stx_dev_minor;
+    out.ino = stx.stx_ino;
+    out.nlink = stx.stx_nlink;
+    out.allocated = qint64(stx.stx_blocks) * 512;
+    out.mtimeNs = qint64(stx.stx_mtime.tv_sec) * 1000000000 + stx.stx_mtime.tv_nsec;
+#else
+    struct stat st;
+    if (::fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT) != 0) {
+        return false;
+    }
+    out.isDir = S_ISDIR(st.st_mode);
+    out.dev = st.st_dev;
+    out.ino = st.st_ino;
+    out.nlink = st.st_nlink;
+    out.allocated = qint64(st.st_blocks) * 512;
+    out.mtimeNs = qint64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+#endif
+}
+
+bool DirectoryReader::read(const QByteArray &dir, const std::function<bool(const DirectoryEntry &)> &visit) {
+#ifdef Q_OS_LINUX
+    const int fd = ::open(dir.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    alignas(8) char buffer[64 * 1024];
+    bool stop = false;
+    while (!stop) {
+        const long n = ::syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+        if (n <= 0) break;
+        for (long offset = 0; offset < n && !stop;) {
+            const auto *dirent = reinterpret_cast<const LinuxDirent64 *>(buffer + offset);
+            offset += dirent->d_reclen;
+            const char *name = dirent->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+            DirectoryEntry entry;
+            if (!statAt(fd, name, entry)) continue;
+            entry.name = name;
+            stop = !visit(entry);
+        }
+    }
+    ::close(fd);
+    return true;
+#else
+    QDirIterator it(QFile::decodeName(dir), QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+    if (!QFileInfo(QFile::decodeName(dir)).isReadable()) return false;
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        if (info.isSymLink()) continue;
+        const QByteArray name = QFile::encodeName(info.fileName());
+        DirectoryEntry entry;
+        entry.name = name.constData();
+        entry.isDir = info.isDir();
+        entry.allocated = entry.isDir ? 0 : info.size();
+        if (!visit(entry)) break;
+    }
+    return true;
+#endif
+}
+
+bool DirectoryReader::stat(const QByteArray &path, DirectoryEntry &entry) {
+#ifdef Q_OS_LINUX
+    return statAt(AT_FDCWD, path.constData(), entry);
+#else
+    const QFileInfo info(QFile::decodeName(path));
+    if (!info.exists()) return false;
+    entry.isDir = info.isDir();
+    entry.allocated = entry.isDir ? 0 : info.size();
+    entry.mtimeNs = info.lastModified().toMSecsSinceEpoch() * 1000000;
+    return true;
+#endif
+}
+
+bool DirectoryReader::list(const QByteArray &dir, const std::function<bool(const char *, EntryType)> &visit) {
+#ifdef Q_OS_LINUX
+    const int fd = ::open(dir.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    // 百万级条目的目录用 1 MB 缓冲区，一次系统调用可以取回上万个条目
+    std::vector<char> buffer(1024 * 1024);
+    bool stop = false;
+    while (!stop) {
+        const long n = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        if (n <= 0) break;
+        for (long offset = 0; offset < n && !stop;) {
+            const auto *dirent = reinterpret_cast<const LinuxDirent64 *>(buffer.data() + offset);
+            offset += dirent->d_reclen;
+            const char *name = dirent->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+            EntryType type = EntryType::Unknown;
+            switch (dirent->d_type) {
+            case DT_REG: type = EntryType::File; break;
+            case DT_DIR: type = EntryType::Directory; break;
+            case DT_LNK: type = EntryType::Symlink; break;
+            case DT_UNKNOWN: break;
+            default: type = EntryType::Other; break;
+            }
+            stop = !visit(name, type);
+        }
+    }
+    ::close(fd);
+    return true;
+#else
+    if (!QFileInfo(QFile::decodeName(dir)).isReadable()) return false;
+    QDirIterator it(QFile::decodeName(dir), QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        const EntryType type = info.isSymLink() ? EntryType::Symlink
+                             : info.isDir()     ? EntryType::Directory
+                             : info.isFile()    ? EntryType::File : EntryType::Other;
+        if (!visit(QFile::encodeName(info.fileName()).constData(), type)) break;
+    }
+    return true;
+#endif
+}
+
+void DirectoryReader::statBatch(const QByteArray &dir, const std::vector<QByteArray> &names, std::vector<FileAttributes> &out) {
+    out.assign(names.size(), FileAttributes());
+#ifdef Q_OS_LINUX
+    const int fd = ::open(dir.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return;
+    for (size_t i = 0; i < names.size(); ++i) {
+        FileAttributes &attributes = out[i];
+#ifdef STATX_SIZE
+        // 网络文件系统上不强制与服务器同步属性
+        struct statx stx;
+        if (::statx(fd, names[i].constData(), AT_NO_AUTOMOUNT | AT_STATX_DONT_SYNC,
+                    STATX_TYPE | STATX_SIZE | STATX_MTIME, &stx) != 0) {
+            continue;
+        }
+        attributes.isDir = S_ISDIR(stx.stx_mode);
+        attributes.size = qint64(stx.stx_size);
+        attributes.mtimeNs = qint64(stx.stx_mtime.tv_sec) * 1000000000 + stx.stx_mtime.tv_nsec;
+#else
+        struct stat st;
+        if (::fstatat(fd, names[i].constData(), &st, AT_NO_AUTOMOUNT) != 0) continue;
+        attributes.isDir = S_ISDIR(st.st_mode);
+        attributes.size = qint64(st.st_size);
+        attributes.mtimeNs = qint64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+        attributes.valid = true;
+    }
+    ::close(fd);
+#else
+    const QString prefix = QFile::decodeName(dir) + '/';
+    for (size_t i = 0; i < names.size(); ++i) {
+        const QFileInfo info(prefix + QFile::decodeName(names[i]));
+        if (!info.exists()) continue;
+        out[i].valid = true;
+        out[i].isDir = info.isDir();
+        out[i].size = info.size();
+        out[i].mtimeNs = info.lastModified().toMSecsSinceEpoch() * 1000000;
+    }
+#endif
+}
@@ -0,0 +1,48 @@
+#ifndef DIRECTORYREADER_H
+#define DIRECTORYREADER_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+#include <functional>
+#include <vector>
+
+// 单个目录项的属性（不跟随符号链接）
+struct DirectoryEntry {
+    const char *name {nullptr};  // 只在回调期间有效
+    bool isDir {false};
+    quint64 dev {0};
+    quint64 ino {0};              // 不支持的平台上为 0
+    quint64 nlink {1};
+    qint64 allocated {0};         // 实际分配的磁盘空间
+    qint64 mtimeNs {0};           // 修改时间（纳秒）
+};
+
+// 只读名称时得到的类型（来自 getdents64 的 d_type，文件系统不提供时为 Unknown）
+enum class EntryType : quint8 { Unknown, File, Directory, Symlink, Other };
+
+// 文件视图需要的属性（跟随符号链接）
+struct FileAttributes {
+    bool valid {false};
+    bool isDir {false};
+    qint64 size {0};
+    qint64 mtimeNs {0};
+};
+
+// 快速读取目录：Linux 下用 getdents64 成批读取，再用 statx 相对目录句柄只查询所需字段，
+// 其它平台退回 QDirIterator。供需要遍历大量文件的后台统计使用
+class DirectoryReader {
+public:
+    // 逐项回调 visit（不含 . 和 ..），visit 返回 false 时提前结束；目录无法打开时返回 false
+    static bool read(const QByteArray &dir, const std::function<bool(const DirectoryEntry &)> &visit);
+
+    // 目录本身的属性
+    static bool stat(const QByteArray &path, DirectoryEntry &entry);
+
+    // 只列出名称和类型，不查询属性；使用较大的缓冲区减少系统调用次数。name 只在回调期间有效
+    static bool list(const QByteArray &dir, const std::function<bool(const char *name, EntryType type)> &visit);
+    // 在同一目录下成批查询属性，只请求类型、大小和修改时间；out 与 names 一一对应
+    static void statBatch(const QByteArray &dir, const std::vector<QByteArray> &names, std::vector<FileAttributes> &out);
+};
+
+#endif // DIRECTORYREADER_H
@@ -0,0 +1,210 @@
+#include "DirectorySizeCalculator.h"
+#include "DirectoryReader.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QPair>
+#include <QSet>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <deque>
+#include <vector>
+
+namespace {
+// 进度信号的最小间隔，避免大目录遍历时刷屏
+constexpr qint64 kProgressIntervalMs = 100;
+// 缓存的统计结果数量上限
+constexpr int kMaxCachedResults = 256;
+}
+
+struct DirectorySizeCalculator::Job {
+    QString root;
+    QString key;
+    quint64 rootDev {0};
+    std::atomic_bool cancelled {false};
+
+    QMutex mutex;
+    QWaitCondition wake;
+    std::deque<QByteArray> pending;  // 待遍历的目录（本地编码路径）
+    int busy {0};                    // 正在遍历目录的线程数
+    int workers {0};                 // 尚未退出的工作线程数
+    QSet<QPair<quint64, quint64>> seenInodes;  // 多个硬链接的文件 (设备, inode)
+
+    std::atomic<qint64> bytes {0};
+    std::atomic<qint64> files {0};
+    std::atomic<qint64> dirs {0};
+
+    QElapsedTimer timer;
+    std::atomic<qint64> nextProgressMs {kProgressIntervalMs};
+};
+
+DirectorySizeCalculator::DirectorySizeCalculator(QObject *parent) : QObject(parent) {
+    // 遍历主要等待磁盘 IO，线程数不必超过核心数太多
+    m_pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 8));
+}
+
+DirectorySizeCalculator::~DirectorySizeCalculator() {
+    cancel();
+    m_pool.waitForDone();
+}
+
+QString DirectorySizeCalculator::cacheKey(const QString &path, const DirectoryEntry &entry) {
+    // 不提供 inode 的平台上用路径代替
+    const QString id = entry.ino != 0 ? QString("%1:%2").arg(entry.dev).arg(entry.ino) : path;
+    return id + ":" + QString::number(entry.mtimeNs);
+}
+
+void DirectorySizeCalculator::start(const QString &path) {
+    cancel();
+
+    DirectoryEntry rootEntry;
+    if (!DirectoryReader::stat(QFile::encodeName(path), rootEntry)) return;
+    const QString key = cacheKey(path, rootEntry);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        auto it = m_cache.constFind(key);
+        if (it != m_cache.constEnd()) {
+            const Result result = it.value();
+            m_cacheLru.removeOne(key);
+            m_cacheLru.append(key);
+            locker.unlock();
+            emit finished(path, result.bytes, result.files, result.dirs);
+            return;
+        }
+    }
+
+    auto job = std::make_shared<Job>();
+    job->root = path;
+    job->key = key;
+    job->rootDev = rootEntry.dev;
+    job->pending.push_back(QFile::encodeName(path));
+    job->timer.start();
+    job->workers = m_pool.maxThreadCount();
+    m_job = job;
+    for (int i = 0; i < job->workers; ++i) {
+        m_pool.start([this, job]() { workerLoop(job); });
+    }
+}
+
+void DirectorySizeCalculator::cancel() {
+    if (!m_job) return;
+    m_job->cancelled.store(true);
+    {
+        QMutexLocker locker(&m_job->mutex);
+        m_job->wake.wakeAll();
+    }
+    m_job.reset();
+}
+
+void DirectorySizeCalculator::clearCache() {
+    QMutexLocker locker(&m_cacheMutex);
+    m_cache.clear();
+    m_cacheLru.clear();
+}
+
+void DirectorySizeCalculator::workerLoop(const std::shared_ptr<Job> &job) {
+    for (;;) {
+        QByteArray dir;
+        {
+            QMutexLocker locker(&job->mutex);
+            while (job->pending.empty() && job->busy > 0 && !job->cancelled.load()) {
+                job->wake.wait(&job->mutex);
+            }
+            if (job->cancelled.load() || job->pending.empty()) {
+                // 队列已空且没有线程还在遍历：整棵树已统计完
+                job->wake.wakeAll();
+                const bool last = --job->workers == 0;
+                locker.unlock();
+                if (last && !job->cancelled.load()) finishJob(job);
+                return;
+            }
+            dir = job->pending.front();
+            job->pending.pop_front();
+            ++job->busy;
+        }
+
+        scanDirectory(job, dir);
+        reportProgress(job);
+
+        QMutexLocker locker(&job->mutex);
+        if (--job->busy == 0 && job->pending.empty()) {
+            job->wake.wakeAll();
+        }
+    }
+}
+
+void DirectorySizeCalculator::scanDirectory(const std::shared_ptr<Job> &job, const QByteArray &dir) {
+    qint64 bytes = 0;
+    qint64 files = 0;
+    std::vector<QByteArray> subdirs;
+
+    DirectoryReader::read(dir, [&](const DirectoryEntry &entry) {
+        if (job->cancelled.load(std::memory_order_relaxed)) return false;
+        if (entry.isDir) {
+            // 不进入挂载在其下的其它文件系统：/proc、/sys 以及可能无响应的网络文件系统
+            if (entry.dev != job->rootDev) return true;
+            bytes += entry.allocated;
+            subdirs.push_back(dir + '/' + entry.name);
+            return true;
+        }
+        if (entry.nlink > 1 && entry.ino != 0) {
+            // 硬链接：同一 inode 只统计第一次遇到的那个
+            QMutexLocker locker(&job->mutex);
+            const auto key = qMakePair(entry.dev, entry.ino);
+            if (job->seenInodes.contains(key)) return true;
+            job->seenInodes.insert(key);
+        }
+        bytes += entry.allocated;
+        ++files;
+        return true;
+    });
+
+    job->bytes += bytes;
+    job->files += files;
+    if (subdirs.empty()) return;
+    job->dirs += qint64(subdirs.size());
+
+    QMutexLocker locker(&job->mutex);
+    for (QByteArray &subdir : subdirs) {
+        job->pending.push_back(std::move(subdir));
+    }
+    job->wake.wakeAll();
+}
+
+void DirectorySizeCalculator::reportProgress(const std::shared_ptr<Job> &job) {
+    // 只有抢到本次时间片的线程发出进度
+    qint64 next = job->nextProgressMs.load();
+    const qint64 now = job->timer.elapsed();
+    if (now < next || !job->nextProgressMs.compare_exchange_strong(next, now + kProgressIntervalMs)) return;
+
+    const QString path = job->root;
+    const qint64 bytes = job->bytes.load();
+    const qint64 files = job->files.load();
+    QMetaObject::invokeMethod(this, [this, job, path, bytes, files]() {
+        if (job == m_job) emit progress(path, bytes, files);
+    }, Qt::QueuedConnection);
+}
+
+void DirectorySizeCalculator::finishJob(const std::shared_ptr<Job> &job) {
+    Result result;
+    result.bytes = job->bytes.load();
+    result.files = job->files.load();
+    result.dirs = job->dirs.load();
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        m_cache.insert(job->key, result);
+        m_cacheLru.removeOne(job->key);
+        m_cacheLru.append(job->key);
+        while (m_cacheLru.size() > kMaxCachedResults) m_cache.remove(m_cacheLru.takeFirst());
+    }
+
+    QMetaObject::invokeMethod(this, [this, job, result]() {
+        if (job != m_job) return;
+        m_job.reset();
+        emit finished(job->root, result.bytes, result.files, result.dirs);
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,57 @@
+#ifndef DIRECTORYSIZECALCULATOR_H
+#define DIRECTORYSIZECALCULATOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <memory>
+
+struct DirectoryEntry;
+
+// 递归统计目录占用空间：多个线程并行遍历子目录，统计过程中发出 progress，可随时取消。
+// 不进入挂载在其下的其它文件系统（/proc、网络文件系统等）。
+// 硬链接的同一 inode 只计一次；结果按根目录的 (设备, inode, 修改时间) 缓存（数量有上限，LRU），
+// 重复选中同一目录时直接返回
+class DirectorySizeCalculator : public QObject {
+    Q_OBJECT
+public:
+    explicit DirectorySizeCalculator(QObject *parent = nullptr);
+    ~DirectorySizeCalculator() override;
+
+    // 开始统计 path（取消之前的任务）；命中缓存时立即发出 finished
+    void start(const QString &path);
+    void cancel();
+    void clearCache();
+
+signals:
+    // bytes 为已统计的磁盘占用（按分配的块计算）
+    void progress(const QString &path, qint64 bytes, qint64 files);
+    void finished(const QString &path, qint64 bytes, qint64 files, qint64 dirs);
+
+private:
+    struct Job;
+    struct Result {
+        qint64 bytes {0};
+        qint64 files {0};
+        qint64 dirs {0};
+    };
+
+    static QString cacheKey(const QString &path, const DirectoryEntry &entry);
+    void workerLoop(const std::shared_ptr<Job> &job);
+    void scanDirectory(const std::shared_ptr<Job> &job, const QByteArray &dir);
+    void reportProgress(const std::shared_ptr<Job> &job);
+    void finishJob(const std::shared_ptr<Job> &job);
+
+    QThreadPool m_pool;
+    // 只在界面线程访问
+    std::shared_ptr<Job> m_job;
+    QMutex m_cacheMutex;
+    QHash<QString, Result> m_cache;
+    QStringList m_cacheLru;  // 最近使用的在末尾
+};
+
+#endif // DIRECTORYSIZECALCULATOR_H
@@ -0,0 +1,142 @@
+#include "DirectorySnapshotCache.h"
+
+#include <QFile>
+#include <QSocketNotifier>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef Q_OS_LINUX
+// 增删、改名、属性或内容变化都会让快照失效；目录本身被删除或移走时同样失效
+constexpr uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_MODIFY
+                                | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+// 其它客户端的修改不会产生 inotify 事件的文件系统
+bool isRemoteFileSystem(const QByteArray &path) {
+    struct statfs info;
+    if (::statfs(path.constData(), &info) != 0) return true;
+    switch (static_cast<unsigned long>(info.f_type)) {
+    case 0x6969UL:       // NFS
+    case 0x517BUL:       // SMB
+    case 0xFF534D42UL:   // CIFS
+    case 0xFE534D42UL:   // SMB2
+    case 0x65735546UL:   // FUSE（sshfs 等）
+    case 0x564CUL:       // NCP
+    case 0x01021997UL:   // 9P
+        return true;
+    default:
+        return false;
+    }
+}
+#endif
+}
+
+DirectorySnapshotCache::DirectorySnapshotCache(QObject *parent) : QObject(parent) {
+#ifdef Q_OS_LINUX
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd >= 0) {
+        m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &DirectorySnapshotCache::readEvents);
+    }
+#endif
+}
+
+DirectorySnapshotCache::~DirectorySnapshotCache() {
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0) {
+        delete m_notifier;
+        ::close(m_inotifyFd);
+    }
+#endif
+}
+
+void DirectorySnapshotCache::setCapacity(int capacity) {
+    m_capacity = qMax(1, capacity);
+    evict();
+}
+
+void DirectorySnapshotCache::store(const QString &path, const Snapshot &snapshot) {
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd < 0) return;
+    auto it = m_entries.find(path);
+    if (it == m_entries.end()) {
+        // 先加监视再记录快照，之后的任何变化都会让它失效
+        const QByteArray encoded = QFile::encodeName(path);
+        const int wd = inotify_add_watch(m_inotifyFd, encoded.constData(), kWatchMask);
+        if (wd < 0) return;
+        Entry entry;
+        entry.wd = wd;
+        entry.snapshot = snapshot;
+        entry.snapshot.verified = !isRemoteFileSystem(encoded);
+        m_entries.insert(path, entry);
+        m_watches.insert(wd, path);
+    } else {
+        const bool verified = it->snapshot.verified;
+        it->snapshot = snapshot;
+        it->snapshot.verified = verified;
+        m_lru.removeOne(path);
+    }
+    m_lru.append(path);
+    evict();
+#else
+    Q_UNUSED(path)
+    Q_UNUSED(snapshot)
+#endif
+}
+
+bool DirectorySnapshotCache::lookup(const QString &path, Snapshot *snapshot) {
+    auto it = m_entries.constFind(path);
+    if (it == m_entries.constEnd()) return false;
+    if (snapshot) *snapshot = it->snapshot;
+    m_lru.removeOne(path);
+    m_lru.append(path);
+    return true;
+}
+
+void DirectorySnapshotCache::remove(const QString &path) {
+    auto it = m_entries.find(path);
+    if (it == m_entries.end()) return;
+#ifdef Q_OS_LINUX
+    inotify_rm_watch(m_inotifyFd, it->wd);
+#endif
+    m_watches.remove(it->wd);
+    m_entries.erase(it);
+    m_lru.removeOne(path);
+}
+
+void DirectorySnapshotCache::evict() {
+    while (m_lru.size() > m_capacity) {
+        remove(m_lru.first());
+    }
+}
+
+void DirectorySnapshotCache::readEvents() {
+#ifdef Q_OS_LINUX
+    QStringList changed;
+    alignas(struct inotify_event) char buffer[16 * 1024];
+    for (;;) {
+        const ssize_t length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+        for (char *p = buffer; p < buffer + length;) {
+            const auto *event = reinterpret_cast<const struct inotify_event *>(p);
+            p += sizeof(struct inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                // 丢失了事件，无法判断哪些快照仍然有效
+                changed = m_lru;
+                continue;
+            }
+            const QString path = m_watches.value(event->wd);
+            if (!path.isEmpty() && !changed.contains(path)) changed.append(path);
+        }
+    }
+    for (const QString &path : changed) {
+        if (!m_entries.contains(path)) continue;
+        remove(path);
+        emit invalidated(path);
+    }
+#endif
+}
@@ -0,0 +1,54 @@
+#ifndef DIRECTORYSNAPSHOTCACHE_H
+#define DIRECTORYSNAPSHOTCACHE_H
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QSocketNotifier;
+
+// 最近离开的目录的快照（项数、排序方式），按路径保存，数量有上限（LRU）。
+// 每个快照对应一个 inotify 监视，目录内容或属性有变化时丢弃快照并发出 invalidated。
+// 快照有效说明模型中保留的该目录节点仍是最新的，后退/前进时可以直接显示而不必重新列目录。
+// 网络文件系统上 inotify 看不到其它机器的修改，这类快照标记为未验证，使用后需在后台核对
+class DirectorySnapshotCache : public QObject {
+    Q_OBJECT
+public:
+    struct Snapshot {
+        int entries {0};
+        int sortColumn {0};
+        Qt::SortOrder sortOrder {Qt::AscendingOrder};
+        bool verified {true};  // false 表示无法靠 inotify 得知变化（网络文件系统）
+    };
+
+    explicit DirectorySnapshotCache(QObject *parent = nullptr);
+    ~DirectorySnapshotCache() override;
+
+    void setCapacity(int capacity);
+    // 保存或更新 path 的快照；无法监视该目录时不保存
+    void store(const QString &path, const Snapshot &snapshot);
+    bool lookup(const QString &path, Snapshot *snapshot);
+    void remove(const QString &path);
+
+signals:
+    void invalidated(const QString &path);
+
+private:
+    struct Entry {
+        Snapshot snapshot;
+        int wd {-1};
+    };
+
+    void readEvents();
+    void evict();
+
+    QHash<QString, Entry> m_entries;
+    QStringList m_lru;  // 最近使用的在末尾
+    QHash<int, QString> m_watches;
+    int m_capacity {32};
+    int m_inotifyFd {-1};
+    QSocketNotifier *m_notifier {nullptr};
+};
+
+#endif // DIRECTORYSNAPSHOTCACHE_H
@@ -0,0 +1,303 @@
+#include "DiskUsageScanner.h"
+#include "DirectoryReader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QPair>
+#include <QSet>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <algorithm>
+
+namespace {
+constexpr quint32 kNoParent = 0xffffffffu;
+// 空闲线程等待新任务的最长时间，之后重新尝试窃取
+constexpr unsigned long kIdleWaitMs = 5;
+}
+
+struct DiskUsageScanner::Scan {
+    std::atomic_bool cancelled {false};
+    QString rootPath;
+    quint64 rootDev {0};
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::atomic<qint64> outstanding {0};  // 已入队但尚未处理完的目录
+    std::atomic<int> workers {0};
+
+    QMutex idleMutex;
+    QWaitCondition idle;
+
+    QMutex inodeMutex;
+    QSet<QPair<quint64, quint64>> seenInodes;  // 多个硬链接的文件 (设备, inode)
+
+    mutable QMutex arenaMutex;
+    std::vector<Node> nodes;
+    std::vector<char> names;
+};
+
+DiskUsageScanner::DiskUsageScanner(QObject *parent) : QObject(parent) {
+    m_workerCount = qBound(2, QThread::idealThreadCount(), 8);
+    m_pool.setMaxThreadCount(m_workerCount);
+}
+
+DiskUsageScanner::~DiskUsageScanner() {
+    cancel();
+    m_pool.waitForDone();
+}
+
+void DiskUsageScanner::start(const QString &rootPath) {
+    // 不等待旧线程：它们只写自己那次扫描的节点数组，取消后结果随最后一个线程退出而释放
+    cancel();
+    // 旧线程可能还卡在读目录上，为新扫描补足线程数，避免排在它们后面
+    const int workerCount = m_workerCount;
+    m_pool.setMaxThreadCount(workerCount + m_pool.activeThreadCount());
+
+    auto scan = std::make_shared<Scan>();
+    scan->rootPath = QDir::cleanPath(rootPath);
+    m_scan = scan;
+    const QByteArray root = QFile::encodeName(scan->rootPath);
+    DirectoryEntry rootEntry;
+    if (!DirectoryReader::stat(root, rootEntry)) {
+        // 无法读取根目录：没有结果，照常报告结束（排队发出，调用方连接的刷新状态在 start() 返回后才设置）
+        m_scan.reset();
+        QMetaObject::invokeMethod(this, [this]() {
+            if (!m_scan) emit finished();
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    addNode(*scan, kNoParent, QByteArray());
+    scan->nodes[kRootNode].ownBytes = rootEntry.allocated;
+    scan->rootDev = rootEntry.dev;
+    for (int i = 0; i < workerCount; ++i) {
+        scan->queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    scan->queues[0]->items.push_back({kRootNode, root});
+    scan->outstanding = 1;
+    scan->workers = workerCount;
+    for (int i = 0; i < workerCount; ++i) {
+        m_pool.start([this, scan, i]() { workerLoop(scan, i); });
+    }
+}
+
+void DiskUsageScanner::cancel() {
+    if (!m_scan) return;
+    m_scan->cancelled.store(true);
+    QMutexLocker locker(&m_scan->idleMutex);
+    m_scan->idle.wakeAll();
+}
+
+bool DiskUsageScanner::isRunning() const {
+    return m_scan && !m_scan->cancelled.load() && m_scan->workers.load() > 0;
+}
+
+void DiskUsageScanner::workerLoop(const std::shared_ptr<Scan> &scan, int worker) {
+    for (;;) {
+        WorkItem item;
+        if (!takeWork(scan, worker, item)) {
+            if (scan->cancelled.load() || scan->outstanding.load() == 0) break;
+            // 其它线程仍在处理目录，稍后可能产生可窃取的任务
+            QMutexLocker locker(&scan->idleMutex);
+            if (!scan->cancelled.load() && scan->outstanding.load() > 0) {
+                scan->idle.wait(&scan->idleMutex, kIdleWaitMs);
+            }
+            continue;
+        }
+
+        scanDirectory(scan, worker, item);
+        if (--scan->outstanding == 0) {
+            // 最后一个目录处理完，唤醒等待中的线程让它们退出
+            QMutexLocker locker(&scan->idleMutex);
+            scan->idle.wakeAll();
+        }
+    }
+
+    if (--scan->workers == 0 && !scan->cancelled.load()) {
+        // 期间开始了新的扫描时，旧扫描的完成不再报告
+        QMetaObject::invokeMethod(this, [this, scan]() {
+            if (scan == m_scan && !scan->cancelled.load()) emit finished();
+        }, Qt::QueuedConnection);
+    }
+}
+
+bool DiskUsageScanner::takeWork(const std::shared_ptr<Scan> &scan, int worker, WorkItem &item) {
+    // 自己的队列从尾部取（深度优先，待处理目录数保持较少）
+    {
+        WorkerQueue &own = *scan->queues[worker];
+        QMutexLocker locker(&own.mutex);
+        if (!own.items.empty()) {
+            item = std::move(own.items.back());
+            own.items.pop_back();
+            return true;
+        }
+    }
+    // 从其它线程队列的头部窃取（靠近根的目录，通常包含更多工作）
+    const int count = int(scan->queues.size());
+    for (int i = 1; i < count; ++i) {
+        WorkerQueue &other = *scan->queues[(worker + i) % count];
+        QMutexLocker locker(&other.mutex);
+        if (!other.items.empty()) {
+            item = std::move(other.items.front());
+            other.items.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void DiskUsageScanner::scanDirectory(const std::shared_ptr<Scan> &scan, int worker, const WorkItem &item) {
+    qint64 bytes = 0;
+    qint64 files = 0;
+    std::vector<QByteArray> subdirs;
+
+    DirectoryReader::read(item.path, [&](const DirectoryEntry &entry) {
+        if (scan->cancelled.load(std::memory_order_relaxed)) return false;
+        if (entry.isDir) {
+            // 不进入挂载在其下的其它文件系统
+            if (entry.dev != scan->rootDev) return true;
+            bytes += entry.allocated;
+            subdirs.emplace_back(entry.name);
+            return true;
+        }
+        if (entry.nlink > 1 && entry.ino != 0) {
+            // 硬链接：同一 inode 只统计第一次遇到的那个
+            QMutexLocker locker(&scan->inodeMutex);
+            const auto key = qMakePair(entry.dev, entry.ino);
+            if (scan->seenInodes.contains(key)) return true;
+            scan->seenInodes.insert(key);
+        }
+        bytes += entry.allocated;
+        ++files;
+        return true;
+    });
+    if (scan->cancelled.load()) return;
+
+    std::vector<WorkItem> children;
+    children.reserve(subdirs.size());
+    {
+        QMutexLocker locker(&scan->arenaMutex);
+        scan->nodes[item.node].ownBytes += bytes;
+        scan->nodes[item.node].ownFiles = files;
+        for (const QByteArray &name : subdirs) {
+            children.push_back({addNode(*scan, item.node, name), item.path + '/' + name});
+        }
+    }
+    if (children.empty()) return;
+
+    scan->outstanding += qint64(children.size());
+    {
+        WorkerQueue &own = *scan->queues[worker];
+        QMutexLocker locker(&own.mutex);
+        for (WorkItem &child : children) {
+            own.items.push_back(std::move(child));
+        }
+    }
+    QMutexLocker locker(&scan->idleMutex);
+    scan->idle.wakeAll();
+}
+
+quint32 DiskUsageScanner::addNode(Scan &scan, quint32 parent, const QByteArray &name) {
+    Node node;
+    node.parent = parent;
+    node.nameOffset = quint32(scan.names.size());
+    node.nameLength = quint32(name.size());
+    node.ownBytes = 0;
+    node.ownFiles = 0;
+    scan.names.insert(scan.names.end(), name.constBegin(), name.constEnd());
+    scan.nodes.push_back(node);
+    return quint32(scan.nodes.size() - 1);
+}
+
+QString DiskUsageScanner::nodeName(const Scan &scan, quint32 node) {
+    if (node == kRootNode) return scan.rootPath;
+    const Node &n = scan.nodes[node];
+    return QFile::decodeName(QByteArray(scan.names.data() + n.nameOffset, int(n.nameLength)));
+}
+
+QString DiskUsageScanner::nodePath(const Scan &scan, quint32 node) {
+    QStringList parts;
+    for (quint32 i = node; i != kRootNode; i = scan.nodes[i].parent) {
+        parts.prepend(nodeName(scan, i));
+    }
+    const QString &root = scan.rootPath;
+    if (parts.isEmpty()) return root;
+    return root.endsWith('/') ? root + parts.join('/') : root + '/' + parts.join('/');
+}
+
+quint32 DiskUsageScanner::parentNode(quint32 node) const {
+    if (!m_scan) return kRootNode;
+    QMutexLocker locker(&m_scan->arenaMutex);
+    if (node == kRootNode || node >= m_scan->nodes.size()) return kRootNode;
+    return m_scan->nodes[node].parent;
+}
+
+DiskUsageScanner::Snapshot DiskUsageScanner::snapshot(quint32 focusNode, int largestCount) const {
+    Snapshot result;
+    result.finished = !isRunning();
+    if (!m_scan) return result;
+    const Scan &scan = *m_scan;
+
+    // 只在持锁时复制父节点和自身大小，汇总在锁外进行，不阻塞扫描线程
+    std::vector<quint32> parents;
+    std::vector<qint64> totalBytes;
+    std::vector<qint64> totalFiles;
+    {
+        QMutexLocker locker(&scan.arenaMutex);
+        const size_t count = scan.nodes.size();
+        if (count == 0) return result;
+        parents.resize(count);
+        totalBytes.resize(count);
+        totalFiles.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            parents[i] = scan.nodes[i].parent;
+            totalBytes[i] = scan.nodes[i].ownBytes;
+            totalFiles[i] = scan.nodes[i].ownFiles;
+        }
+    }
+
+    // 子节点总在父节点之后创建，倒序累加即可得到每个目录的总大小
+    const quint32 count = quint32(parents.size());
+    for (quint32 i = count - 1; i > kRootNode; --i) {
+        totalBytes[parents[i]] += totalBytes[i];
+        totalFiles[parents[i]] += totalFiles[i];
+    }
+    if (focusNode >= count) focusNode = kRootNode;
+
+    result.totalBytes = totalBytes[kRootNode];
+    result.totalFiles = totalFiles[kRootNode];
+    result.totalDirs = count - 1;
+
+    std::vector<quint32> children;
+    for (quint32 i = focusNode + 1; i < count; ++i) {
+        if (parents[i] == focusNode) children.push_back(i);
+    }
+    std::sort(children.begin(), children.end(), [&](quint32 a, quint32 b) { return totalBytes[a] > totalBytes[b]; });
+
+    std::vector<quint32> largest;
+    largest.reserve(count > 0 ? count - 1 : 0);
+    for (quint32 i = kRootNode + 1; i < count; ++i) largest.push_back(i);
+    const size_t keep = std::min<size_t>(largest.size(), size_t(qMax(0, largestCount)));
+    std::partial_sort(largest.begin(), largest.begin() + keep, largest.end(),
+                      [&](quint32 a, quint32 b) { return totalBytes[a] > totalBytes[b]; });
+    largest.resize(keep);
+
+    QMutexLocker locker(&scan.arenaMutex);
+    auto makeEntry = [&](quint32 node) {
+        Entry entry;
+        entry.node = node;
+        entry.name = nodeName(scan, node);
+        entry.path = nodePath(scan, node);
+        entry.bytes = totalBytes[node];
+        entry.files = totalFiles[node];
+        return entry;
+    };
+    result.focus = makeEntry(focusNode);
+    result.focusOwnBytes = scan.nodes[focusNode].ownBytes;
+    result.children.reserve(int(children.size()));
+    for (quint32 node : children) result.children.append(makeEntry(node));
+    result.largest.reserve(int(largest.size()));
+    for (quint32 node : largest) result.largest.append(makeEntry(node));
+    return result;
+}
@@ -0,0 +1,93 @@
+#ifndef DISKUSAGESCANNER_H
+#define DISKUSAGESCANNER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// 磁盘占用分析：多线程遍历整个卷（每个线程优先处理自己的任务队列，空闲时从其它线程的队列窃取），
+// 只为目录建立节点，文件大小直接累加到所在目录，节点和名称放在连续数组中，百万级文件的内存占用只与目录数相关。
+// 扫描过程中可随时调用 snapshot() 取得当前的部分结果。
+// 每次扫描的节点数组各自独立，重新扫描时不必等待上一次的线程退出（它们可能卡在无响应的网络文件系统上）
+class DiskUsageScanner : public QObject {
+    Q_OBJECT
+public:
+    static constexpr quint32 kRootNode = 0;
+
+    struct Entry {
+        quint32 node {kRootNode};
+        QString name;
+        QString path;
+        qint64 bytes {0};   // 含所有子目录
+        qint64 files {0};
+    };
+
+    struct Snapshot {
+        qint64 totalBytes {0};
+        qint64 totalFiles {0};
+        qint64 totalDirs {0};
+        bool finished {false};
+        Entry focus;                // 当前查看的目录
+        qint64 focusOwnBytes {0};   // 该目录中直接包含的文件
+        QVector<Entry> children;    // 该目录的子目录，按大小降序
+        QVector<Entry> largest;     // 全卷最大的目录，按大小降序（不含根目录）
+    };
+
+    explicit DiskUsageScanner(QObject *parent = nullptr);
+    ~DiskUsageScanner() override;
+
+    // 开始扫描 rootPath（取消之前的扫描），不跨越到其它文件系统
+    void start(const QString &rootPath);
+    void cancel();
+    bool isRunning() const;
+
+    // 按当前已扫描的部分计算各目录总大小（界面线程调用）
+    Snapshot snapshot(quint32 focusNode, int largestCount) const;
+    quint32 parentNode(quint32 node) const;
+
+signals:
+    void finished();
+
+private:
+    struct Node {
+        quint32 parent;
+        quint32 nameOffset;   // 名称在 names 中的位置
+        quint32 nameLength;
+        qint64 ownBytes;      // 目录本身及其中文件的占用
+        qint64 ownFiles;
+    };
+
+    struct WorkItem {
+        quint32 node;
+        QByteArray path;
+    };
+
+    struct WorkerQueue {
+        QMutex mutex;
+        std::deque<WorkItem> items;
+    };
+
+    struct Scan;
+
+    void workerLoop(const std::shared_ptr<Scan> &scan, int worker);
+    bool takeWork(const std::shared_ptr<Scan> &scan, int worker, WorkItem &item);
+    void scanDirectory(const std::shared_ptr<Scan> &scan, int worker, const WorkItem &item);
+    static quint32 addNode(Scan &scan, quint32 parent, const QByteArray &name);  // 调用方需持有 scan.arenaMutex
+    static QString nodePath(const Scan &scan, quint32 node);                    // 调用方需持有 scan.arenaMutex
+    static QString nodeName(const Scan &scan, quint32 node);                    // 调用方需持有 scan.arenaMutex
+
+    QThreadPool m_pool;
+    int m_workerCount {2};
+    // 最近一次扫描（取消后仍保留，snapshot() 返回其部分结果）；已取消的旧扫描只被其线程持有
+    std::shared_ptr<Scan> m_scan;
+};
+
+#endif // DISKUSAGESCANNER_H
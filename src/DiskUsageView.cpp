@@ -0,0 +1,145 @@
+#include "DiskUsageView.h"
+#include "DiskUsageScanner.h"
+#include "FileSizeFormat.h"
+#include "TreemapWidget.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QSplitter>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+namespace {
+// 刷新间隔以及树图、列表的显示数量上限（更小的子目录合并为一块）
+constexpr int kRefreshIntervalMs = 500;
+constexpr int kMaxTreemapItems = 200;
+constexpr int kLargestCount = 100;
+
+// 按大小排序时使用数值而不是显示文字
+class SizeItem : public QTableWidgetItem {
+public:
+    SizeItem(qint64 size) : QTableWidgetItem(FileSizeFormat::format(size)), m_size(size) {
+        setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    bool operator<(const QTableWidgetItem &other) const override {
+        const auto *sizeItem = dynamic_cast<const SizeItem *>(&other);
+        return sizeItem ? m_size < sizeItem->m_size : QTableWidgetItem::operator<(other);
+    }
+private:
+    qint64 m_size;
+};
+}
+
+DiskUsageView::DiskUsageView(const QString &rootPath, QWidget *parent) : QWidget(parent, Qt::Window) {
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowTitle(tr("磁盘占用分析 - %1").arg(rootPath));
+    resize(1000, 640);
+
+    auto *layout = new QVBoxLayout(this);
+    auto *topBar = new QHBoxLayout();
+    m_btnUp = new QPushButton(tr("上一级"), this);
+    m_btnOpen = new QPushButton(tr("在文件管理器中打开"), this);
+    m_summary = new QLabel(this);
+    m_summary->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    topBar->addWidget(m_btnUp);
+    topBar->addWidget(m_btnOpen);
+    topBar->addWidget(m_summary, 1);
+    layout->addLayout(topBar);
+
+    auto *splitter = new QSplitter(Qt::Horizontal, this);
+    m_treemap = new TreemapWidget(splitter);
+    m_largest = new QTableWidget(0, 3, splitter);
+    m_largest->setHorizontalHeaderLabels({tr("目录"), tr("大小"), tr("文件数")});
+    m_largest->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_largest->verticalHeader()->setVisible(false);
+    m_largest->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_largest->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_largest->horizontalHeader()->setSortIndicator(1, Qt::DescendingOrder);
+    splitter->addWidget(m_treemap);
+    splitter->addWidget(m_largest);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 2);
+    layout->addWidget(splitter, 1);
+
+    m_scanner = new DiskUsageScanner(this);
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(kRefreshIntervalMs);
+
+    connect(m_refreshTimer, &QTimer::timeout, this, &DiskUsageView::refresh);
+    connect(m_scanner, &DiskUsageScanner::finished, this, [this]() {
+        m_refreshTimer->stop();
+        refresh();
+    });
+    connect(m_treemap, &TreemapWidget::itemActivated, this, &DiskUsageView::setFocusNode);
+    connect(m_largest, &QTableWidget::cellDoubleClicked, this, [this](int row, int) {
+        setFocusNode(m_largest->item(row, 0)->data(Qt::UserRole).toUInt());
+    });
+    connect(m_btnUp, &QPushButton::clicked, this, [this]() {
+        setFocusNode(m_scanner->parentNode(m_focusNode));
+    });
+    connect(m_btnOpen, &QPushButton::clicked, this, [this]() {
+        if (!m_focusPath.isEmpty()) emit openRequested(m_focusPath);
+    });
+
+    m_scanner->start(rootPath);
+    m_refreshTimer->start();
+    refresh();
+}
+
+DiskUsageView::~DiskUsageView() {
+    m_scanner->cancel();
+}
+
+void DiskUsageView::setFocusNode(quint32 node) {
+    m_focusNode = node;
+    refresh();
+}
+
+void DiskUsageView::refresh() {
+    const DiskUsageScanner::Snapshot snapshot = m_scanner->snapshot(m_focusNode, kLargestCount);
+    m_focusNode = snapshot.focus.node;
+    m_focusPath = snapshot.focus.path;
+    m_btnUp->setEnabled(m_focusNode != DiskUsageScanner::kRootNode);
+
+    m_summary->setText(tr("%1  |  %2，%3 个文件，%4 个目录%5")
+                       .arg(m_focusPath, FileSizeFormat::format(snapshot.totalBytes))
+                       .arg(snapshot.totalFiles).arg(snapshot.totalDirs)
+                       .arg(snapshot.finished ? QString() : tr("  |  正在扫描...")));
+
+    // 树图：当前目录的子目录，加上直接包含的文件；超出数量上限的小目录合并显示
+    QVector<TreemapWidget::Item> items;
+    qint64 others = 0;
+    for (const DiskUsageScanner::Entry &child : snapshot.children) {
+        if (items.size() < kMaxTreemapItems) {
+            items.append({child.name, child.bytes, child.node, true});
+        } else {
+            others += child.bytes;
+        }
+    }
+    if (others > 0) items.append({tr("其它目录"), others, 0, false});
+    if (snapshot.focusOwnBytes > 0) items.append({tr("(文件)"), snapshot.focusOwnBytes, 0, false});
+    std::sort(items.begin(), items.end(), [](const TreemapWidget::Item &a, const TreemapWidget::Item &b) {
+        return a.value > b.value;
+    });
+    m_treemap->setItems(items);
+
+    m_largest->setSortingEnabled(false);
+    m_largest->setRowCount(snapshot.largest.size());
+    for (int row = 0; row < snapshot.largest.size(); ++row) {
+        const DiskUsageScanner::Entry &entry = snapshot.largest[row];
+        auto *pathItem = new QTableWidgetItem(entry.path);
+        pathItem->setData(Qt::UserRole, entry.node);
+        pathItem->setToolTip(entry.path);
+        m_largest->setItem(row, 0, pathItem);
+        m_largest->setItem(row, 1, new SizeItem(entry.bytes));
+        auto *filesItem = new QTableWidgetItem();
+        filesItem->setData(Qt::DisplayRole, entry.files);
+        m_largest->setItem(row, 2, filesItem);
+    }
+    m_largest->setSortingEnabled(true);
+}
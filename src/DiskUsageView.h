@@ -0,0 +1,40 @@
+#ifndef DISKUSAGEVIEW_H
+#define DISKUSAGEVIEW_H
+
+#include <QWidget>
+
+class DiskUsageScanner;
+class TreemapWidget;
+class QLabel;
+class QPushButton;
+class QTableWidget;
+class QTimer;
+
+// 磁盘占用分析窗口：左侧矩形树图显示当前目录的子目录占比（双击进入），右侧列出全卷最大的目录。
+// 扫描在后台进行，期间定时刷新部分结果
+class DiskUsageView : public QWidget {
+    Q_OBJECT
+public:
+    explicit DiskUsageView(const QString &rootPath, QWidget *parent = nullptr);
+    ~DiskUsageView() override;
+
+signals:
+    // 请求在主窗口中打开该目录
+    void openRequested(const QString &path);
+
+private:
+    void refresh();
+    void setFocusNode(quint32 node);
+
+    DiskUsageScanner *m_scanner {nullptr};
+    TreemapWidget *m_treemap {nullptr};
+    QTableWidget *m_largest {nullptr};
+    QLabel *m_summary {nullptr};
+    QPushButton *m_btnUp {nullptr};
+    QPushButton *m_btnOpen {nullptr};
+    QTimer *m_refreshTimer {nullptr};
+    quint32 m_focusNode {0};
+    QString m_focusPath;
+};
+
+#endif // DISKUSAGEVIEW_H
@@ -0,0 +1,42 @@
+#ifndef FILEMODEL_H
+#define FILEMODEL_H
+
+#include <QFileInfo>
+#include <QIcon>
+#include <QModelIndex>
+#include <QString>
+
+#include <functional>
+
+class QAbstractItemModel;
+class QFileIconProvider;
+class QObject;
+class ThumbnailIconProvider;
+
+// 文件视图使用的模型后端：基于 QFileSystemModel 的 CustomFileSystemModel，
+// 或自己读取目录的 NativeFileModel。主窗口只通过这些接口访问模型，视图使用 itemModel()
+class FileModel {
+public:
+    virtual ~FileModel() = default;
+
+    virtual QAbstractItemModel *itemModel() = 0;
+
+    // 路径对应的索引；名称沿用 QFileSystemModel::index(path)
+    virtual QModelIndex indexForPath(const QString &path) const = 0;
+    virtual QString filePath(const QModelIndex &index) const = 0;
+    virtual QFileInfo fileInfo(const QModelIndex &index) const = 0;
+    virtual QIcon fileIcon(const QModelIndex &index) const = 0;
+
+    virtual void setRootPath(const QString &path) = 0;
+    virtual void setIconProvider(QFileIconProvider *provider) = 0;
+    virtual void setThumbnailProvider(const ThumbnailIconProvider *provider) = 0;
+    // 缩略图生成完成后通知视图重绘对应行
+    virtual void thumbnailUpdated(const QString &filePath) = 0;
+    // 后退/前进时目录快照仍然有效：可以直接使用保留的内容，不必重新列出该目录
+    virtual void setTrustedListing(const QString &path) = 0;
+
+    // 目录内容加载完成（相当于 QFileSystemModel::directoryLoaded）
+    virtual void onDirectoryLoaded(QObject *context, const std::function<void(const QString &)> &slot) = 0;
+};
+
+#endif // FILEMODEL_H
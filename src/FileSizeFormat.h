@@ -0,0 +1,13 @@
+#ifndef FILESIZEFORMAT_H
+#define FILESIZEFORMAT_H
+
+#include <QString>
+
+// 文件大小的显示文字，主窗口、磁盘占用分析和树图共用
+class FileSizeFormat {
+public:
+    // 按 B/KB/MB/GB 显示，保留两位小数
+    static QString format(qint64 bytes);
+};
+
+#endif // FILESIZEFORMAT_H
@@ -0,0 +1,454 @@
+#include "FilenameIndex.h"
+#include "DirectoryReader.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <string>
+
+#ifdef Q_OS_UNIX
+#include <fnmatch.h>
+#endif
+
+namespace {
+constexpr char kMagic[8] = {'F', 'M', 'F', 'I', 'D', 'X', '0', '1'};
+constexpr quint32 kVersion = 1;
+constexpr quint32 kNoParent = 0xffffffffu;
+constexpr quint16 kFlagDir = 1;
+// 生成倒排列表时每趟最多处理的 (trigram, 条目) 对，限制建索引时的内存
+constexpr qint64 kPairsPerPass = 4 * 1024 * 1024;
+constexpr qint64 kProgressInterval = 100000;
+// 求交集的倒排列表数量上限，其余 trigram 交给逐条核对
+constexpr size_t kMaxIntersections = 4;
+
+inline char foldAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+inline quint64 align8(quint64 offset) {
+    return (offset + 7) & ~quint64(7);
+}
+
+// 名称中不重复的 trigram（按字节计算）
+void collectTrigrams(const char *name, int length, std::vector<quint32> &out) {
+    for (int i = 0; i + 2 < length; ++i) {
+        out.push_back((quint32(uchar(name[i])) << 16) | (quint32(uchar(name[i + 1])) << 8) | uchar(name[i + 2]));
+    }
+}
+
+void sortUnique(std::vector<quint32> &values) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+
+bool isGlob(const QString &query) {
+    return query.contains('*') || query.contains('?') || query.contains('[');
+}
+
+// 通配符中连续的普通字符片段，名称必须包含这些片段，可用于 trigram 过滤
+QList<QByteArray> globLiterals(const QByteArray &pattern) {
+    QList<QByteArray> parts;
+    QByteArray current;
+    auto flush = [&]() {
+        if (!current.isEmpty()) parts.append(current);
+        current.clear();
+    };
+    for (int i = 0; i < pattern.size(); ++i) {
+        const char c = pattern[i];
+        if (c == '*' || c == '?') {
+            flush();
+        } else if (c == '[') {
+            const int close = pattern.indexOf(']', i + 2);
+            if (close < 0) {
+                current += c;
+            } else {
+                flush();
+                i = close;
+            }
+        } else if (c == '\\' && i + 1 < pattern.size()) {
+            current += pattern[++i];
+        } else {
+            current += c;
+        }
+    }
+    flush();
+    return parts;
+}
+
+void appendVarint(QByteArray &out, quint32 value) {
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+}
+
+struct FilenameIndex::Header {
+    char magic[8];
+    quint32 version;
+    quint32 entryCount;
+    qint64 buildTime;          // 毫秒时间戳
+    quint64 entriesOffset;
+    quint64 namesOffset;       // 原始名称
+    quint64 lowerNamesOffset;  // ASCII 小写后的名称，与原始名称偏移一致
+    quint64 namesSize;
+    quint64 postingsOffset;
+    quint64 postingsSize;
+    quint64 trigramsOffset;
+    quint64 trigramCount;
+};
+
+struct FilenameIndex::EntryRecord {
+    quint32 parent;      // 父目录的条目编号，根目录为 kNoParent
+    quint32 nameOffset;  // 根目录的名称是完整路径
+    quint16 nameLength;
+    quint16 flags;
+};
+
+struct FilenameIndex::TrigramRecord {
+    quint32 trigram;
+    quint32 count;
+    quint64 offset;  // 相对倒排列表区的偏移
+};
+
+bool FilenameIndex::build(const QStringList &roots, const QString &filePath, const std::atomic_bool &cancelled,
+                          const std::function<void(qint64)> &progress) {
+    static_assert(sizeof(EntryRecord) == 12 && sizeof(TrigramRecord) == 16, "index record layout");
+
+    std::vector<EntryRecord> entries;
+    std::vector<char> names;
+    auto addEntry = [&](quint32 parent, const QByteArray &name, bool isDir) {
+        EntryRecord record;
+        record.parent = parent;
+        record.nameOffset = quint32(names.size());
+        record.nameLength = quint16(qMin<qint64>(name.size(), 0xffff));
+        record.flags = isDir ? kFlagDir : 0;
+        names.insert(names.end(), name.constBegin(), name.constBegin() + record.nameLength);
+        entries.push_back(record);
+        return quint32(entries.size() - 1);
+    };
+
+    // 先写入所有根目录（编号连续排在最前），再按广度优先遍历，浅层条目编号较小
+    struct PendingDir {
+        quint32 entry;
+        QByteArray path;
+        quint64 dev;
+    };
+    std::deque<PendingDir> queue;
+    for (const QString &root : roots) {
+        const QByteArray rootPath = QFile::encodeName(QDir::cleanPath(root));
+        DirectoryEntry info;
+        if (!DirectoryReader::stat(rootPath, info) || !info.isDir) continue;
+        queue.push_back({addEntry(kNoParent, rootPath, true), rootPath, info.dev});
+    }
+
+    qint64 nextProgress = kProgressInterval;
+    while (!queue.empty()) {
+        if (cancelled.load()) return false;
+        const PendingDir dir = std::move(queue.front());
+        queue.pop_front();
+        const QByteArray prefix = dir.path.endsWith('/') ? dir.path : dir.path + '/';
+        DirectoryReader::read(dir.path, [&](const DirectoryEntry &entry) {
+            const QByteArray name(entry.name);
+            const quint32 id = addEntry(dir.entry, name, entry.isDir);
+            // 挂载在其下的其它文件系统只记录挂载点本身
+            if (entry.isDir && entry.dev == dir.dev) {
+                queue.push_back({id, prefix + name, dir.dev});
+            }
+            return !cancelled.load(std::memory_order_relaxed) && entries.size() < kNoParent;
+        });
+        if (qint64(entries.size()) >= nextProgress) {
+            if (progress) progress(qint64(entries.size()));
+            nextProgress += kProgressInterval;
+        }
+        // 条目编号用尽或名称区超过 32 位偏移时停止收录
+        if (entries.size() >= kNoParent || names.size() >= kNoParent - 0xffff) break;
+    }
+    if (cancelled.load()) return false;
+    if (progress) progress(qint64(entries.size()));
+
+    std::vector<char> lowerNames(names);
+    std::transform(lowerNames.begin(), lowerNames.end(), lowerNames.begin(), foldAscii);
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.entryCount = quint32(entries.size());
+    header.buildTime = QDateTime::currentMSecsSinceEpoch();
+    header.entriesOffset = sizeof(Header);
+    header.namesOffset = header.entriesOffset + entries.size() * sizeof(EntryRecord);
+    header.lowerNamesOffset = header.namesOffset + names.size();
+    header.namesSize = names.size();
+    header.postingsOffset = align8(header.lowerNamesOffset + names.size());
+
+    const QByteArray padding(8, '\0');
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()), qint64(entries.size() * sizeof(EntryRecord)));
+    file.write(names.data(), qint64(names.size()));
+    file.write(lowerNames.data(), qint64(lowerNames.size()));
+    file.write(padding.constData(), qint64(header.postingsOffset - (header.lowerNamesOffset + names.size())));
+
+    // 按 trigram 取模分多趟生成倒排列表，每趟只在内存中排序一部分 (trigram, 条目) 对
+    qint64 totalPairs = 0;
+    for (const EntryRecord &record : entries) totalPairs += qMax(0, int(record.nameLength) - 2);
+    const quint32 passes = quint32(qMax<qint64>(1, (totalPairs + kPairsPerPass - 1) / kPairsPerPass));
+
+    std::vector<TrigramRecord> table;
+    std::vector<quint64> pairs;
+    std::vector<quint32> trigrams;
+    QByteArray buffer;
+    for (quint32 pass = 0; pass < passes; ++pass) {
+        if (cancelled.load()) {
+            file.cancelWriting();
+            return false;
+        }
+        pairs.clear();
+        for (quint32 id = 0; id < entries.size(); ++id) {
+            trigrams.clear();
+            collectTrigrams(lowerNames.data() + entries[id].nameOffset, entries[id].nameLength, trigrams);
+            sortUnique(trigrams);
+            for (quint32 trigram : trigrams) {
+                if (trigram % passes == pass) pairs.push_back((quint64(trigram) << 32) | id);
+            }
+        }
+        std::sort(pairs.begin(), pairs.end());
+
+        size_t i = 0;
+        while (i < pairs.size()) {
+            TrigramRecord record;
+            record.trigram = quint32(pairs[i] >> 32);
+            record.count = 0;
+            record.offset = header.postingsSize;
+            const int before = buffer.size();
+            quint32 previous = 0;
+            for (; i < pairs.size() && quint32(pairs[i] >> 32) == record.trigram; ++i) {
+                const quint32 id = quint32(pairs[i]);
+                appendVarint(buffer, id - previous);
+                previous = id;
+                ++record.count;
+            }
+            header.postingsSize += quint64(buffer.size() - before);
+            table.push_back(record);
+            if (buffer.size() > 1024 * 1024) {
+                file.write(buffer);
+                buffer.clear();
+            }
+        }
+    }
+    file.write(buffer);
+
+    header.trigramsOffset = align8(header.postingsOffset + header.postingsSize);
+    file.write(padding.constData(), qint64(header.trigramsOffset - (header.postingsOffset + header.postingsSize)));
+    std::sort(table.begin(), table.end(), [](const TrigramRecord &a, const TrigramRecord &b) {
+        return a.trigram < b.trigram;
+    });
+    header.trigramCount = table.size();
+    file.write(reinterpret_cast<const char *>(table.data()), qint64(table.size() * sizeof(TrigramRecord)));
+
+    file.seek(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    return file.commit();
+}
+
+std::shared_ptr<FilenameIndex> FilenameIndex::open(const QString &filePath) {
+    std::shared_ptr<FilenameIndex> index(new FilenameIndex());
+    index->m_file.setFileName(filePath);
+    if (!index->m_file.open(QIODevice::ReadOnly)) return nullptr;
+    index->m_size = index->m_file.size();
+    if (index->m_size < qint64(sizeof(Header))) return nullptr;
+    index->m_data = index->m_file.map(0, index->m_size);
+    if (!index->m_data) return nullptr;
+
+    const auto *header = reinterpret_cast<const Header *>(index->m_data);
+    const quint64 size = quint64(index->m_size);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion) return nullptr;
+    if (header->entriesOffset + quint64(header->entryCount) * sizeof(EntryRecord) > size
+        || header->lowerNamesOffset + header->namesSize > size
+        || header->postingsOffset + header->postingsSize > size
+        || header->trigramsOffset + header->trigramCount * sizeof(TrigramRecord) > size) {
+        return nullptr;
+    }
+
+    index->m_header = header;
+    index->m_entries = reinterpret_cast<const EntryRecord *>(index->m_data + header->entriesOffset);
+    index->m_names = reinterpret_cast<const char *>(index->m_data + header->namesOffset);
+    index->m_lowerNames = reinterpret_cast<const char *>(index->m_data + header->lowerNamesOffset);
+    index->m_postings = index->m_data + header->postingsOffset;
+    index->m_trigrams = reinterpret_cast<const TrigramRecord *>(index->m_data + header->trigramsOffset);
+    return index;
+}
+
+quint32 FilenameIndex::entryCount() const {
+    return m_header ? m_header->entryCount : 0;
+}
+
+QDateTime FilenameIndex::buildTime() const {
+    return m_header ? QDateTime::fromMSecsSinceEpoch(m_header->buildTime) : QDateTime();
+}
+
+QStringList FilenameIndex::roots() const {
+    QStringList result;
+    for (quint32 i = 0; i < entryCount() && m_entries[i].parent == kNoParent; ++i) {
+        result.append(path(i));
+    }
+    return result;
+}
+
+QString FilenameIndex::path(quint32 entry) const {
+    QVector<quint32> chain;
+    for (quint32 i = entry; i < entryCount() && chain.size() < 4096; i = m_entries[i].parent) {
+        chain.append(i);
+        if (m_entries[i].parent == kNoParent) break;
+    }
+    QByteArray bytes;
+    for (int k = chain.size() - 1; k >= 0; --k) {
+        const EntryRecord &record = m_entries[chain[k]];
+        if (!bytes.isEmpty() && !bytes.endsWith('/')) bytes += '/';
+        bytes.append(m_names + record.nameOffset, record.nameLength);
+    }
+    return QFile::decodeName(bytes);
+}
+
+void FilenameIndex::forEachDirectory(const std::function<bool(const QString &)> &visit) const {
+    for (quint32 i = 0; i < entryCount(); ++i) {
+        if ((m_entries[i].flags & kFlagDir) && !visit(path(i))) return;
+    }
+}
+
+const FilenameIndex::TrigramRecord *FilenameIndex::findTrigram(quint32 trigram) const {
+    const TrigramRecord *end = m_trigrams + m_header->trigramCount;
+    const TrigramRecord *it = std::lower_bound(m_trigrams, end, trigram, [](const TrigramRecord &record, quint32 value) {
+        return record.trigram < value;
+    });
+    return (it != end && it->trigram == trigram) ? it : nullptr;
+}
+
+void FilenameIndex::decodePostings(const TrigramRecord &record, std::vector<quint32> &out) const {
+    out.clear();
+    out.reserve(record.count);
+    const uchar *p = m_postings + record.offset;
+    const uchar *end = m_postings + m_header->postingsSize;
+    quint32 id = 0;
+    for (quint32 n = 0; n < record.count && p < end; ++n) {
+        quint32 delta = 0;
+        int shift = 0;
+        while (p < end) {
+            const uchar byte = *p++;
+            delta |= quint32(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) break;
+            shift += 7;
+        }
+        id += delta;
+        out.push_back(id);
+    }
+}
+
+bool FilenameIndex::candidates(const std::vector<quint32> &trigrams, std::vector<quint32> &out) const {
+    out.clear();
+    if (trigrams.empty()) return false;
+
+    std::vector<const TrigramRecord *> records;
+    for (quint32 trigram : trigrams) {
+        const TrigramRecord *record = findTrigram(trigram);
+        if (!record) return true;  // 有片段从未出现过，不可能匹配
+        records.push_back(record);
+    }
+    // 从最短的列表开始求交集
+    std::sort(records.begin(), records.end(), [](const TrigramRecord *a, const TrigramRecord *b) {
+        return a->count < b->count;
+    });
+    decodePostings(*records.front(), out);
+    std::vector<quint32> next;
+    std::vector<quint32> merged;
+    for (size_t i = 1; i < std::min(records.size(), kMaxIntersections) && !out.empty(); ++i) {
+        decodePostings(*records[i], next);
+        merged.clear();
+        std::set_intersection(out.begin(), out.end(), next.begin(), next.end(), std::back_inserter(merged));
+        out.swap(merged);
+    }
+    return true;
+}
+
+QVector<FilenameIndex::Match> FilenameIndex::search(const QString &query, int limit) const {
+    QVector<Match> results;
+    const QString trimmed = query.trimmed();
+    if (trimmed.isEmpty() || limit <= 0 || !m_header) return results;
+
+    QByteArray pattern = trimmed.toUtf8();
+    std::transform(pattern.begin(), pattern.end(), pattern.begin(), foldAscii);
+    const bool glob = isGlob(trimmed);
+
+    std::vector<quint32> trigrams;
+    if (glob) {
+        for (const QByteArray &literal : globLiterals(pattern)) {
+            collectTrigrams(literal.constData(), literal.size(), trigrams);
+        }
+    } else {
+        collectTrigrams(pattern.constData(), pattern.size(), trigrams);
+    }
+    sortUnique(trigrams);
+
+    // 在小写名称上核对：子串用 Boyer-Moore-Horspool 查找，通配符匹配整个名称
+    const std::boyer_moore_horspool_searcher<const char *> searcher(pattern.constData(), pattern.constData() + pattern.size());
+#ifdef Q_OS_UNIX
+    std::string nameBuffer;
+#else
+    const QRegularExpression globExpression(QRegularExpression::wildcardToRegularExpression(QString::fromUtf8(pattern)));
+#endif
+    auto matches = [&](quint32 id) {
+        const EntryRecord &record = m_entries[id];
+        const char *name = m_lowerNames + record.nameOffset;
+        if (!glob) {
+            const char *end = name + record.nameLength;
+            return std::search(name, end, searcher) != end;
+        }
+#ifdef Q_OS_UNIX
+        nameBuffer.assign(name, record.nameLength);
+        return ::fnmatch(pattern.constData(), nameBuffer.c_str(), 0) == 0;
+#else
+        return globExpression.match(QString::fromUtf8(name, record.nameLength)).hasMatch();
+#endif
+    };
+    auto consider = [&](quint32 id) {
+        if (matches(id)) {
+            results.append({path(id), (m_entries[id].flags & kFlagDir) != 0});
+        }
+        return results.size() < limit;
+    };
+
+    std::vector<quint32> ids;
+    if (candidates(trigrams, ids)) {
+        for (quint32 id : ids) {
+            if (id >= entryCount() || !consider(id)) break;
+        }
+    } else {
+        // 查询太短，没有可用的 trigram：顺序扫描全部名称
+        for (quint32 id = 0; id < entryCount(); ++id) {
+            if (!consider(id)) break;
+        }
+    }
+    return results;
+}
+
+bool FilenameIndex::nameMatches(const QString &query, const QString &name) {
+    const QString trimmed = query.trimmed();
+    if (trimmed.isEmpty()) return false;
+    if (isGlob(trimmed)) {
+        const QRegularExpression expression(QRegularExpression::wildcardToRegularExpression(trimmed),
+                                            QRegularExpression::CaseInsensitiveOption);
+        return expression.match(name).hasMatch();
+    }
+    return name.contains(trimmed, Qt::CaseInsensitive);
+}
@@ -0,0 +1,68 @@
+#ifndef FILENAMEINDEX_H
+#define FILENAMEINDEX_H
+
+#include <QDateTime>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// 文件名索引（类似 locate/Everything）：按广度优先记录各根目录下所有条目，文件格式紧凑，
+// 查询时直接内存映射，不需要整体读入。文件名的每个三字节片段（trigram）对应一个
+// 按条目编号排序、差值变长编码的倒排列表，子串和通配符查询先用倒排列表求交集再逐个核对。
+// 大小写只对 ASCII 字母折叠，中文等字符按原样匹配
+class FilenameIndex {
+public:
+    struct Match {
+        QString path;
+        bool isDir {false};
+    };
+
+    // 打开已有索引（内存映射）；文件不存在、已损坏或版本不符时返回空指针
+    static std::shared_ptr<FilenameIndex> open(const QString &filePath);
+
+    // 遍历 roots（不进入其它文件系统）并写出索引文件；progress 定期收到已收录的条目数
+    static bool build(const QStringList &roots, const QString &filePath, const std::atomic_bool &cancelled,
+                      const std::function<void(qint64)> &progress);
+
+    // 查询：含 * ? [ 时按通配符匹配整个文件名，否则按子串匹配；结果越靠前越接近根目录
+    QVector<Match> search(const QString &query, int limit) const;
+    // 与 search 相同的匹配规则，用于索引之外的少量新增条目
+    static bool nameMatches(const QString &query, const QString &name);
+
+    quint32 entryCount() const;
+    QDateTime buildTime() const;
+    QStringList roots() const;
+
+    // 按索引顺序（由浅到深）访问所有目录，visit 返回 false 时停止
+    void forEachDirectory(const std::function<bool(const QString &)> &visit) const;
+
+private:
+    struct Header;
+    struct EntryRecord;
+    struct TrigramRecord;
+
+    FilenameIndex() = default;
+    QString path(quint32 entry) const;
+    const TrigramRecord *findTrigram(quint32 trigram) const;
+    void decodePostings(const TrigramRecord &record, std::vector<quint32> &out) const;
+    // 取出各 trigram 倒排列表的交集；返回 false 表示没有可用的 trigram（需要全量扫描）
+    bool candidates(const std::vector<quint32> &trigrams, std::vector<quint32> &out) const;
+
+    QFile m_file;
+    const uchar *m_data {nullptr};
+    qint64 m_size {0};
+    const Header *m_header {nullptr};
+    const EntryRecord *m_entries {nullptr};
+    const char *m_names {nullptr};
+    const char *m_lowerNames {nullptr};
+    const TrigramRecord *m_trigrams {nullptr};
+    const uchar *m_postings {nullptr};
+};
+
+#endif // FILENAMEINDEX_H
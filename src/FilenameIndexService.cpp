@@ -0,0 +1,298 @@
+#include "FilenameIndexService.h"
+#include "DirectoryReader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QSettings>
+#include <QSocketNotifier>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// 增量记录超过该数量（或 inotify 队列溢出）时重建索引
+constexpr int kMaxDeltaEntries = 50000;
+// 定期检查索引是否超过重建间隔，重建期间刷新进度
+constexpr int kRebuildCheckMs = 60 * 60 * 1000;
+constexpr int kProgressPollMs = 500;
+// 后台添加监视时每添加这么多个就交给界面线程，之后这些目录的事件即可处理
+constexpr int kWatchBatch = 1024;
+#ifdef Q_OS_LINUX
+constexpr uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR | IN_DONT_FOLLOW;
+#endif
+}
+
+FilenameIndexService::FilenameIndexService(QObject *parent) : QObject(parent) {
+    QSettings settings;
+    m_rebuildHours = settings.value("search/rebuildHours", 24).toInt();
+    m_watchBudget = settings.value("search/maxWatches", 65536).toInt();
+
+    m_rebuildTimer = new QTimer(this);
+    m_rebuildTimer->setInterval(kRebuildCheckMs);
+    connect(m_rebuildTimer, &QTimer::timeout, this, &FilenameIndexService::checkRebuild);
+    m_rebuildTimer->start();
+
+#ifdef Q_OS_LINUX
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd >= 0) {
+        m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &FilenameIndexService::readWatchEvents);
+    }
+#endif
+}
+
+FilenameIndexService::~FilenameIndexService() {
+    if (m_cancelBuild) m_cancelBuild->store(true);
+    if (m_cancelWatch) m_cancelWatch->store(true);
+    // 添加监视的后台任务仍在使用 inotify 句柄，等它们全部结束后再关闭
+    for (QFuture<void> &task : m_watchTasks) task.waitForFinished();
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0) {
+        delete m_notifier;
+        ::close(m_inotifyFd);
+    }
+#endif
+}
+
+QString FilenameIndexService::indexFilePath() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/filename-index.bin";
+}
+
+QStringList FilenameIndexService::normalizeRoots(const QStringList &roots) {
+    QStringList cleaned;
+    for (const QString &root : roots) {
+        const QString path = QDir::cleanPath(root);
+        if (!path.isEmpty() && QFileInfo(path).isDir() && !cleaned.contains(path)) cleaned.append(path);
+    }
+    std::sort(cleaned.begin(), cleaned.end(), [](const QString &a, const QString &b) { return a.size() < b.size(); });
+
+    QStringList result;
+    QList<quint64> devices;
+    for (const QString &path : cleaned) {
+        DirectoryEntry info;
+        if (!DirectoryReader::stat(QFile::encodeName(path), info)) continue;
+        bool covered = false;
+        for (int i = 0; i < result.size() && !covered; ++i) {
+            const QString prefix = result[i].endsWith('/') ? result[i] : result[i] + '/';
+            covered = path.startsWith(prefix) && devices[i] == info.dev;
+        }
+        if (!covered) {
+            result.append(path);
+            devices.append(info.dev);
+        }
+    }
+    return result;
+}
+
+void FilenameIndexService::setRoots(const QStringList &roots) {
+    m_roots = normalizeRoots(roots);
+    if (!m_index) {
+        // 先使用上次的索引，重建在后台进行
+        const std::shared_ptr<FilenameIndex> index = FilenameIndex::open(indexFilePath());
+        if (index) adoptIndex(index);
+    }
+    checkRebuild();
+}
+
+void FilenameIndexService::checkRebuild() {
+    if (m_building || m_roots.isEmpty()) return;
+    if (!m_index) {
+        rebuild();
+        return;
+    }
+    QStringList indexed = m_index->roots();
+    QStringList wanted = m_roots;
+    indexed.sort();
+    wanted.sort();
+    if (indexed != wanted || m_index->buildTime().addSecs(qint64(m_rebuildHours) * 3600) < QDateTime::currentDateTime()) {
+        rebuild();
+    }
+}
+
+void FilenameIndexService::rebuild() {
+    if (m_building || m_roots.isEmpty()) return;
+    m_building = true;
+
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    auto counter = std::make_shared<std::atomic<qint64>>(0);
+    m_cancelBuild = cancelled;
+
+    // 后台任务只通过共享计数器报告进度，不引用本对象
+    auto *progressTimer = new QTimer(this);
+    progressTimer->setInterval(kProgressPollMs);
+    connect(progressTimer, &QTimer::timeout, this, [this, counter]() {
+        emit indexingProgress(counter->load());
+    });
+    progressTimer->start();
+
+    using IndexPtr = std::shared_ptr<FilenameIndex>;
+    auto *watcher = new QFutureWatcher<IndexPtr>(this);
+    connect(watcher, &QFutureWatcher<IndexPtr>::finished, this, [this, watcher, progressTimer, cancelled]() {
+        watcher->deleteLater();
+        progressTimer->deleteLater();
+        m_building = false;
+        if (cancelled->load()) return;
+        const IndexPtr index = watcher->result();
+        if (index) adoptIndex(index);
+    });
+
+    const QStringList roots = m_roots;
+    const QString path = indexFilePath();
+    watcher->setFuture(QtConcurrent::run([roots, path, cancelled, counter]() -> IndexPtr {
+        if (!FilenameIndex::build(roots, path, *cancelled, [counter](qint64 entries) { counter->store(entries); })) {
+            return nullptr;
+        }
+        return FilenameIndex::open(path);
+    }));
+}
+
+void FilenameIndexService::adoptIndex(const std::shared_ptr<FilenameIndex> &index) {
+    m_index = index;
+    // 新索引已包含此前记录的变化
+    m_added.clear();
+    m_removed.clear();
+    emit indexReady(index->entryCount());
+    startWatching();
+}
+
+void FilenameIndexService::startWatching() {
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd < 0 || !m_index) return;
+    if (m_cancelWatch) m_cancelWatch->store(true);
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    m_cancelWatch = cancelled;
+
+    m_watchTasks.erase(std::remove_if(m_watchTasks.begin(), m_watchTasks.end(),
+                                      [](const QFuture<void> &task) { return task.isFinished(); }),
+                       m_watchTasks.end());
+
+    // 添加监视需要逐个解析路径，放到后台进行；索引按由浅到深排列，预算用完时深层目录不再监视。
+    // 已添加的监视分批交给界面线程合并，不必等全部添加完才开始处理事件。
+    // 被取代的任务已添加的监视仍然有效，同样合并
+    using WatchMap = QHash<int, QString>;
+    const std::shared_ptr<FilenameIndex> index = m_index;
+    const int fd = m_inotifyFd;
+    const int budget = m_watchBudget;
+    m_watchTasks.append(QtConcurrent::run([this, index, fd, budget, cancelled]() {
+        WatchMap batch;
+        int added = 0;
+        const auto post = [&]() {
+            if (batch.isEmpty()) return;
+            QMetaObject::invokeMethod(this, [this, batch]() { addWatches(batch); }, Qt::QueuedConnection);
+            batch.clear();
+        };
+        index->forEachDirectory([&](const QString &dir) {
+            if (cancelled->load() || added >= budget) return false;
+            const int wd = inotify_add_watch(fd, QFile::encodeName(dir).constData(), kWatchMask);
+            if (wd >= 0) {
+                batch.insert(wd, dir);
+                ++added;
+                if (batch.size() >= kWatchBatch) post();
+            } else if (errno == ENOSPC) {
+                return false;  // 达到系统的 max_user_watches 上限
+            }
+            return true;
+        });
+        post();
+    }));
+#endif
+}
+
+void FilenameIndexService::addWatches(const QHash<int, QString> &watches) {
+    for (auto it = watches.constBegin(); it != watches.constEnd(); ++it) m_watches.insert(it.key(), it.value());
+}
+
+void FilenameIndexService::readWatchEvents() {
+#ifdef Q_OS_LINUX
+    bool overflow = false;
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    for (;;) {
+        const ssize_t length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+        for (char *p = buffer; p < buffer + length;) {
+            const auto *event = reinterpret_cast<const struct inotify_event *>(p);
+            p += sizeof(struct inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                m_watches.remove(event->wd);
+                continue;
+            }
+            const QString dir = m_watches.value(event->wd);
+            if (dir.isEmpty() || event->len == 0) continue;
+
+            const QString path = (dir.endsWith('/') ? dir : dir + '/') + QFile::decodeName(event->name);
+            const bool isDir = event->mask & IN_ISDIR;
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                recordChange(path, isDir, true);
+                if (isDir && m_watches.size() < m_watchBudget) {
+                    const int wd = inotify_add_watch(m_inotifyFd, QFile::encodeName(path).constData(), kWatchMask);
+                    if (wd >= 0) m_watches.insert(wd, path);
+                }
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                recordChange(path, isDir, false);
+            }
+        }
+    }
+    // 丢失了事件或变化过多时，增量记录已不可靠或查询变慢，重新建立索引
+    if (overflow || m_added.size() + m_removed.size() > kMaxDeltaEntries) {
+        rebuild();
+    }
+#endif
+}
+
+void FilenameIndexService::recordChange(const QString &path, bool isDir, bool exists) {
+    if (exists) {
+        m_removed.remove(path);
+        m_added.insert(path, isDir);
+    } else {
+        m_added.remove(path);
+        m_removed.insert(path);
+    }
+}
+
+bool FilenameIndexService::isRemoved(const QString &path) const {
+    if (m_removed.isEmpty()) return false;
+    // 删除或移走的目录下的所有条目都视为已删除
+    QString current = path;
+    for (;;) {
+        if (m_removed.contains(current)) return true;
+        const int slash = current.lastIndexOf('/');
+        if (slash <= 0) return false;
+        current.truncate(slash);
+    }
+}
+
+QVector<FilenameIndex::Match> FilenameIndexService::search(const QString &query, int limit) const {
+    QVector<FilenameIndex::Match> results;
+    QSet<QString> seen;
+    if (m_index) {
+        // 多取一些，补上被过滤掉的已删除条目
+        const int extra = qMin(m_removed.size(), 1000);
+        for (const FilenameIndex::Match &match : m_index->search(query, limit + extra)) {
+            if (isRemoved(match.path)) continue;
+            results.append(match);
+            seen.insert(match.path);
+            if (results.size() >= limit) return results;
+        }
+    }
+    for (auto it = m_added.constBegin(); it != m_added.constEnd() && results.size() < limit; ++it) {
+        if (seen.contains(it.key()) || isRemoved(it.key())) continue;
+        if (FilenameIndex::nameMatches(query, QFileInfo(it.key()).fileName())) {
+            results.append({it.key(), it.value()});
+        }
+    }
+    return results;
+}
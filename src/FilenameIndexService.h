@@ -0,0 +1,73 @@
+#ifndef FILENAMEINDEXSERVICE_H
+#define FILENAMEINDEXSERVICE_H
+
+#include "FilenameIndex.h"
+
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+#include <atomic>
+#include <memory>
+
+class QSocketNotifier;
+class QTimer;
+
+// 文件名搜索服务：管理索引文件的后台重建，并用 inotify 记录索引建立之后的增删，
+// 查询结果 = 索引结果 - 已删除的路径 + 新增的路径
+class FilenameIndexService : public QObject {
+    Q_OBJECT
+public:
+    explicit FilenameIndexService(QObject *parent = nullptr);
+    ~FilenameIndexService() override;
+
+    // 设置要索引的根目录；打开已有索引，根目录变化或索引超过重建间隔时在后台重建
+    void setRoots(const QStringList &roots);
+    void rebuild();
+
+    bool isReady() const { return m_index != nullptr; }
+    bool isBuilding() const { return m_building; }
+    QVector<FilenameIndex::Match> search(const QString &query, int limit) const;
+
+signals:
+    void indexingProgress(qint64 entries);
+    void indexReady(quint32 entries);
+
+private:
+    static QString indexFilePath();
+    // 去掉与其它根目录同一文件系统且位于其下的根目录，避免重复收录
+    static QStringList normalizeRoots(const QStringList &roots);
+
+    void adoptIndex(const std::shared_ptr<FilenameIndex> &index);
+    void checkRebuild();
+    void startWatching();
+    void readWatchEvents();
+    // 合并后台任务添加的一批监视
+    void addWatches(const QHash<int, QString> &watches);
+    void recordChange(const QString &path, bool isDir, bool exists);
+    bool isRemoved(const QString &path) const;
+
+    QStringList m_roots;
+    std::shared_ptr<FilenameIndex> m_index;
+    bool m_building {false};
+    std::shared_ptr<std::atomic_bool> m_cancelBuild;
+    QTimer *m_rebuildTimer {nullptr};
+    int m_rebuildHours {24};
+
+    // 索引建立后的变化
+    QHash<QString, bool> m_added;  // 路径 -> 是否目录
+    QSet<QString> m_removed;
+
+    // inotify：每个被监视的目录一个 wd，数量受 m_watchBudget 限制
+    int m_inotifyFd {-1};
+    QSocketNotifier *m_notifier {nullptr};
+    QHash<int, QString> m_watches;
+    int m_watchBudget {65536};
+    std::shared_ptr<std::atomic_bool> m_cancelWatch;
+    QList<QFuture<void>> m_watchTasks;  // 添加监视的后台任务，包括已被取代但可能尚未退出的
+};
+
+#endif // FILENAMEINDEXSERVICE_H
@@ -2,6 +2,17 @@
 #include "ImageViewer.h"
 #include "TextPreviewer.h"
 #include "MediaViewer.h"
+#include "ThumbnailLoader.h"
+#include "ThumbnailRenderer.h"
+#include "DirectorySizeCalculator.h"
+#include "DiskUsageView.h"
+#include "FileSizeFormat.h"
+#include "FilenameIndexService.h"
+#include "StreamingFilterProxyModel.h"
+#include "ContentSearchView.h"
+#include "DirectorySnapshotCache.h"
+#include "NativeFileModel.h"
+#include "VolumeMonitor.h"
 
 #ifdef HAVE_QT_PDF_CORE
 #include "PdfSimpleViewer.h"
@@ -30,6 +41,7 @@
 #include <QMessageBox>
 #include <QStatusBar>
 #include <QFileIconProvider>
+#include <QElapsedTimer>
 #include <QStandardPaths>
 #include <QDateTime>
 #include <QToolBar>
@@ -37,7 +49,6 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QScrollArea>
-#include <QStorageInfo>
 #include <QMenu>
 #include <QAction>
 #include <QDialog>
@@ -47,408 +58,168 @@
 #include <QApplication>
 #include <QClipboard>
 #include "OfficeConverter.h"
+#include "OfficeConversionService.h"
+#include "OfficePrewarmer.h"
+#include "OfficeToolRegistry.h"
 #include <QtConcurrent>
 #include <QFutureWatcher>
+#include <QDirIterator>
+#include <QPointer>
+#include <QSignalBlocker>
 #include <QImageReader>
 #include <QPainter>
 #include <QPolygonF>
 #include <QFont>
 #include <QFile>
 #include <QTextStream>
-#ifdef HAVE_QT_PDF_CORE
-#include <QtPdf/QPdfDocument>
-#endif
 #include <QPushButton>
 #include <QWidgetAction>
+#include <QScrollBar>
+#include <QMutexLocker>
+#include <QSettings>
+#include <limits>
 
 // ThumbnailIconProvider 实现
-bool ThumbnailIconProvider::isImageFile(const QString &filePath) {
-    const QByteArray suffix = QFileInfo(filePath).suffix().toLower().toUtf8();
-    const QList<QByteArray> fmts = QImageReader::supportedImageFormats();
-    return fmts.contains(suffix);
+namespace {
+// 默认内存预算；系统图标由主题共享，只按固定开销计入
+constexpr qint64 kDefaultThumbnailBudget = 64 * 1024 * 1024;
+constexpr qint64 kFallbackIconCost = 1024;
+}
+
+ThumbnailIconProvider::ThumbnailIconProvider(bool *enableThumbnails, ThumbnailLoader *loader)
+    : m_enableThumbnails(enableThumbnails), m_loader(loader) {
+    setMemoryBudget(kDefaultThumbnailBudget);
+}
+
+void ThumbnailIconProvider::setMemoryBudget(qint64 bytes) {
+    QMutexLocker locker(&m_cacheMutex);
+    // QCache 的开销在 Qt5 中是 int
+    const qint64 budget = qBound<qint64>(kFallbackIconCost, bytes, std::numeric_limits<int>::max());
+    const int before = m_thumbnailCache.size();
+    m_thumbnailCache.setMaxCost(budget);
+    m_stats.evictions += before - m_thumbnailCache.size();
+    m_stats.budgetBytes = budget;
+}
+
+ThumbnailIconProvider::CacheStats ThumbnailIconProvider::cacheStats() const {
+    QMutexLocker locker(&m_cacheMutex);
+    CacheStats stats = m_stats;
+    stats.residentBytes = m_thumbnailCache.totalCost();
+    stats.entries = m_thumbnailCache.size();
+    return stats;
+}
+
+bool ThumbnailIconProvider::lookup(const QString &key, QIcon *icon) const {
+    // object() 同时把条目移到 LRU 链表头部
+    if (const QIcon *cached = m_thumbnailCache.object(key)) {
+        ++m_stats.hits;
+        *icon = *cached;
+        return true;
+    }
+    ++m_stats.misses;
+    return false;
+}
+
+void ThumbnailIconProvider::insert(const QString &key, const QIcon &icon, qint64 bytes) const {
+    const int before = m_thumbnailCache.size() + (m_thumbnailCache.contains(key) ? 0 : 1);
+    m_thumbnailCache.insert(key, new QIcon(icon), qMax<qint64>(1, bytes));
+    m_stats.evictions += before - m_thumbnailCache.size();
 }
 
 QIcon ThumbnailIconProvider::icon(const QFileInfo &info) const {
     // 如果缩略图功能被禁用，直接使用默认图标
-    if (!m_enableThumbnails || !*m_enableThumbnails) {
+    if (!thumbnailsEnabled() || !info.isFile()) {
         return QFileIconProvider::icon(info);
     }
     
     const QString filePath = info.absoluteFilePath();
     
-    // 对于图片文件，生成缩略图
-    if (info.isFile() && isImageFile(filePath)) {
-        // 检查缓存
-        if (m_thumbnailCache.contains(filePath)) {
-            return m_thumbnailCache.value(filePath);
-        }
-        
-        // 生成缩略图
-        QPixmap originalPixmap(filePath);
-        if (!originalPixmap.isNull()) {
-            // 创建纸张样式的背景 (类似文档图标)
-            QPixmap documentIcon(80, 96); // 文档比例 (4:3 -> 5:6)
-            documentIcon.fill(Qt::transparent);
-            
-            QPainter painter(&documentIcon);
-            painter.setRenderHint(QPainter::Antialiasing);
-            
-            // 绘制纸张背景
-            QRectF docRect(4, 4, 72, 88);
-            
-            // 绘制阴影
-            painter.setBrush(QColor(0, 0, 0, 40));
-            painter.setPen(Qt::NoPen);
-            painter.drawRoundedRect(docRect.translated(2, 2), 4, 4);
-            
-            // 绘制白色纸张背景
-            painter.setBrush(Qt::white);
-            painter.setPen(QPen(QColor(200, 200, 200), 1));
-            painter.drawRoundedRect(docRect, 4, 4);
-            
-            // 绘制右上角折叠效果
-            QPolygonF foldTriangle;
-            foldTriangle << QPointF(docRect.right() - 12, docRect.top())
-                        << QPointF(docRect.right(), docRect.top() + 12)
-                        << QPointF(docRect.right(), docRect.top());
-            painter.setBrush(QColor(230, 230, 230));
-            painter.setPen(QPen(QColor(200, 200, 200), 1));
-            painter.drawPolygon(foldTriangle);
-            
-            // 在纸张内部绘制缩略图内容
-            QRectF contentRect = docRect.adjusted(6, 8, -6, -8);
-            
-            // 缩放图片以适应内容区域
-            QPixmap scaledPixmap = originalPixmap.scaled(
-                contentRect.size().toSize(), 
-                Qt::KeepAspectRatio, 
-                Qt::SmoothTransformation
-            );
-            
-            // 居中绘制缩略图
-            QPointF imagePos = contentRect.center() - QRectF(scaledPixmap.rect()).center();
-            painter.drawPixmap(imagePos, scaledPixmap);
-            
-            QIcon thumbnailIcon(documentIcon);
-            
-            // 缓存缩略图
-            m_thumbnailCache.insert(filePath, thumbnailIcon);
-            return thumbnailIcon;
+    // 已生成的缩略图
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        QIcon cached;
+        if (lookup(filePath, &cached)) {
+            return cached;
         }
     }
     
-    // 对于PDF文件，尝试生成真实内容预览
-    if (info.isFile() && info.suffix().toLower() == "pdf") {
-        // 检查缓存
-        QString cacheKey = filePath + "_pdf_real";
-        if (m_thumbnailCache.contains(cacheKey)) {
-            return m_thumbnailCache.value(cacheKey);
-        }
-        
-#ifdef HAVE_QT_PDF_CORE
-        // 尝试使用Qt PDF模块生成真实预览
-        QPdfDocument pdfDoc;
-        if (pdfDoc.load(filePath) == QPdfDocument::Error::None && pdfDoc.pageCount() > 0) {
-            // 渲染第一页
-            QSizeF pageSize = pdfDoc.pagePointSize(0);
-            qreal scale = qMin(60.0 / pageSize.width(), 72.0 / pageSize.height());
-            QSize renderSize = (pageSize * scale).toSize();
-            
-            QImage pdfImage = pdfDoc.render(0, renderSize);
-            
-            if (!pdfImage.isNull()) {
-                // 创建文档样式背景
-                QPixmap pdfIcon(80, 96);
-                pdfIcon.fill(Qt::transparent);
-                
-                QPainter painter(&pdfIcon);
-                painter.setRenderHint(QPainter::Antialiasing);
-                
-                QRectF docRect(4, 4, 72, 88);
-                
-                // 绘制阴影
-                painter.setBrush(QColor(0, 0, 0, 40));
-                painter.setPen(Qt::NoPen);
-                painter.drawRoundedRect(docRect.translated(2, 2), 4, 4);
-                
-                // 绘制白色纸张背景
-                painter.setBrush(Qt::white);
-                painter.setPen(QPen(QColor(200, 200, 200), 1));
-                painter.drawRoundedRect(docRect, 4, 4);
-                
-                // 绘制右上角折叠效果
-                QPolygonF foldTriangle;
-                foldTriangle << QPointF(docRect.right() - 12, docRect.top())
-                            << QPointF(docRect.right(), docRect.top() + 12)
-                            << QPointF(docRect.right(), docRect.top());
-                painter.setBrush(QColor(230, 230, 230));
-                painter.setPen(QPen(QColor(200, 200, 200), 1));
-                painter.drawPolygon(foldTriangle);
-                
-                // 在纸张内部绘制PDF内容
-                QRectF contentRect = docRect.adjusted(6, 8, -6, -12);
-                QPixmap pdfPixmap = QPixmap::fromImage(pdfImage.scaled(
-                    contentRect.size().toSize(), 
-                    Qt::KeepAspectRatio, 
-                    Qt::SmoothTransformation
-                ));
-                
-                // 居中绘制PDF内容
-                QPointF imagePos = contentRect.center() - QRectF(pdfPixmap.rect()).center();
-                painter.drawPixmap(imagePos, pdfPixmap);
-                
-                // 绘制PDF标识
-                painter.setFont(QFont("Arial", 7, QFont::Bold));
-                painter.setPen(QColor(220, 53, 69));
-                painter.drawText(docRect.adjusted(6, docRect.height() - 16, -6, -4), 
-                                Qt::AlignLeft | Qt::AlignBottom, "PDF");
-                
-                QIcon pdfIconResult(pdfIcon);
-                m_thumbnailCache.insert(cacheKey, pdfIconResult);
-                return pdfIconResult;
-            }
-        }
-#endif
-        
-        // 如果PDF预览失败，使用模拟内容
-        QPixmap pdfIcon(80, 96);
-        pdfIcon.fill(Qt::transparent);
-        
-        QPainter painter(&pdfIcon);
-        painter.setRenderHint(QPainter::Antialiasing);
-        
-        QRectF docRect(4, 4, 72, 88);
-        
-        // 绘制阴影
-        painter.setBrush(QColor(0, 0, 0, 40));
-        painter.setPen(Qt::NoPen);
-        painter.drawRoundedRect(docRect.translated(2, 2), 4, 4);
-        
-        // 绘制白色纸张背景
-        painter.setBrush(Qt::white);
-        painter.setPen(QPen(QColor(200, 200, 200), 1));
-        painter.drawRoundedRect(docRect, 4, 4);
-        
-        // 绘制右上角折叠效果
-        QPolygonF foldTriangle;
-        foldTriangle << QPointF(docRect.right() - 12, docRect.top())
-                    << QPointF(docRect.right(), docRect.top() + 12)
-                    << QPointF(docRect.right(), docRect.top());
-        painter.setBrush(QColor(230, 230, 230));
-        painter.setPen(QPen(QColor(200, 200, 200), 1));
-        painter.drawPolygon(foldTriangle);
-        
-        // 绘制PDF内容样式（模拟文本行）
-        painter.setPen(QPen(QColor(100, 100, 100), 1));
-        QRectF contentRect = docRect.adjusted(8, 12, -8, -8);
-        
-        // 绘制标题区域
-        painter.setBrush(QColor(220, 220, 220));
-        painter.drawRect(contentRect.left(), contentRect.top(), contentRect.width(), 8);
-        
-        // 绘制文本行
-        for (int i = 0; i < 8; ++i) {
-            float y = contentRect.top() + 16 + i * 6;
-            float width = contentRect.width() * (0.7 + (i % 3) * 0.1);
-            painter.drawLine(contentRect.left(), y, contentRect.left() + width, y);
-        }
-        
-        // 绘制PDF标识
-        painter.setFont(QFont("Arial", 8, QFont::Bold));
-        painter.setPen(QColor(220, 53, 69)); // PDF红色
-        painter.drawText(contentRect.adjusted(0, contentRect.height() - 16, 0, 0), 
-                        Qt::AlignLeft | Qt::AlignBottom, "PDF");
-        
-        QIcon pdfIconResult(pdfIcon);
-        m_thumbnailCache.insert(cacheKey, pdfIconResult);
-        return pdfIconResult;
+    // 图片、PDF、文本需要读取文件内容，由视图绘制时通过 thumbnail() 提交后台任务，这里先返回系统图标
+    if (ThumbnailRenderer::hasContentThumbnail(filePath)) {
+        return QFileIconProvider::icon(info);
     }
     
-    // 对于文本文件，生成真实内容预览
-    if (info.isFile()) {
-        QString ext = info.suffix().toLower();
-        QStringList textTypes = {"txt", "md", "cpp", "h", "hpp", "c", "py", "js", "ts", "html", "css", "xml", "json", "yml", "yaml", "ini", "conf", "log", "sh", "bat"};
-        
-        if (textTypes.contains(ext)) {
-            QString cacheKey = filePath + "_text_real";
-            if (m_thumbnailCache.contains(cacheKey)) {
-                return m_thumbnailCache.value(cacheKey);
-            }
-            
-            // 读取文件内容
-            QFile file(filePath);
-            if (file.open(QIODevice::ReadOnly | QIODevice::Text) && file.size() < 1024 * 1024) { // 限制1MB
-                QTextStream stream(&file);
-                // Qt6 中不再需要 setCodec，默认使用 UTF-8
-                QString content = stream.read(2000); // 读取前2000个字符
-                file.close();
-                
-                if (!content.isEmpty()) {
-                    // 创建文档样式背景
-                    QPixmap textIcon(80, 96);
-                    textIcon.fill(Qt::transparent);
-                    
-                    QPainter painter(&textIcon);
-                    painter.setRenderHint(QPainter::Antialiasing);
-                    painter.setRenderHint(QPainter::TextAntialiasing);
-                    
-                    QRectF docRect(4, 4, 72, 88);
-                    
-                    // 绘制阴影
-                    painter.setBrush(QColor(0, 0, 0, 40));
-                    painter.setPen(Qt::NoPen);
-                    painter.drawRoundedRect(docRect.translated(2, 2), 4, 4);
-                    
-                    // 绘制白色纸张背景
-                    painter.setBrush(Qt::white);
-                    painter.setPen(QPen(QColor(200, 200, 200), 1));
-                    painter.drawRoundedRect(docRect, 4, 4);
-                    
-                    // 绘制右上角折叠效果
-                    QPolygonF foldTriangle;
-                    foldTriangle << QPointF(docRect.right() - 12, docRect.top())
-                                << QPointF(docRect.right(), docRect.top() + 12)
-                                << QPointF(docRect.right(), docRect.top());
-                    painter.setBrush(QColor(230, 230, 230));
-                    painter.setPen(QPen(QColor(200, 200, 200), 1));
-                    painter.drawPolygon(foldTriangle);
-                    
-                    // 绘制真实文本内容
-                    QRectF contentRect = docRect.adjusted(6, 8, -6, -12);
-                    
-                    // 设置字体
-                    QFont font("Consolas", 5); // 使用等宽字体
-                    if (!QFontInfo(font).exactMatch()) {
-                        font = QFont("Courier New", 5);
-                    }
-                    if (!QFontInfo(font).exactMatch()) {
-                        font = QFont("monospace", 5);
-                    }
-                    painter.setFont(font);
-                    
-                    // 设置文本颜色
-                    painter.setPen(QColor(60, 60, 60));
-                    
-                    // 分行显示文本
-                    QStringList lines = content.split('\n');
-                    int maxLines = qMin(lines.size(), 12); // 最多显示12行
-                    
-                    for (int i = 0; i < maxLines; ++i) {
-                        QString line = lines[i];
-                        if (line.length() > 15) {
-                            line = line.left(15) + "...";
-                        }
-                        
-                        QRectF lineRect(contentRect.left(), 
-                                       contentRect.top() + i * 6, 
-                                       contentRect.width(), 6);
-                        
-                        painter.drawText(lineRect, Qt::AlignLeft | Qt::AlignTop, line);
-                    }
-                    
-                    // 绘制文件类型标识
-                    painter.setFont(QFont("Arial", 7, QFont::Bold));
-                    painter.setPen(QColor(70, 130, 180));
-                    painter.drawText(docRect.adjusted(6, docRect.height() - 16, -6, -4), 
-                                    Qt::AlignLeft | Qt::AlignBottom, ext.toUpper());
-                    
-                    QIcon textIconResult(textIcon);
-                    m_thumbnailCache.insert(cacheKey, textIconResult);
-                    return textIconResult;
-                }
-            }
+    // 对于其他办公文档类型，使用按扩展名共享的通用文档图标（不读取文件内容）
+    const QString ext = info.suffix().toLower();
+    if (ThumbnailRenderer::isDocumentSuffix(ext)) {
+        QMutexLocker locker(&m_cacheMutex);
+        return typeIcon(ThumbnailRenderer::documentTypeKey(ext),
+                        ThumbnailRenderer::renderDocumentIcon(ext, m_devicePixelRatio));
+    }
+    
+    // 对于非文档文件，使用默认图标
+    return QFileIconProvider::icon(info);
+}
+
+QIcon ThumbnailIconProvider::thumbnail(const QString &filePath) const {
+    if (!thumbnailsEnabled()) {
+        return QIcon();
+    }
+    
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        QIcon cached;
+        if (lookup(filePath, &cached)) {
+            return cached;
         }
     }
     
-    // 对于其他办公文档类型，创建通用文档图标
-    if (info.isFile()) {
-        QString ext = info.suffix().toLower();
-        QStringList docTypes = {"doc", "docx", "txt", "rtf", "odt"};
-        QStringList spreadsheetTypes = {"xls", "xlsx", "ods", "csv"};
-        QStringList presentationTypes = {"ppt", "pptx", "odp"};
-        
-        if (docTypes.contains(ext) || spreadsheetTypes.contains(ext) || presentationTypes.contains(ext)) {
-            QString cacheKey = filePath + "_doc_" + ext;
-            if (m_thumbnailCache.contains(cacheKey)) {
-                return m_thumbnailCache.value(cacheKey);
-            }
-            
-            QPixmap docIcon(80, 96);
-            docIcon.fill(Qt::transparent);
-            
-            QPainter painter(&docIcon);
-            painter.setRenderHint(QPainter::Antialiasing);
-            
-            QRectF docRect(4, 4, 72, 88);
-            
-            // 绘制阴影
-            painter.setBrush(QColor(0, 0, 0, 40));
-            painter.setPen(Qt::NoPen);
-            painter.drawRoundedRect(docRect.translated(2, 2), 4, 4);
-            
-            // 绘制白色纸张背景
-            painter.setBrush(Qt::white);
-            painter.setPen(QPen(QColor(200, 200, 200), 1));
-            painter.drawRoundedRect(docRect, 4, 4);
-            
-            // 绘制右上角折叠效果
-            QPolygonF foldTriangle;
-            foldTriangle << QPointF(docRect.right() - 12, docRect.top())
-                        << QPointF(docRect.right(), docRect.top() + 12)
-                        << QPointF(docRect.right(), docRect.top());
-            painter.setBrush(QColor(230, 230, 230));
-            painter.setPen(QPen(QColor(200, 200, 200), 1));
-            painter.drawPolygon(foldTriangle);
-            
-            // 根据文件类型绘制不同的内容
-            QRectF contentRect = docRect.adjusted(8, 12, -8, -8);
-            
-            if (docTypes.contains(ext)) {
-                // 文档类型 - 绘制文本行
-                painter.setPen(QPen(QColor(100, 100, 100), 1));
-                for (int i = 0; i < 10; ++i) {
-                    float y = contentRect.top() + i * 6;
-                    float width = contentRect.width() * (0.8 + (i % 3) * 0.1);
-                    painter.drawLine(contentRect.left(), y, contentRect.left() + width, y);
-                }
-            } else if (spreadsheetTypes.contains(ext)) {
-                // 表格类型 - 绘制网格
-                painter.setPen(QPen(QColor(150, 150, 150), 1));
-                // 绘制网格
-                for (int i = 0; i <= 4; ++i) {
-                    float x = contentRect.left() + i * (contentRect.width() / 4);
-                    painter.drawLine(x, contentRect.top(), x, contentRect.bottom());
-                }
-                for (int i = 0; i <= 6; ++i) {
-                    float y = contentRect.top() + i * (contentRect.height() / 6);
-                    painter.drawLine(contentRect.left(), y, contentRect.right(), y);
-                }
-            } else if (presentationTypes.contains(ext)) {
-                // 演示文稿类型 - 绘制幻灯片样式
-                painter.setBrush(QColor(240, 240, 240));
-                painter.setPen(QPen(QColor(200, 200, 200), 1));
-                QRectF slideRect = contentRect.adjusted(4, 4, -4, -20);
-                painter.drawRect(slideRect);
-                
-                // 绘制标题区域
-                painter.setBrush(QColor(220, 220, 220));
-                painter.drawRect(slideRect.left(), slideRect.top(), slideRect.width(), 12);
+    // 办公文档只在预热时生成过首页缩略图（磁盘缓存）时有内容缩略图，否则仍显示类型图标
+    if (m_loader && (ThumbnailRenderer::hasContentThumbnail(filePath) || OfficeConverter::isOfficeDocument(filePath))) {
+        m_loader->request(filePath);
+    }
+    return QIcon();
+}
+
+void ThumbnailIconProvider::scheduleThumbnails(const QStringList &orderedPaths) const {
+    if (!m_loader) return;
+    QStringList missing;
+    {
+        // 只查询是否存在，不影响 LRU 顺序和命中统计
+        QMutexLocker locker(&m_cacheMutex);
+        for (const QString &path : orderedPaths) {
+            if (!m_thumbnailCache.contains(path)
+                && (ThumbnailRenderer::hasContentThumbnail(path) || OfficeConverter::isOfficeDocument(path))) {
+                missing.append(path);
             }
-            
-            // 绘制文件类型标识
-            painter.setFont(QFont("Arial", 7, QFont::Bold));
-            painter.setPen(QColor(70, 130, 180));
-            painter.drawText(contentRect.adjusted(0, contentRect.height() - 12, 0, 0), 
-                            Qt::AlignLeft | Qt::AlignBottom, ext.toUpper());
-            
-            QIcon docIconResult(docIcon);
-            m_thumbnailCache.insert(cacheKey, docIconResult);
-            return docIconResult;
         }
     }
-    
-    // 对于非文档文件，使用默认图标
-    return QFileIconProvider::icon(info);
+    m_loader->schedule(missing);
+}
+
+QIcon ThumbnailIconProvider::typeIcon(const QString &typeKey, const QImage &image) const {
+    const QString key = QString("%1@%2").arg(typeKey).arg(image.devicePixelRatio());
+    auto it = m_typeIcons.constFind(key);
+    if (it != m_typeIcons.constEnd()) {
+        return it.value();
+    }
+    const QIcon icon(QPixmap::fromImage(image));
+    m_typeIcons.insert(key, icon);
+    return icon;
+}
+
+void ThumbnailIconProvider::storeThumbnail(const QString &filePath, const QImage &image, const QString &typeKey) {
+    QMutexLocker locker(&m_cacheMutex);
+    if (!typeKey.isEmpty()) {
+        // 类型图标的像素只保存一份，路径条目只是共享同一个 QIcon 的记录，避免重复提交任务
+        insert(filePath, typeIcon(typeKey, image), 1);
+        return;
+    }
+    // 无法生成缩略图的文件缓存系统图标，避免每次重绘都重新提交任务
+    const QIcon result = image.isNull()
+        ? QFileIconProvider::icon(QFileInfo(filePath))
+        : QIcon(QPixmap::fromImage(image));
+    const qint64 bytes = image.isNull() ? kFallbackIconCost : image.sizeInBytes();
+    insert(filePath, result, bytes);
 }
 
 static bool isImageFile(const QString &filePath) {
@@ -537,53 +308,12 @@ void MainWindow::setupUI() {
     m_shortcuts->addItem("");  // 分隔符
     addShortcut(":/icons/icons/computer.svg", tr("计算机"), QDir::rootPath());
     
-    // 添加磁盘列表
-    struct DiskInfo {
-        QString path;
-        qint64 size;
-        bool isSystem;
-        QString customName; // 保留用户自定义卷名
-    };
-    QList<DiskInfo> disks;
-    for (const QStorageInfo &storage : QStorageInfo::mountedVolumes()) {
-        if (!storage.isValid() || !storage.isReady()) continue;
-        const QString root = storage.rootPath();
-        const qint64 total = storage.bytesTotal();
-        // 过滤掉系统临时挂载、只读小分区等以及 /boot、/persistent、/opt、/root、/var
-        if (root.startsWith("/dev/loop") || root.startsWith("/run") || root.startsWith("/sys") || root.startsWith("/proc") || root.startsWith("/tmp") || root.startsWith("/boot")
-            || root.startsWith("/persistent") || root.startsWith("/opt") || root.startsWith("/root") || root.startsWith("/var") || total < 1024*1024*1024) continue;
-        bool isSystem = (root == "/");
-        // 优先使用用户自定义卷名，若displayName非空且不等于root
-        QString customName = storage.displayName();
-        if (customName.isEmpty() || customName == root || customName == "_dde_data") customName.clear();
-        // /home 也视为数据盘，除非容量很小才视作系统盘
-        if (!isSystem && (total <= 64ULL*1024*1024*1024)) isSystem = true;
-        disks.append({root, total, isSystem, customName});
-    }
-    // 按系统/非系统分类，再按容量排序；数据盘自定义名称优先显示
-    std::sort(disks.begin(), disks.end(), [](const DiskInfo &a, const DiskInfo &b) {
-        if (a.isSystem != b.isSystem) return a.isSystem > b.isSystem;
-        if (!a.customName.isEmpty() && b.customName.isEmpty()) return true;
-        if (a.customName.isEmpty() && !b.customName.isEmpty()) return false;
-        return b.size < a.size;
-    });
-    auto formatGB = [](qint64 bytes) {
-        return QString::number(bytes / (1024.0 * 1024.0 * 1024.0), 'f', 0) + "GB";
-    };
-    int sysIdx = 1, dataIdx = 1;
-    for (const auto &d : disks) {
-        QString name;
-        if (!d.customName.isEmpty()) {
-            name = d.customName + " (" + formatGB(d.size) + ")";
-        } else if (d.isSystem) {
-            name = tr("系统盘%1 (%2)").arg(sysIdx++).arg(formatGB(d.size));
-        } else {
-            name = tr("数据盘%1 (%2)").arg(dataIdx++).arg(formatGB(d.size));
-        }
-        QString diskIcon = d.isSystem ? ":/icons/icons/system-disk.svg" : ":/icons/icons/harddisk.svg";
-        addShortcut(diskIcon, name, d.path);
-        qDebug() << "Adding disk entry:" << name << "=>" << d.path;
-    }
+    // 磁盘列表由后台发现，查到一个卷就加入一个，无响应的网络挂载不会拖住启动；
+    // 之后挂载表有变化（插拔磁盘、挂载网络共享）时自动增删
+    m_volumeMonitor = new VolumeMonitor(this);
+    connect(m_volumeMonitor, &VolumeMonitor::volumeAdded, this, [this]() { refreshVolumeShortcuts(); });
+    connect(m_volumeMonitor, &VolumeMonitor::volumeRemoved, this, [this]() { refreshVolumeShortcuts(); });
+    connect(m_volumeMonitor, &VolumeMonitor::initialScanFinished, this, [this]() { updateIndexRoots(); });
     
     connect(m_shortcuts, &QListWidget::itemClicked, this, [this](QListWidgetItem *item) {
         const QString path = item->data(Qt::UserRole).toString();
@@ -591,27 +321,124 @@ void MainWindow::setupUI() {
             navigateToPath(path);
         }
     });
+    
+    // 文件名索引覆盖快捷栏中的各个目录和磁盘（同一文件系统内的子目录会合并到上层根目录）
+    m_filenameIndex = new FilenameIndexService(this);
+    connect(m_filenameIndex, &FilenameIndexService::indexingProgress, this, [this](qint64 entries) {
+        m_searchBox->setToolTip(tr("正在建立文件名索引：已收录 %1 项").arg(entries));
+    });
+    connect(m_filenameIndex, &FilenameIndexService::indexReady, this, [this](quint32 entries) {
+        m_searchBox->setToolTip(tr("文件名索引：%1 项").arg(entries));
+    });
+    // 等首次发现的磁盘都加入快捷栏后再设置索引根目录，避免启动时因磁盘陆续出现而反复重建
+    m_volumeMonitor->start();
+    
+    // 右键快捷项或磁盘：分析磁盘占用
+    m_shortcuts->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(m_shortcuts, &QListWidget::customContextMenuRequested, this, [this](const QPoint &pos) {
+        QListWidgetItem *item = m_shortcuts->itemAt(pos);
+        if (!item) return;
+        const QString path = item->data(Qt::UserRole).toString();
+        if (path.isEmpty() || !QDir(path).exists()) return;
+        QMenu menu(this);
+        QAction *analyze = menu.addAction(tr("分析磁盘占用"));
+        if (menu.exec(m_shortcuts->viewport()->mapToGlobal(pos)) == analyze) {
+            auto *view = new DiskUsageView(path, this);
+            connect(view, &DiskUsageView::openRequested, this, &MainWindow::navigateToPath);
+            view->show();
+        }
+    });
 
     // 中间：文件列表
-    m_model = new CustomFileSystemModel(this);
-    m_model->setFilter(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::AllDirs | QDir::Files);
+    // 模型后端：默认使用 QFileSystemModel；view/nativeModel 开启时使用自己读取目录的 NativeFileModel，适合百万级条目的目录
+    if (QSettings().value("view/nativeModel", false).toBool()) {
+        auto *model = new NativeFileModel(this);
+        // 大小和修改时间只为显示到的行查询；按这两列排序时在后台查询整个目录，状态栏显示进度
+        model->setLazyAttributes(QSettings().value("view/lazyAttributes", true).toBool());
+        // 名称按区域设置的排序规则比较，默认 zh_CN 使中文名按拼音排列
+        model->setCollationLocale(QLocale(QSettings().value("view/collationLocale", "zh_CN").toString()));
+        connect(model, &NativeFileModel::attributeProgress, this, [this](const QString &path, int done, int total) {
+            if (QDir::cleanPath(path) != QDir::cleanPath(m_currentPath)) return;
+            if (done < total) {
+                statusBar()->showMessage(tr("正在读取文件属性以便排序... %1/%2").arg(done).arg(total));
+            } else {
+                showDirectoryStatus(m_currentPath, m_model->itemModel()->rowCount(m_model->indexForPath(m_currentPath)));
+            }
+        });
+        m_model = model;
+    } else {
+        auto *model = new CustomFileSystemModel(this);
+        model->setFilter(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::AllDirs | QDir::Files);
+        m_model = model;
+    }
     
-    // 创建并设置自定义图标提供器（支持缩略图开关）
-    m_iconProvider = new ThumbnailIconProvider(&m_showThumbnails);
+    // 最近离开的目录的快照，后退/前进时直接显示；目录有变化时恢复正常加载
+    m_snapshots = new DirectorySnapshotCache(this);
+    m_snapshots->setCapacity(QSettings().value("history/snapshotCount", 32).toInt());
+    connect(m_snapshots, &DirectorySnapshotCache::invalidated, this, &MainWindow::reconcileListing);
+    
+    // 详情面板中目录的递归大小统计
+    m_sizeCalculator = new DirectorySizeCalculator(this);
+    connect(m_sizeCalculator, &DirectorySizeCalculator::progress, this, [this](const QString &path, qint64 bytes, qint64) {
+        if (m_detailsSizeLabel && path == m_detailsSizePath) {
+            m_detailsSizeLabel->setText(tr("正在计算... %1").arg(FileSizeFormat::format(bytes)));
+        }
+    });
+    connect(m_sizeCalculator, &DirectorySizeCalculator::finished, this, [this](const QString &path, qint64 bytes, qint64 files, qint64) {
+        if (m_detailsSizeLabel && path == m_detailsSizePath) {
+            m_detailsSizeLabel->setText(tr("%1（%2 个文件）").arg(FileSizeFormat::format(bytes)).arg(files));
+        }
+    });
+    
+    // 创建并设置自定义图标提供器（支持缩略图开关），缩略图在后台线程池中生成
+    m_thumbnailLoader = new ThumbnailLoader(this);
+    m_iconProvider = new ThumbnailIconProvider(&m_showThumbnails, m_thumbnailLoader);
     m_model->setIconProvider(m_iconProvider);
+    m_model->setThumbnailProvider(m_iconProvider);
+    // 缩略图按屏幕像素比绘制，高分屏下不模糊
+    m_thumbnailLoader->setDevicePixelRatio(devicePixelRatioF());
+    m_iconProvider->setDevicePixelRatio(devicePixelRatioF());
+    // 缩略图内存预算（MB），可在配置文件中按机器调整
+    QSettings settings;
+    const qint64 budgetMB = settings.value("thumbnails/memoryBudgetMB", 64).toLongLong();
+    m_iconProvider->setMemoryBudget(budgetMB * 1024 * 1024);
+    // 超过大小上限或加载超时的 PDF 只显示占位图
+    const qint64 pdfMaxMB = settings.value("thumbnails/pdfMaxMB", 100).toLongLong();
+    m_thumbnailLoader->setPdfLimits(pdfMaxMB * 1024 * 1024, settings.value("thumbnails/pdfTimeoutMs", 3000).toInt());
+    connect(m_thumbnailLoader, &ThumbnailLoader::thumbnailReady, this, [this](const QString &path, const QImage &image, const QString &typeKey) {
+        m_iconProvider->storeThumbnail(path, image, typeKey);
+        m_model->thumbnailUpdated(path);
+    });
     
     const QString rootPath = QDir::currentPath();
     m_model->setRootPath(rootPath);
+    
+    // 视图通过筛选代理显示模型，目录内筛选在后台分批匹配
+    m_filterProxy = new StreamingFilterProxyModel(this);
+    m_filterProxy->setSourceModel(m_model->itemModel());
+    m_filterProxy->setFilterRoot(m_model->indexForPath(rootPath));
+    const QModelIndex rootIndex = m_filterProxy->mapFromSource(m_model->indexForPath(rootPath));
+
+    // 文件视图上方的筛选框
+    QWidget *fileArea = new QWidget(mainSplitter);
+    QVBoxLayout *fileAreaLayout = new QVBoxLayout(fileArea);
+    fileAreaLayout->setContentsMargins(0, 0, 0, 0);
+    fileAreaLayout->setSpacing(2);
+    m_filterBox = new QLineEdit(fileArea);
+    m_filterBox->setPlaceholderText(tr("筛选当前目录"));
+    m_filterBox->setClearButtonEnabled(true);
+    fileAreaLayout->addWidget(m_filterBox);
 
     // 创建文件视图堆叠窗口
-    m_fileViewStack = new QStackedWidget(mainSplitter);
+    m_fileViewStack = new QStackedWidget(fileArea);
+    fileAreaLayout->addWidget(m_fileViewStack, 1);
     m_fileViewStack->setMinimumWidth(400);  // 设置最小宽度，防止过度收缩
     m_fileViewStack->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     
     // 表格视图
     m_tableView = new QTableView();
-    m_tableView->setModel(m_model);
-    m_tableView->setRootIndex(m_model->index(rootPath));
+    m_tableView->setModel(m_filterProxy);
+    m_tableView->setRootIndex(rootIndex);
     m_tableView->setSortingEnabled(true);
     m_tableView->sortByColumn(0, Qt::AscendingOrder);
     m_tableView->setAlternatingRowColors(true);
@@ -627,8 +454,8 @@ void MainWindow::setupUI() {
     
     // 列表视图
     m_listView = new QListView();
-    m_listView->setModel(m_model);
-    m_listView->setRootIndex(m_model->index(rootPath));
+    m_listView->setModel(m_filterProxy);
+    m_listView->setRootIndex(rootIndex);
     m_listView->setSelectionMode(QAbstractItemView::SingleSelection);
     m_listView->setIconSize(QSize(32, 32));
     m_listView->setViewMode(QListView::IconMode);
@@ -639,8 +466,8 @@ void MainWindow::setupUI() {
     
     // 树形视图
     m_treeView = new QTreeView();
-    m_treeView->setModel(m_model);
-    m_treeView->setRootIndex(m_model->index(rootPath));
+    m_treeView->setModel(m_filterProxy);
+    m_treeView->setRootIndex(rootIndex);
     m_treeView->setSortingEnabled(true);
     m_treeView->sortByColumn(0, Qt::AscendingOrder);
     m_treeView->setSelectionMode(QAbstractItemView::SingleSelection);
@@ -660,6 +487,41 @@ void MainWindow::setupUI() {
     // 默认显示表格视图
     m_fileViewStack->setCurrentWidget(m_tableView);
     
+    // 缩略图按视口调度：滚动停止或目录内容变化后，按可见行 + 预取区重排队列，丢弃已滚过的任务
+    m_thumbnailPrefetch = settings.value("thumbnails/prefetchRows", 50).toInt();
+    m_thumbnailScrollTimer = new QTimer(this);
+    m_thumbnailScrollTimer->setSingleShot(true);
+    m_thumbnailScrollTimer->setInterval(100);
+    connect(m_thumbnailScrollTimer, &QTimer::timeout, this, &MainWindow::scheduleVisibleThumbnails);
+    for (QAbstractItemView *view : {static_cast<QAbstractItemView*>(m_tableView),
+                                    static_cast<QAbstractItemView*>(m_listView),
+                                    static_cast<QAbstractItemView*>(m_treeView)}) {
+        connect(view->verticalScrollBar(), &QScrollBar::valueChanged,
+                m_thumbnailScrollTimer, qOverload<>(&QTimer::start));
+    }
+    // 模型加载完当前目录后直接使用其行数，取消仍在进行的后台统计
+    m_model->onDirectoryLoaded(this, [this](const QString &path) {
+        m_thumbnailScrollTimer->start();
+        if (QDir::cleanPath(path) != QDir::cleanPath(m_currentPath)) return;
+        m_currentListed = true;
+        if (m_statusCountCancel) m_statusCountCancel->store(true);
+        showDirectoryStatus(m_currentPath, m_model->itemModel()->rowCount(m_model->indexForPath(m_currentPath)));
+    });
+    connect(m_model->itemModel(), &QAbstractItemModel::layoutChanged, m_thumbnailScrollTimer, qOverload<>(&QTimer::start));
+    
+    // 目录内筛选：每次输入立即开始新一轮匹配，结果分批出现
+    connect(m_filterBox, &QLineEdit::textChanged, this, [this](const QString &text) {
+        m_filterProxy->setFilterText(text);
+        if (text.isEmpty()) updateDirectoryStatus();
+    });
+    connect(m_filterProxy, &StreamingFilterProxyModel::filterUpdated, this, [this](bool finished) {
+        m_thumbnailScrollTimer->start();
+        if (!m_filterProxy->isFiltering()) return;
+        const int matched = m_filterProxy->rowCount(m_filterProxy->mapFromSource(m_filterProxy->filterRoot()));
+        statusBar()->showMessage(finished ? tr("筛选出 %1 项").arg(matched)
+                                          : tr("正在筛选... 已找到 %1 项").arg(matched));
+    });
+    
     // 启用右键菜单
     m_tableView->setContextMenuPolicy(Qt::CustomContextMenu);
     m_listView->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -676,7 +538,7 @@ void MainWindow::setupUI() {
     // 双击事件处理
     connect(m_tableView, &QTableView::doubleClicked, this, [this](const QModelIndex &index) {
         if (!index.isValid()) return;
-        const QFileInfo info = m_model->fileInfo(index);
+        const QFileInfo info = m_model->fileInfo(m_filterProxy->mapToSource(index));
         if (info.isDir()) {
             navigateToPath(info.absoluteFilePath());
         }
@@ -684,7 +546,7 @@ void MainWindow::setupUI() {
     
     connect(m_listView, &QListView::doubleClicked, this, [this](const QModelIndex &index) {
         if (!index.isValid()) return;
-        const QFileInfo info = m_model->fileInfo(index);
+        const QFileInfo info = m_model->fileInfo(m_filterProxy->mapToSource(index));
         if (info.isDir()) {
             navigateToPath(info.absoluteFilePath());
         }
@@ -692,7 +554,7 @@ void MainWindow::setupUI() {
     
     connect(m_treeView, &QTreeView::doubleClicked, this, [this](const QModelIndex &index) {
         if (!index.isValid()) return;
-        const QFileInfo info = m_model->fileInfo(index);
+        const QFileInfo info = m_model->fileInfo(m_filterProxy->mapToSource(index));
         if (info.isDir()) {
             navigateToPath(info.absoluteFilePath());
         }
@@ -717,6 +579,41 @@ void MainWindow::setupUI() {
 
 #ifdef HAVE_QT_PDF_CORE
     m_pdfCoreViewer = new PdfSimpleViewer(m_stack);
+#endif
+    // 办公文档在后台转换为 PDF，转换完成时若仍选中该文件则显示 PDF 预览。
+    // 转换工具在启动时于后台查找，第一次转换不必等待
+    OfficeToolRegistry::startDetection();
+    m_officeConversions = new OfficeConversionService(this);
+#ifdef HAVE_QT_PDF_CORE
+    connect(m_officeConversions, &OfficeConversionService::finished, this,
+            [this](quint64, const QString &inputPath, bool ok, const QString &pdfPath, const QString &errorMsg) {
+        if (inputPath != m_officePreviewPath) return;
+        m_officePreviewPath.clear();
+        if (ok) {
+            showPdf(pdfPath);
+            statusBar()->showMessage(tr("预览办公文档: %1").arg(inputPath));
+        } else {
+            statusBar()->showMessage(tr("无法转换为 PDF 预览: %1").arg(errorMsg.section('\n', 0, 0)));
+        }
+    });
+    // 预热当前目录：后台转换全部办公文档并生成首页缩略图
+    m_officePrewarmer = new OfficePrewarmer(m_officeConversions, this);
+    m_officePrewarmer->setDevicePixelRatio(devicePixelRatioF());
+    connect(m_officePrewarmer, &OfficePrewarmer::thumbnailReady, this, [this](const QString &path, const QImage &image) {
+        m_iconProvider->storeThumbnail(path, image, QString());
+        m_model->thumbnailUpdated(path);
+    });
+    connect(m_officePrewarmer, &OfficePrewarmer::progress, this, [this](int done, int total, int failed) {
+        if (total == 0) {
+            statusBar()->showMessage(tr("当前目录中没有办公文档"), 3000);
+        } else if (done < total) {
+            statusBar()->showMessage(tr("正在预热办公文档预览... %1/%2").arg(done).arg(total));
+        } else if (failed > 0) {
+            statusBar()->showMessage(tr("办公文档预览预热完成：%1 个，其中 %2 个无法转换").arg(total).arg(failed), 5000);
+        } else {
+            statusBar()->showMessage(tr("办公文档预览预热完成：%1 个").arg(total), 5000);
+        }
+    });
 #endif
 #ifdef HAVE_QT_WEBENGINE
     m_officeWebViewer = new OfficeWebViewer(m_stack);
@@ -743,6 +640,20 @@ void MainWindow::setupUI() {
     m_stack->addWidget(m_textViewer);
     m_stack->addWidget(m_mediaViewer);
     m_stack->addWidget(m_detailsPanel);
+    
+    // 文件名搜索结果，双击打开所在目录
+    m_searchResults = new QListWidget(m_stack);
+    connect(m_searchResults, &QListWidget::itemDoubleClicked, this, [this](QListWidgetItem *item) {
+        revealPath(item->data(Qt::UserRole).toString(), item->data(Qt::UserRole + 1).toBool());
+    });
+    m_stack->addWidget(m_searchResults);
+    
+    // 文件内容搜索结果，双击打开文件所在目录
+    m_contentSearch = new ContentSearchView(m_stack);
+    connect(m_contentSearch, &ContentSearchView::locateRequested, this, [this](const QString &path) {
+        revealPath(path, false);
+    });
+    m_stack->addWidget(m_contentSearch);
 
 #ifdef HAVE_QT_PDF_CORE
     m_stack->addWidget(m_pdfCoreViewer);
@@ -752,7 +663,7 @@ void MainWindow::setupUI() {
 #endif
 
     mainSplitter->addWidget(m_shortcuts);
-    mainSplitter->addWidget(m_fileViewStack);
+    mainSplitter->addWidget(fileArea);
     mainSplitter->addWidget(rightPanel);
     
     // 设置各部分的拉伸因子
@@ -773,6 +684,74 @@ void MainWindow::setupUI() {
     navigateToPath(rootPath);
 }
 
+void MainWindow::refreshVolumeShortcuts() {
+    // 磁盘项排在快捷栏末尾，按 kVolumeItemRole 标记；每次按当前的卷重新生成，编号和顺序保持一致
+    for (int i = m_shortcuts->count() - 1; i >= 0; --i) {
+        if (m_shortcuts->item(i)->data(kVolumeItemRole).toBool()) delete m_shortcuts->takeItem(i);
+    }
+
+    struct DiskInfo {
+        QString path;
+        qint64 size;
+        bool isSystem;
+        QString customName; // 保留用户自定义卷名
+    };
+    QList<DiskInfo> disks;
+    for (const VolumeInfo &volume : m_volumeMonitor->volumes()) {
+        const QString root = volume.rootPath;
+        const qint64 total = volume.bytesTotal;
+        // 过滤掉系统临时挂载、只读小分区等以及 /boot、/persistent、/opt、/root、/var
+        if (root.startsWith("/dev/loop") || root.startsWith("/run") || root.startsWith("/sys") || root.startsWith("/proc") || root.startsWith("/tmp") || root.startsWith("/boot")
+            || root.startsWith("/persistent") || root.startsWith("/opt") || root.startsWith("/root") || root.startsWith("/var") || total < 1024*1024*1024) continue;
+        bool isSystem = (root == "/");
+        // 优先使用用户自定义卷名，若displayName非空且不等于root
+        QString customName = volume.displayName;
+        if (customName.isEmpty() || customName == root || customName == "_dde_data") customName.clear();
+        // /home 也视为数据盘，除非容量很小才视作系统盘
+        if (!isSystem && (total <= 64ULL*1024*1024*1024)) isSystem = true;
+        disks.append({root, total, isSystem, customName});
+    }
+    // 按系统/非系统分类，再按容量排序；数据盘自定义名称优先显示
+    std::sort(disks.begin(), disks.end(), [](const DiskInfo &a, const DiskInfo &b) {
+        if (a.isSystem != b.isSystem) return a.isSystem > b.isSystem;
+        if (!a.customName.isEmpty() && b.customName.isEmpty()) return true;
+        if (a.customName.isEmpty() && !b.customName.isEmpty()) return false;
+        if (a.size != b.size) return b.size < a.size;
+        return a.path < b.path;
+    });
+    auto formatGB = [](qint64 bytes) {
+        return QString::number(bytes / (1024.0 * 1024.0 * 1024.0), 'f', 0) + "GB";
+    };
+    int sysIdx = 1, dataIdx = 1;
+    for (const auto &d : disks) {
+        QString name;
+        if (!d.customName.isEmpty()) {
+            name = d.customName + " (" + formatGB(d.size) + ")";
+        } else if (d.isSystem) {
+            name = tr("系统盘%1 (%2)").arg(sysIdx++).arg(formatGB(d.size));
+        } else {
+            name = tr("数据盘%1 (%2)").arg(dataIdx++).arg(formatGB(d.size));
+        }
+        QString diskIcon = d.isSystem ? ":/icons/icons/system-disk.svg" : ":/icons/icons/harddisk.svg";
+        auto *item = new QListWidgetItem(QIcon(diskIcon), name);
+        item->setData(Qt::UserRole, d.path);
+        item->setData(kVolumeItemRole, true);
+        m_shortcuts->addItem(item);
+    }
+
+    // 首次发现结束后出现或消失的磁盘同步到文件名索引
+    if (m_volumeMonitor->isInitialScanDone()) updateIndexRoots();
+}
+
+void MainWindow::updateIndexRoots() {
+    QStringList indexRoots;
+    for (int i = 0; i < m_shortcuts->count(); ++i) {
+        const QString path = m_shortcuts->item(i)->data(Qt::UserRole).toString();
+        if (!path.isEmpty()) indexRoots.append(path);
+    }
+    m_filenameIndex->setRoots(indexRoots);
+}
+
 void MainWindow::setupToolbar() {
     // 创建面包屑导航区域
     m_breadcrumbArea = new QScrollArea(this);
@@ -847,6 +826,39 @@ void MainWindow::setupToolbar() {
     
     toolbarLayout->addWidget(m_addressStack, 1);
     
+    // 文件名搜索框（基于后台建立的文件名索引，输入停顿后自动查询）
+    m_searchBox = new QLineEdit(toolbarWidget);
+    m_searchBox->setPlaceholderText(tr("搜索文件名（支持 * ?）"));
+    m_searchBox->setClearButtonEnabled(true);
+    m_searchBox->setFixedWidth(220);
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(200);
+    connect(m_searchBox, &QLineEdit::textChanged, this, [this]() {
+        if (!m_btnContentSearch->isChecked()) m_searchTimer->start();
+    });
+    connect(m_searchBox, &QLineEdit::returnPressed, this, [this]() {
+        if (m_btnContentSearch->isChecked()) {
+            runContentSearch();
+        } else {
+            runFilenameSearch();
+        }
+    });
+    connect(m_searchTimer, &QTimer::timeout, this, &MainWindow::runFilenameSearch);
+    toolbarLayout->addWidget(m_searchBox);
+    
+    // 切换为文件内容搜索：在当前目录下搜索，输入完按回车开始
+    m_btnContentSearch = new QToolButton(toolbarWidget);
+    m_btnContentSearch->setText("文");
+    m_btnContentSearch->setCheckable(true);
+    m_btnContentSearch->setToolTip(tr("搜索文件内容"));
+    connect(m_btnContentSearch, &QToolButton::toggled, this, [this](bool checked) {
+        m_searchTimer->stop();
+        m_searchBox->setPlaceholderText(checked ? tr("在当前目录中搜索文件内容（回车开始）")
+                                                : tr("搜索文件名（支持 * ?）"));
+    });
+    toolbarLayout->addWidget(m_btnContentSearch);
+    
     m_breadcrumbArea->setWidget(toolbarWidget);
     
     updateNavigationButtons();
@@ -860,6 +872,8 @@ void MainWindow::navigateToPath(const QString &path) {
         m_mediaViewer->stop();
     }
     
+    leaveCurrentDirectory();
+    
     // 更新历史记录
     if (m_historyIndex >= 0 && m_historyIndex < m_history.size() - 1) {
         m_history = m_history.mid(0, m_historyIndex + 1);
@@ -870,17 +884,18 @@ void MainWindow::navigateToPath(const QString &path) {
     }
     
     m_currentPath = path;
+    m_sizeCalculator->cancel();
     
     // 先禁用排序，然后更新模型根路径，最后重新启用排序
     m_tableView->setSortingEnabled(false);
     m_treeView->setSortingEnabled(false);
     
+    // 旧目录的缩略图任务不再需要
+    m_thumbnailLoader->cancelAll();
+    
     // 关键修复：更新模型的根路径
     m_model->setRootPath(path);
-    QModelIndex currentIndex = m_model->index(path);
-    m_tableView->setRootIndex(currentIndex);
-    m_listView->setRootIndex(currentIndex);
-    m_treeView->setRootIndex(currentIndex);
+    setViewRoot(m_model->indexForPath(path));
     
     // 重新应用排序设置以确保排序功能正常工作
     applySortingSettings();
@@ -888,61 +903,89 @@ void MainWindow::navigateToPath(const QString &path) {
     updateNavigationButtons();
     updateBreadcrumb();
     
-    // 更新状态栏
-    int fileCount = countFilesInDirectory(path);
-    statusBar()->showMessage(tr("当前目录: %1  |  %2 项").arg(path).arg(fileCount));
+    // 更新状态栏（项数在后台统计）
+    updateDirectoryStatus();
 }
 
 void MainWindow::goBack() {
     if (m_historyIndex > 0) {
+        leaveCurrentDirectory();
         m_historyIndex--;
-        m_currentPath = m_history[m_historyIndex];
-        
-        // 先禁用排序
-        m_tableView->setSortingEnabled(false);
-        m_treeView->setSortingEnabled(false);
-        
-        // 关键修复：更新模型的根路径
-        m_model->setRootPath(m_currentPath);
-        QModelIndex currentIndex = m_model->index(m_currentPath);
-        m_tableView->setRootIndex(currentIndex);
-        m_listView->setRootIndex(currentIndex);
-        m_treeView->setRootIndex(currentIndex);
-        
-        // 重新应用排序设置
-        applySortingSettings();
-        
-        updateNavigationButtons();
-        updateBreadcrumb();
-        int fileCount = countFilesInDirectory(m_currentPath);
-        statusBar()->showMessage(tr("当前目录: %1  |  %2 项").arg(m_currentPath).arg(fileCount));
+        openHistoryEntry();
     }
 }
 
 void MainWindow::goForward() {
     if (m_historyIndex < m_history.size() - 1) {
+        leaveCurrentDirectory();
         m_historyIndex++;
-        m_currentPath = m_history[m_historyIndex];
-        
-        // 先禁用排序
-        m_tableView->setSortingEnabled(false);
-        m_treeView->setSortingEnabled(false);
-        
-        // 关键修复：更新模型的根路径
-        m_model->setRootPath(m_currentPath);
-        QModelIndex currentIndex = m_model->index(m_currentPath);
-        m_tableView->setRootIndex(currentIndex);
-        m_listView->setRootIndex(currentIndex);
-        m_treeView->setRootIndex(currentIndex);
-        
-        // 重新应用排序设置
+        openHistoryEntry();
+    }
+}
+
+// 后退/前进：目录快照有效时，模型中保留的节点就是最新内容，直接显示而不重新列目录，并恢复离开时的排序
+void MainWindow::openHistoryEntry() {
+    m_currentPath = m_history[m_historyIndex];
+    DirectorySnapshotCache::Snapshot snapshot;
+    const bool cached = m_snapshots->lookup(m_currentPath, &snapshot);
+    if (cached) {
+        m_model->setTrustedListing(m_currentPath);
+        m_currentListed = true;
+    }
+    
+    // 先禁用排序
+    m_tableView->setSortingEnabled(false);
+    m_treeView->setSortingEnabled(false);
+    
+    // 旧目录的缩略图任务不再需要
+    m_thumbnailLoader->cancelAll();
+    
+    // 关键修复：更新模型的根路径
+    m_model->setRootPath(m_currentPath);
+    setViewRoot(m_model->indexForPath(m_currentPath));
+    
+    // 重新应用排序设置
+    if (cached) {
+        applySortingSettings(snapshot.sortColumn, snapshot.sortOrder);
+    } else {
         applySortingSettings();
-        
-        updateNavigationButtons();
-        updateBreadcrumb();
-        int fileCount = countFilesInDirectory(m_currentPath);
-        statusBar()->showMessage(tr("当前目录: %1  |  %2 项").arg(m_currentPath).arg(fileCount));
     }
+    
+    updateNavigationButtons();
+    updateBreadcrumb();
+    if (!cached) {
+        updateDirectoryStatus();
+        return;
+    }
+    showDirectoryStatus(m_currentPath, snapshot.entries);
+    m_thumbnailScrollTimer->start();
+    // 网络文件系统上看不到其它机器的修改：先按快照显示，稍后在后台重新列目录核对
+    if (!snapshot.verified) {
+        const QString path = m_currentPath;
+        QTimer::singleShot(kSnapshotReconcileDelayMs, this, [this, path]() { reconcileListing(path); });
+    }
+}
+
+// 离开目录时记录快照，之后通过后退/前进回到这里可以直接显示
+void MainWindow::leaveCurrentDirectory() {
+    if (!m_currentPath.isEmpty() && m_currentListed) {
+        QHeaderView *header = m_fileViewStack->currentWidget() == m_treeView
+                                  ? m_treeView->header() : m_tableView->horizontalHeader();
+        DirectorySnapshotCache::Snapshot snapshot;
+        snapshot.entries = m_model->itemModel()->rowCount(m_model->indexForPath(m_currentPath));
+        snapshot.sortColumn = header->sortIndicatorSection();
+        snapshot.sortOrder = header->sortIndicatorOrder();
+        m_snapshots->store(m_currentPath, snapshot);
+    }
+    m_currentListed = false;
+    m_model->setTrustedListing(QString());
+}
+
+// 快照失效或需要核对：恢复正常加载，若正在显示该目录则立即让模型重新列出
+void MainWindow::reconcileListing(const QString &path) {
+    if (path != m_currentPath) return;
+    m_model->setTrustedListing(QString());
+    m_model->itemModel()->fetchMore(m_model->indexForPath(path));
 }
 
 void MainWindow::goUp() {
@@ -1102,7 +1145,11 @@ void MainWindow::updateBreadcrumb() {
 
 void MainWindow::onItemClicked(const QModelIndex &index) {
     if (!index.isValid()) return;
-    const QFileInfo info = m_model->fileInfo(index);
+    // 之前选中目录的大小统计不再需要
+    m_sizeCalculator->cancel();
+    // 之前选中的办公文档转换完成后不再切换预览
+    m_officePreviewPath.clear();
+    const QFileInfo info = m_model->fileInfo(m_filterProxy->mapToSource(index));
     const QString path = info.absoluteFilePath();
     
     if (info.isDir()) {
@@ -1135,6 +1182,11 @@ void MainWindow::onItemClicked(const QModelIndex &index) {
         QFileInfo fileInfo(path);
         QString fileType = fileInfo.suffix().toUpper();
         statusBar()->showMessage(tr("办公文档 (%1): %2").arg(fileType, path));
+#ifdef HAVE_QT_PDF_CORE
+        // 排在其它转换之前；已有缓存时很快就会切换到 PDF 预览
+        m_officePreviewPath = path;
+        m_officeConversions->convert(path, OfficeConversionService::Priority::Interactive);
+#endif
         return;
     }
     if (isTextLikeFile(path)) {
@@ -1214,16 +1266,137 @@ void MainWindow::onShortcutClicked(const QString &path) {
     }
 }
 
-QString MainWindow::formatFileSize(qint64 size) {
-    if (size < 1024) return QString::number(size) + " B";
-    if (size < 1024 * 1024) return QString::number(size / 1024.0, 'f', 2) + " KB";
-    if (size < 1024 * 1024 * 1024) return QString::number(size / (1024.0 * 1024.0), 'f', 2) + " MB";
-    return QString::number(size / (1024.0 * 1024.0 * 1024.0), 'f', 2) + " GB";
+int MainWindow::countFilesInDirectory(const QString &path, const std::atomic_bool &cancelled) {
+    // 逐项遍历而不是构造完整的文件名列表，取消时尽快退出
+    QDirIterator it(path, QDir::AllEntries | QDir::NoDotAndDotDot);
+    int count = 0;
+    while (it.hasNext()) {
+        if (cancelled.load(std::memory_order_relaxed)) return -1;
+        it.next();
+        ++count;
+    }
+    return count;
+}
+
+void MainWindow::countItemsAsync(const QString &path, std::shared_ptr<std::atomic_bool> &cancelFlag,
+                                 const std::function<void(int)> &done) {
+    // 同一用途的上一次统计不再需要
+    if (cancelFlag) cancelFlag->store(true);
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    cancelFlag = cancelled;
+
+    auto *watcher = new QFutureWatcher<int>(this);
+    connect(watcher, &QFutureWatcher<int>::finished, this, [watcher, cancelled, done]() {
+        watcher->deleteLater();
+        if (!cancelled->load()) done(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([path, cancelled]() {
+        return countFilesInDirectory(path, *cancelled);
+    }));
+}
+
+void MainWindow::updateDirectoryStatus() {
+    const QString path = m_currentPath;
+    statusBar()->showMessage(tr("当前目录: %1  |  正在统计...").arg(path));
+    countItemsAsync(path, m_statusCountCancel, [this, path](int count) {
+        showDirectoryStatus(path, count);
+    });
+}
+
+void MainWindow::showDirectoryStatus(const QString &path, int count) {
+    statusBar()->showMessage(tr("当前目录: %1  |  %2 项").arg(path).arg(count));
+}
+
+void MainWindow::setViewRoot(const QModelIndex &sourceIndex) {
+    if (sourceIndex != m_filterProxy->filterRoot()) {
+        // 调用方随后会更新状态栏，这里不经过筛选框的信号
+        const QSignalBlocker blocker(m_filterBox);
+        m_filterBox->clear();
+        m_filterProxy->setFilterText(QString());
+    }
+    m_filterProxy->setFilterRoot(sourceIndex);
+    const QModelIndex viewIndex = m_filterProxy->mapFromSource(sourceIndex);
+    m_tableView->setRootIndex(viewIndex);
+    m_listView->setRootIndex(viewIndex);
+    m_treeView->setRootIndex(viewIndex);
+}
+
+// 缩略图调度顺序：先是当前视图中可见的行（自上而下），再交替加入下方和上方预取区的行
+// 视图中的行来自筛选代理，路径通过映射回源模型取得
+QStringList MainWindow::thumbnailSchedule() const {
+    QStringList paths;
+    const auto filePath = [this](const QModelIndex &index) {
+        return m_model->filePath(m_filterProxy->mapToSource(index));
+    };
+    auto *view = qobject_cast<QAbstractItemView*>(m_fileViewStack->currentWidget());
+    if (!view) return paths;
+    
+    const QRect area = view->viewport()->rect();
+    if (auto *tree = qobject_cast<QTreeView*>(view)) {
+        // 树形视图可能展开了子目录，从顶部可见行逐行向下
+        const QModelIndex top = tree->indexAt(QPoint(area.left() + 1, area.top() + 1)).siblingAtColumn(0);
+        QModelIndex below = top;
+        for (; below.isValid(); below = tree->indexBelow(below)) {
+            if (tree->visualRect(below).top() > area.bottom()) break;
+            paths.append(filePath(below));
+        }
+        QModelIndex above = top.isValid() ? tree->indexAbove(top) : QModelIndex();
+        for (int i = 0; i < m_thumbnailPrefetch && (below.isValid() || above.isValid()); ++i) {
+            if (below.isValid()) {
+                paths.append(filePath(below));
+                below = tree->indexBelow(below);
+            }
+            if (above.isValid()) {
+                paths.append(filePath(above));
+                above = tree->indexAbove(above);
+            }
+        }
+        return paths;
+    }
+    
+    // 列表/表格视图中行号与显示顺序一致，二分查找第一个可见行
+    const QModelIndex root = view->rootIndex();
+    const int count = m_filterProxy->rowCount(root);
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (view->visualRect(m_filterProxy->index(mid, 0, root)).bottom() < area.top()) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    int last = lo;
+    for (; last < count; ++last) {
+        const QModelIndex idx = m_filterProxy->index(last, 0, root);
+        const QRect rect = view->visualRect(idx);
+        if (rect.top() > area.bottom()) break;
+        if (rect.intersects(area)) {
+            paths.append(filePath(idx));
+        }
+    }
+    for (int i = 0; i < m_thumbnailPrefetch; ++i) {
+        const int below = last + i;
+        const int above = lo - 1 - i;
+        if (below >= count && above < 0) break;
+        if (below < count) paths.append(filePath(m_filterProxy->index(below, 0, root)));
+        if (above >= 0) paths.append(filePath(m_filterProxy->index(above, 0, root)));
+    }
+    return paths;
+}
+
+void MainWindow::showThumbnailCacheStats() {
+    const ThumbnailIconProvider::CacheStats stats = m_iconProvider->cacheStats();
+    const QString message = tr("缩略图缓存: %1 项, 占用 %2 / %3, 命中 %4, 未命中 %5, 淘汰 %6")
+        .arg(stats.entries)
+        .arg(FileSizeFormat::format(stats.residentBytes), FileSizeFormat::format(stats.budgetBytes))
+        .arg(stats.hits).arg(stats.misses).arg(stats.evictions);
+    statusBar()->showMessage(message, 10000);
 }
 
-int MainWindow::countFilesInDirectory(const QString &path) {
-    QDir dir(path);
-    return dir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot).count();
+void MainWindow::scheduleVisibleThumbnails() {
+    if (!m_showThumbnails) return;
+    m_iconProvider->scheduleThumbnails(thumbnailSchedule());
 }
 
 void MainWindow::showFileDetails(const QString &path) {
@@ -1254,7 +1427,7 @@ void MainWindow::showFileDetails(const QString &path) {
     
     if (info.isDir()) {
         // 文件夹图标 - 使用系统图标
-        QIcon folderIcon = m_model->fileIcon(m_model->index(path));
+        QIcon folderIcon = m_model->fileIcon(m_model->indexForPath(path));
         if (!folderIcon.isNull()) {
             m_detailIcon->setPixmap(folderIcon.pixmap(120, 120));
         } else {
@@ -1268,8 +1441,8 @@ void MainWindow::showFileDetails(const QString &path) {
             m_detailIcon->setStyleSheet("QLabel { background-color: #E3F2FD; border-radius: 8px; padding: 20px; }");
         }
     } else if (isImageFile(path)) {
-        // 图片文件：优先显示缩略图
-        QPixmap pixmap(path);
+        // 图片文件：优先显示缩略图（按目标尺寸解码，不加载原图）
+        const QPixmap pixmap = QPixmap::fromImage(ThumbnailRenderer::decodeScaled(path, QSize(150, 150)));
         if (!pixmap.isNull()) {
             m_detailIcon->setPixmap(pixmap.scaled(150, 150, Qt::KeepAspectRatio, Qt::SmoothTransformation));
             if (isDarkTheme) {
@@ -1279,7 +1452,7 @@ void MainWindow::showFileDetails(const QString &path) {
             }
         } else {
             // 图片加载失败，使用系统图标
-            QIcon fileIcon = m_model->fileIcon(m_model->index(path));
+            QIcon fileIcon = m_model->fileIcon(m_model->indexForPath(path));
             m_detailIcon->setPixmap(fileIcon.pixmap(120, 120));
             if (isDarkTheme) {
                 m_detailIcon->setStyleSheet("QLabel { background-color: rgba(255, 255, 255, 0.05); border-radius: 8px; padding: 20px; }");
@@ -1289,7 +1462,7 @@ void MainWindow::showFileDetails(const QString &path) {
         }
     } else {
         // 其他文件类型：使用系统提供的文件图标
-        QIcon fileIcon = m_model->fileIcon(m_model->index(path));
+        QIcon fileIcon = m_model->fileIcon(m_model->indexForPath(path));
         
         if (!fileIcon.isNull()) {
             // 使用系统图标
@@ -1374,7 +1547,7 @@ void MainWindow::showFileDetails(const QString &path) {
     layout->addWidget(separator);
     
     // 文件信息 - 根据主题调整颜色
-    auto addInfo = [layout, this, isDarkTheme](const QString &label, const QString &value, const QString &lightColor = "#555") {
+    auto addInfo = [layout, this, isDarkTheme](const QString &label, const QString &value, const QString &lightColor = "#555") -> QLabel* {
         auto *container = new QWidget(m_detailsPanel);
         auto *hbox = new QHBoxLayout(container);
         hbox->setContentsMargins(10, 8, 10, 8);
@@ -1404,6 +1577,7 @@ void MainWindow::showFileDetails(const QString &path) {
         rowCount++;
         
         layout->addWidget(container);
+        return valueWidget;
     };
     
     // 文件名（加粗显示）
@@ -1422,10 +1596,17 @@ void MainWindow::showFileDetails(const QString &path) {
     
     // 大小
     if (info.isDir()) {
-        int itemCount = countFilesInDirectory(path);
-        addInfo(tr("大小"), QString::number(itemCount) + " " + tr("项"), "#16A085");
+        // 大目录或网络目录统计较慢，先显示占位文字，统计完成后再更新
+        QPointer<QLabel> itemsLabel = addInfo(tr("项目"), tr("正在统计..."), "#16A085");
+        countItemsAsync(path, m_detailsCountCancel, [this, itemsLabel](int itemCount) {
+            if (itemsLabel) itemsLabel->setText(QString::number(itemCount) + " " + tr("项"));
+        });
+        // 递归占用空间在后台计算，过程中显示已统计的部分
+        m_detailsSizeLabel = addInfo(tr("大小"), tr("正在计算..."), "#16A085");
+        m_detailsSizePath = path;
+        m_sizeCalculator->start(path);
     } else {
-        addInfo(tr("大小"), formatFileSize(info.size()), "#16A085");
+        addInfo(tr("大小"), FileSizeFormat::format(info.size()), "#16A085");
     }
     
     // 修改时间（更重要，放在前面）
@@ -1576,6 +1757,26 @@ void MainWindow::showContextMenu(const QPoint &pos) {
         m_tableView->verticalHeader()->setDefaultSectionSize(50);
     });
     
+#ifdef HAVE_QT_PDF_CORE
+    // 在后台把当前目录的办公文档转为 PDF，之后点击时直接显示预览
+    if (m_officePrewarmer->isActive()) {
+        QAction *stopWarmAction = contextMenu.addAction(tr("停止预热办公文档"));
+        connect(stopWarmAction, &QAction::triggered, this, [this]() {
+            m_officePrewarmer->cancel();
+            statusBar()->showMessage(tr("已停止预热办公文档预览"), 2000);
+        });
+    }
+    QAction *warmAction = contextMenu.addAction(tr("预热办公文档预览"));
+    connect(warmAction, &QAction::triggered, this, [this]() {
+        statusBar()->showMessage(tr("正在查找办公文档: %1").arg(m_currentPath));
+        m_officePrewarmer->warmDirectory(m_currentPath);
+    });
+#endif
+
+    // 缩略图缓存统计，用于按机器调整内存预算
+    QAction *cacheStatsAction = contextMenu.addAction(tr("缓存统计"));
+    connect(cacheStatsAction, &QAction::triggered, this, &MainWindow::showThumbnailCacheStats);
+    
     // 关于 - 通过空格实现两端对齐，与四字菜单项保持一致
     QAction *aboutAction = contextMenu.addAction(tr("关　　于"));  // 在"关"和"于"之间添加全角空格
     connect(aboutAction, &QAction::triggered, this, &MainWindow::showAboutDialog);
@@ -1717,18 +1918,22 @@ void MainWindow::setViewMode(const QString &mode) {
         setIconSize(24); // 树形视图默认使用中图标 (24x24)
         statusBar()->showMessage(tr("已切换到树形视图"), 2000);
     }
+    
+    // 切换视图后可见行不同，重新调度缩略图
+    m_thumbnailScrollTimer->start();
 }
 
 void MainWindow::refreshCurrentPath() {
     if (m_currentPath.isEmpty()) return;
     
     // 刷新文件系统模型
-    QModelIndex currentIndex = m_model->index(m_currentPath);
+    m_thumbnailLoader->cancelAll();
+    m_snapshots->remove(m_currentPath);
+    m_model->setTrustedListing(QString());
+    QModelIndex currentIndex = m_model->indexForPath(m_currentPath);
     m_model->setRootPath("");  // 重置
     m_model->setRootPath(m_currentPath);
-    m_tableView->setRootIndex(currentIndex);
-    m_listView->setRootIndex(currentIndex);
-    m_treeView->setRootIndex(currentIndex);
+    setViewRoot(currentIndex);
     
     // 重新应用排序设置
     applySortingSettings();
@@ -1770,6 +1975,59 @@ void MainWindow::onAddressBarTextChanged() {
     }
 }
 
+void MainWindow::runFilenameSearch() {
+    m_searchTimer->stop();
+    const QString query = m_searchBox->text().trimmed();
+    if (query.isEmpty()) {
+        if (m_stack->currentWidget() == m_searchResults) m_stack->setCurrentWidget(m_infoLabel);
+        return;
+    }
+    if (!m_filenameIndex || !m_filenameIndex->isReady()) {
+        statusBar()->showMessage(tr("文件名索引尚未建立，正在后台索引..."), 3000);
+        return;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    const QVector<FilenameIndex::Match> matches = m_filenameIndex->search(query, kMaxSearchResults);
+    const qint64 elapsed = timer.elapsed();
+    
+    m_searchResults->clear();
+    QFileIconProvider icons;
+    for (const FilenameIndex::Match &match : matches) {
+        auto *item = new QListWidgetItem(icons.icon(match.isDir ? QFileIconProvider::Folder : QFileIconProvider::File), match.path);
+        item->setData(Qt::UserRole, match.path);
+        item->setData(Qt::UserRole + 1, match.isDir);
+        m_searchResults->addItem(item);
+    }
+    m_stack->setCurrentWidget(m_searchResults);
+    statusBar()->showMessage(tr("找到 %1 个结果（%2 毫秒）").arg(matches.size()).arg(elapsed));
+}
+
+void MainWindow::runContentSearch() {
+    const QString pattern = m_searchBox->text();
+    if (pattern.isEmpty() || m_currentPath.isEmpty()) return;
+    m_contentSearch->search(m_currentPath, pattern);
+    m_stack->setCurrentWidget(m_contentSearch);
+}
+
+void MainWindow::revealPath(const QString &path, bool isDir) {
+    const QString dir = isDir ? path : QFileInfo(path).absolutePath();
+    if (!QDir(dir).exists()) {
+        statusBar()->showMessage(tr("路径不存在: %1").arg(path), 3000);
+        return;
+    }
+    navigateToPath(dir);
+    if (!isDir) {
+        const QModelIndex index = m_filterProxy->mapFromSource(m_model->indexForPath(path));
+        auto *view = qobject_cast<QAbstractItemView*>(m_fileViewStack->currentWidget());
+        if (index.isValid() && view) {
+            view->setCurrentIndex(index);
+            view->scrollTo(index);
+        }
+    }
+}
+
 void MainWindow::toggleThumbnailMode() {
     m_showThumbnails = !m_showThumbnails;
     
@@ -1785,6 +2043,13 @@ void MainWindow::toggleThumbnailMode() {
         statusBar()->showMessage(tr("缩略图显示已关闭"), 2000);
     }
     
+    // 关闭时丢弃尚未完成的缩略图任务，开启时按当前视口重新调度
+    if (!m_showThumbnails) {
+        m_thumbnailLoader->cancelAll();
+    } else {
+        m_thumbnailScrollTimer->start();
+    }
+    
     // 清空缩略图缓存
     if (m_iconProvider) {
         // 重新设置图标提供器以刷新显示
@@ -1793,7 +2058,7 @@ void MainWindow::toggleThumbnailMode() {
     }
     
     // 刷新当前视图
-    QModelIndex currentIndex = m_model->index(m_currentPath);
+    QModelIndex currentIndex = m_filterProxy->mapFromSource(m_model->indexForPath(m_currentPath));
     m_tableView->setRootIndex(QModelIndex());
     m_listView->setRootIndex(QModelIndex());
     m_treeView->setRootIndex(QModelIndex());
@@ -1803,15 +2068,15 @@ void MainWindow::toggleThumbnailMode() {
     m_treeView->setRootIndex(currentIndex);
 }
 
-void MainWindow::applySortingSettings() {
+void MainWindow::applySortingSettings(int column, Qt::SortOrder order) {
     // 使用 QTimer 延迟应用排序设置，确保模型完全加载后再设置
-    QTimer::singleShot(0, this, [this]() {
-        // 重新启用排序功能并应用默认排序
+    QTimer::singleShot(0, this, [this, column, order]() {
+        // 重新启用排序功能并应用排序（默认按名称升序）
         m_tableView->setSortingEnabled(true);
-        m_tableView->sortByColumn(0, Qt::AscendingOrder);
+        m_tableView->sortByColumn(column, order);
         
         m_treeView->setSortingEnabled(true);
-        m_treeView->sortByColumn(0, Qt::AscendingOrder);
+        m_treeView->sortByColumn(column, order);
         
         // 确保排序指示器显示
         m_tableView->horizontalHeader()->setSortIndicatorShown(true);
@@ -7,6 +7,17 @@
 #include <QFileIconProvider>
 #include <QHash>
 #include <QIcon>
+#include <QCache>
+#include <QMutex>
+#include <QSet>
+#include <QPointer>
+#include <QDir>
+
+#include "FileModel.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
 
 class QFileSystemModel;
 class QTreeView;
@@ -23,6 +34,17 @@ class QToolButton;
 class QLineEdit;
 class QScrollArea;
 class QHBoxLayout;
+class QImage;
+class QTimer;
+class ThumbnailLoader;
+class DirectorySizeCalculator;
+class FilenameIndexService;
+class StreamingFilterProxyModel;
+class ContentSearchView;
+class DirectorySnapshotCache;
+class VolumeMonitor;
+class OfficeConversionService;
+class OfficePrewarmer;
 #ifdef HAVE_QT_PDF_CORE
 class PdfSimpleViewer;
 #endif
@@ -31,21 +53,107 @@ class OfficeWebViewer;
 #endif
 
 // 自定义图标提供器，支持图片缩略图
+// 需要读取文件内容的缩略图由 ThumbnailLoader 在后台生成，生成前先显示系统图标
 class ThumbnailIconProvider : public QFileIconProvider {
 public:
-    ThumbnailIconProvider(bool *enableThumbnails) : m_enableThumbnails(enableThumbnails) {}
+    ThumbnailIconProvider(bool *enableThumbnails, ThumbnailLoader *loader);
     QIcon icon(const QFileInfo &info) const override;
+
+    // 查询已生成的缩略图；尚未生成时提交后台任务并返回空图标
+    QIcon thumbnail(const QString &filePath) const;
+    // 后台任务完成后在界面线程写入缓存；typeKey 非空时图标按类型共享
+    void storeThumbnail(const QString &filePath, const QImage &image, const QString &typeKey);
+
+    // 内存缓存按字节预算做 LRU 淘汰，被淘汰的缩略图再次显示时从磁盘缓存读回
+    struct CacheStats {
+        quint64 hits {0};
+        quint64 misses {0};
+        quint64 evictions {0};
+        qint64 residentBytes {0};
+        qint64 budgetBytes {0};
+        int entries {0};
+    };
+    void setMemoryBudget(qint64 bytes);
+    CacheStats cacheStats() const;
+    
+    // 按优先级顺序调度缩略图生成（已缓存的路径会被跳过）
+    void scheduleThumbnails(const QStringList &orderedPaths) const;
+    
+    // 缩略图按该设备像素比绘制
+    void setDevicePixelRatio(qreal dpr) { m_devicePixelRatio = dpr; }
+
 private:
-    mutable QHash<QString, QIcon> m_thumbnailCache;
+    bool thumbnailsEnabled() const { return m_enableThumbnails && *m_enableThumbnails; }
+    // 以下三个函数要求调用方已持有 m_cacheMutex
+    bool lookup(const QString &key, QIcon *icon) const;
+    void insert(const QString &key, const QIcon &icon, qint64 bytes) const;
+    // 按类型共享的图标（与文件内容无关），每种类型和像素比只保存一份
+    QIcon typeIcon(const QString &typeKey, const QImage &image) const;
+
+    // icon() 会在文件系统模型的信息收集线程中调用，缓存需要加锁
+    mutable QMutex m_cacheMutex;
+    mutable QCache<QString, QIcon> m_thumbnailCache;
+    mutable CacheStats m_stats;
+    mutable QHash<QString, QIcon> m_typeIcons;
     bool *m_enableThumbnails;
-    static bool isImageFile(const QString &filePath);
+    ThumbnailLoader *m_loader;
+    qreal m_devicePixelRatio {1.0};
 };
 
 // 自定义文件系统模型，用于支持中文列标题和类型显示
-class CustomFileSystemModel : public QFileSystemModel {
+class CustomFileSystemModel : public QFileSystemModel, public FileModel {
     Q_OBJECT
 public:
-    explicit CustomFileSystemModel(QObject *parent = nullptr) : QFileSystemModel(parent) {}
+    explicit CustomFileSystemModel(QObject *parent = nullptr) : QFileSystemModel(parent) {
+        // 行增删或目录重新加载后节点可能被复用，整体丢弃显示缓存；单个文件变化只丢弃对应行
+        connect(this, &QAbstractItemModel::rowsInserted, this, [this]() { m_displayCache.clear(); });
+        connect(this, &QAbstractItemModel::rowsRemoved, this, [this]() { m_displayCache.clear(); });
+        connect(this, &QAbstractItemModel::modelReset, this, [this]() { m_displayCache.clear(); });
+        connect(this, &QAbstractItemModel::dataChanged, this,
+                [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles) {
+            // 缩略图更新只涉及图标，不影响文字列
+            if (roles.size() == 1 && roles.first() == Qt::DecorationRole) return;
+            for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+                m_displayCache.remove(index(row, 0, topLeft.parent()).internalPointer());
+            }
+        });
+    }
+    
+    QAbstractItemModel *itemModel() override { return this; }
+    QModelIndex indexForPath(const QString &path) const override { return index(path); }
+    QString filePath(const QModelIndex &index) const override { return QFileSystemModel::filePath(index); }
+    QFileInfo fileInfo(const QModelIndex &index) const override { return QFileSystemModel::fileInfo(index); }
+    QIcon fileIcon(const QModelIndex &index) const override { return QFileSystemModel::fileIcon(index); }
+    void setRootPath(const QString &path) override { QFileSystemModel::setRootPath(path); }
+    void setIconProvider(QFileIconProvider *provider) override { QFileSystemModel::setIconProvider(provider); }
+    void onDirectoryLoaded(QObject *context, const std::function<void(const QString &)> &slot) override {
+        connect(this, &QFileSystemModel::directoryLoaded, context, slot);
+    }
+    
+    void setThumbnailProvider(const ThumbnailIconProvider *provider) override { m_thumbnails = provider; }
+    
+    // 缩略图生成完成后通知视图重绘对应行
+    void thumbnailUpdated(const QString &filePath) override {
+        const QModelIndex idx = index(filePath);
+        if (idx.isValid()) {
+            emit dataChanged(idx, idx, {Qt::DecorationRole});
+        }
+    }
+    
+    // 后退/前进时目录快照仍然有效：模型中保留的节点就是最新内容，不再让后台线程重新列出该目录
+    void setTrustedListing(const QString &path) override {
+        m_trustedListing = path.isEmpty() ? QString() : QDir::cleanPath(path);
+    }
+    
+    bool canFetchMore(const QModelIndex &parent) const override {
+        if (isTrustedListing(parent)) return false;
+        return QFileSystemModel::canFetchMore(parent);
+    }
+    
+    void fetchMore(const QModelIndex &parent) override {
+        if (isTrustedListing(parent)) return;
+        QFileSystemModel::fetchMore(parent);
+    }
     
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override {
         if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
@@ -61,6 +169,14 @@ public:
     }
     
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override {
+        // 名称列图标：优先使用后台生成的缩略图（只有视图实际绘制的行才会触发生成）
+        if (role == Qt::DecorationRole && index.column() == 0 && m_thumbnails) {
+            const QIcon thumb = m_thumbnails->thumbnail(filePath(index));
+            if (!thumb.isNull()) {
+                return thumb;
+            }
+        }
+        
         // 对于非类型和非日期列，使用默认实现以保持排序功能
         if (index.column() != 2 && index.column() != 3) {
             return QFileSystemModel::data(index, role);
@@ -71,27 +187,65 @@ public:
             return QFileSystemModel::data(index, role);
         }
         
-        // 处理类型列的中文显示
-        if (index.column() == 2) {
-            QFileInfo info = QFileSystemModel::fileInfo(index);
-            if (info.isDir()) {
-                return tr("目录");
-            } else if (info.suffix().isEmpty()) {
-                return tr("文件");
-            } else {
-                return info.suffix().toUpper() + " " + tr("文件");
-            }
+        // 类型列和日期列的显示文字按行缓存，滚动重绘时不再构造 QFileInfo 和格式化日期
+        const DisplayEntry &entry = displayEntry(index);
+        return index.column() == 2 ? entry.type : entry.date;
+    }
+
+private:
+    bool isTrustedListing(const QModelIndex &parent) const {
+        return !m_trustedListing.isEmpty() && QDir::cleanPath(filePath(parent)) == m_trustedListing;
+    }
+    
+    struct DisplayEntry {
+        QString type;
+        QString date;
+    };
+
+    const DisplayEntry &displayEntry(const QModelIndex &index) const {
+        // 同一文件节点的所有列共享 internalPointer
+        const void *node = index.internalPointer();
+        auto it = m_displayCache.constFind(node);
+        if (it != m_displayCache.constEnd()) return it.value();
+
+        if (m_displayCache.size() >= kMaxDisplayCacheRows) {
+            m_displayCache.clear();
         }
-        
+        const QFileInfo info = QFileSystemModel::fileInfo(index);
+        DisplayEntry entry;
+        // 处理类型列的中文显示
+        entry.type = typeLabel(info);
         // 处理日期列的格式化显示（补零格式）
-        if (index.column() == 3) {
-            QFileInfo info = QFileSystemModel::fileInfo(index);
-            QDateTime dateTime = info.lastModified();
-            return dateTime.toString("yyyy/MM/dd HH:mm");
+        entry.date = info.lastModified().toString("yyyy/MM/dd HH:mm");
+        return m_displayCache.insert(node, entry).value();
+    }
+
+    // 类型文字按扩展名复用同一个字符串，各行共享而不是各自分配
+    QString typeLabel(const QFileInfo &info) const {
+        if (info.isDir()) {
+            if (m_dirLabel.isEmpty()) m_dirLabel = tr("目录");
+            return m_dirLabel;
         }
-        
-        return QFileSystemModel::data(index, role);
+        const QString suffix = info.suffix();
+        if (suffix.isEmpty()) {
+            if (m_fileLabel.isEmpty()) m_fileLabel = tr("文件");
+            return m_fileLabel;
+        }
+        auto it = m_typeLabels.constFind(suffix);
+        if (it == m_typeLabels.constEnd()) {
+            it = m_typeLabels.insert(suffix, suffix.toUpper() + " " + tr("文件"));
+        }
+        return it.value();
     }
+
+    static constexpr int kMaxDisplayCacheRows = 200000;
+
+    mutable QHash<const void *, DisplayEntry> m_displayCache;
+    mutable QHash<QString, QString> m_typeLabels;
+    mutable QString m_dirLabel;
+    mutable QString m_fileLabel;
+    const ThumbnailIconProvider *m_thumbnails {nullptr};
+    QString m_trustedListing;
 };
 
 class MainWindow : public QMainWindow {
@@ -116,14 +270,23 @@ private slots:
     void setIconSize(int size);
     void toggleColumn(int column, bool visible);
     void setViewMode(const QString &mode);
-    void applySortingSettings();
+    void applySortingSettings(int column = 0, Qt::SortOrder order = Qt::AscendingOrder);
     void refreshCurrentPath();
     void showAboutDialog();
+    void scheduleVisibleThumbnails();
+    void showThumbnailCacheStats();
 
 private:
     void setupUI();
     void setupToolbar();
+    // 按已发现的卷重新生成快捷栏中的磁盘项
+    void refreshVolumeShortcuts();
+    // 用快捷栏中的目录和磁盘作为文件名索引的根目录
+    void updateIndexRoots();
     void navigateToPath(const QString &path);
+    void openHistoryEntry();
+    void leaveCurrentDirectory();
+    void reconcileListing(const QString &path);
     void showImage(const QString &path);
     void showText(const QString &path);
     void showMedia(const QString &path);
@@ -132,12 +295,30 @@ private:
 #endif
     void showInfo(const QString &message);
     void showFileDetails(const QString &path);
-    QString formatFileSize(qint64 size);
-    int countFilesInDirectory(const QString &path);
+    static int countFilesInDirectory(const QString &path, const std::atomic_bool &cancelled);
+    // 在后台线程统计目录项数，完成后在界面线程调用 done；cancelFlag 保存该用途的取消标志，新的统计会取消旧的
+    void countItemsAsync(const QString &path, std::shared_ptr<std::atomic_bool> &cancelFlag,
+                         const std::function<void(int)> &done);
+    void updateDirectoryStatus();
+    void showDirectoryStatus(const QString &path, int count);
+    QStringList thumbnailSchedule() const;
+    // 把三个视图的根设为源模型中的目录；切换到其它目录时清空目录内筛选
+    void setViewRoot(const QModelIndex &sourceIndex);
+    void runFilenameSearch();
+    void runContentSearch();
+    // 在文件视图中打开 path 所在目录，文件则同时选中它
+    void revealPath(const QString &path, bool isDir);
 
-    CustomFileSystemModel *m_model {nullptr};
+    FileModel *m_model {nullptr};  // CustomFileSystemModel 或 NativeFileModel（配置项 view/nativeModel）
+    StreamingFilterProxyModel *m_filterProxy {nullptr};  // 视图使用的模型，视图中的索引需映射回 m_model
+    QLineEdit *m_filterBox {nullptr};
     ThumbnailIconProvider *m_iconProvider {nullptr};
+    ThumbnailLoader *m_thumbnailLoader {nullptr};
+    QTimer *m_thumbnailScrollTimer {nullptr};
+    int m_thumbnailPrefetch {50};  // 可见范围上下各预取的行数
     QListWidget *m_shortcuts {nullptr};
+    static constexpr int kVolumeItemRole = Qt::UserRole + 1;  // 快捷栏中由 m_volumeMonitor 生成的磁盘项
+    VolumeMonitor *m_volumeMonitor {nullptr};
     QStackedWidget *m_fileViewStack {nullptr};
     QTableView *m_tableView {nullptr};
     QListView *m_listView {nullptr};
@@ -151,6 +332,11 @@ private:
 #endif
 #ifdef HAVE_QT_WEBENGINE
     OfficeWebViewer *m_officeWebViewer {nullptr};
+#endif
+    OfficeConversionService *m_officeConversions {nullptr};
+    QString m_officePreviewPath;  // 等待转换结果以显示 PDF 预览的办公文档
+#ifdef HAVE_QT_PDF_CORE
+    OfficePrewarmer *m_officePrewarmer {nullptr};
 #endif
     QLabel *m_infoLabel {nullptr};
     QWidget *m_detailsPanel {nullptr};
@@ -177,6 +363,25 @@ private:
     QStringList m_history;
     int m_historyIndex {-1};
     QString m_currentPath;
+    bool m_currentListed {false};  // 模型已完整列出当前目录（或由有效快照恢复）
+    DirectorySnapshotCache *m_snapshots {nullptr};
+    static constexpr int kSnapshotReconcileDelayMs = 1000;
+    std::shared_ptr<std::atomic_bool> m_statusCountCancel;
+    std::shared_ptr<std::atomic_bool> m_detailsCountCancel;
+    
+    // 详情面板的目录大小统计
+    DirectorySizeCalculator *m_sizeCalculator {nullptr};
+    QPointer<QLabel> m_detailsSizeLabel;
+    QString m_detailsSizePath;
+    
+    // 文件名搜索
+    static constexpr int kMaxSearchResults = 1000;
+    FilenameIndexService *m_filenameIndex {nullptr};
+    QLineEdit *m_searchBox {nullptr};
+    QTimer *m_searchTimer {nullptr};
+    QListWidget *m_searchResults {nullptr};
+    QToolButton *m_btnContentSearch {nullptr};
+    ContentSearchView *m_contentSearch {nullptr};
 };
 
 #endif // MAINWINDOW_H
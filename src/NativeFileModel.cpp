@@ -0,0 +1,821 @@
+#include "NativeFileModel.h"
+#include "MainWindow.h"
+#include "ParallelSort.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileIconProvider>
+#include <QFileSystemModel>
+#include <QFileSystemWatcher>
+#include <QLocale>
+#include <QSet>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+
+namespace {
+constexpr int kColumns = 4;
+constexpr size_t kListBatch = 4096;  // 首次读取时每批交给界面线程的条目数
+constexpr size_t kStatChunk = 1024;  // 每个 statx 任务处理的条目数
+constexpr int kMaxRoots = 64;        // 保留的曾作为视图根的目录数
+constexpr int kRescanDelayMs = 500;  // 目录变化后合并通知再重新读取
+constexpr int kAttributePrefetch = 64;  // 延迟属性模式下，显示到的行前后各预取的行数
+
+// 索引的 internalId：高位是目录槽位，低位是目录内的条目编号（条目各不相同，筛选代理据此识别行）
+constexpr int kEntryBits = sizeof(quintptr) >= 8 ? 32 : 20;
+constexpr quintptr kEntryMask = (quintptr(1) << kEntryBits) - 1;
+
+quintptr packId(quint32 slot, quint32 entry) { return (quintptr(slot) << kEntryBits) | entry; }
+quint32 slotOf(quintptr id) { return quint32(id >> kEntryBits); }
+quint32 entryOf(quintptr id) { return quint32(id & kEntryMask); }
+
+QString joinPath(const QString &dir, const QString &name) {
+    return dir.endsWith('/') ? dir + name : dir + '/' + name;
+}
+}
+
+NativeFileModel::NativeFileModel(QObject *parent) : QAbstractItemModel(parent) {
+    m_pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 8));
+    m_collator = makeCollator(m_collationLocale);
+
+    auto top = std::make_unique<Listing>();
+    top->started = true;
+    m_listings.push_back(std::move(top));
+
+    // 当前根目录有增删时重新读取，只更新变化的行
+    m_watcher = new QFileSystemWatcher(this);
+    m_rescanTimer = new QTimer(this);
+    m_rescanTimer->setSingleShot(true);
+    m_rescanTimer->setInterval(kRescanDelayMs);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_rescanTimer, qOverload<>(&QTimer::start));
+    connect(m_rescanTimer, &QTimer::timeout, this, [this]() {
+        Listing *listing = listingAt(m_slotByPath.value(m_rootPath));
+        if (!listing || listing->slot == 0) return;
+        if (listing->enumerating) {
+            m_rescanTimer->start();
+            return;
+        }
+        // 文件内容的修改也会触发，仍存在的条目同样要重新查询属性
+        startListing(listing);
+    });
+
+    // 同一轮绘制中请求的属性合并后再提交
+    m_requestTimer = new QTimer(this);
+    m_requestTimer->setSingleShot(true);
+    m_requestTimer->setInterval(0);
+    connect(m_requestTimer, &QTimer::timeout, this, &NativeFileModel::flushAttributeRequests);
+}
+
+NativeFileModel::~NativeFileModel() {
+    // 后台任务会向本对象投递结果，等它们结束后再析构
+    for (const auto &listing : m_listings) {
+        if (listing && listing->cancel) listing->cancel->store(true);
+    }
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QCollator NativeFileModel::makeCollator(const QLocale &locale) {
+    // 与 QFileSystemModel 相同：忽略大小写，数字按数值比较
+    QCollator collator(locale);
+    collator.setNumericMode(true);
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    return collator;
+}
+
+void NativeFileModel::setCollationLocale(const QLocale &locale) {
+    m_collationLocale = locale;
+    m_collator = makeCollator(locale);
+}
+
+NativeFileModel::Listing *NativeFileModel::listingAt(quint32 slot) const {
+    return slot < m_listings.size() ? m_listings[slot].get() : nullptr;
+}
+
+NativeFileModel::Listing *NativeFileModel::childListing(const QModelIndex &parent) const {
+    if (!parent.isValid()) return m_listings[0].get();
+    const Listing *owner = listingAt(slotOf(parent.internalId()));
+    if (!owner) return nullptr;
+    const auto it = owner->children.constFind(entryOf(parent.internalId()));
+    return it == owner->children.constEnd() ? nullptr : listingAt(it.value());
+}
+
+NativeFileModel::Listing *NativeFileModel::createListing(Listing *parent, quint32 entry) {
+    quint32 slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = quint32(m_listings.size());
+        m_listings.emplace_back();
+    }
+    auto listing = std::make_unique<Listing>();
+    listing->slot = slot;
+    listing->serial = ++m_nextSerial;
+    listing->parentSlot = parent->slot;
+    listing->parentEntry = entry;
+    listing->path = parent->slot == 0 ? parent->names[entry] : joinPath(parent->path, parent->names[entry]);
+    parent->children.insert(entry, slot);
+    if (!m_slotByPath.contains(listing->path)) m_slotByPath.insert(listing->path, slot);
+    m_listings[slot] = std::move(listing);
+    return m_listings[slot].get();
+}
+
+void NativeFileModel::freeListing(quint32 slot) {
+    Listing *listing = listingAt(slot);
+    if (!listing) return;
+    if (listing->cancel) listing->cancel->store(true);
+    const QHash<quint32, quint32> &children = listing->children;
+    for (const quint32 child : children) freeListing(child);
+    if (m_slotByPath.value(listing->path) == slot) m_slotByPath.remove(listing->path);
+    m_requestedAttributes.remove(slot);
+    m_listings[slot].reset();
+    m_freeSlots.push_back(slot);
+}
+
+QModelIndex NativeFileModel::parentIndex(const Listing *listing) const {
+    if (listing->slot == 0) return QModelIndex();
+    const Listing *parent = listingAt(listing->parentSlot);
+    return createIndex(int(parent->rowOf[listing->parentEntry]), 0, packId(parent->slot, listing->parentEntry));
+}
+
+QString NativeFileModel::entryPath(const Listing &listing, quint32 id) const {
+    return listing.slot == 0 ? listing.names[id] : joinPath(listing.path, listing.names[id]);
+}
+
+QModelIndex NativeFileModel::index(int row, int column, const QModelIndex &parent) const {
+    if (row < 0 || column < 0 || column >= kColumns || parent.column() > 0) return QModelIndex();
+    const Listing *listing = childListing(parent);
+    if (!listing || row >= int(listing->order.size())) return QModelIndex();
+    return createIndex(row, column, packId(listing->slot, listing->order[row]));
+}
+
+QModelIndex NativeFileModel::parent(const QModelIndex &child) const {
+    if (!child.isValid()) return QModelIndex();
+    const Listing *listing = listingAt(slotOf(child.internalId()));
+    if (!listing) return QModelIndex();
+    return parentIndex(listing);
+}
+
+int NativeFileModel::rowCount(const QModelIndex &parent) const {
+    if (parent.column() > 0) return 0;
+    const Listing *listing = childListing(parent);
+    return listing ? int(listing->order.size()) : 0;
+}
+
+int NativeFileModel::columnCount(const QModelIndex &parent) const {
+    return parent.column() > 0 ? 0 : kColumns;
+}
+
+bool NativeFileModel::hasChildren(const QModelIndex &parent) const {
+    if (!parent.isValid()) return !m_listings[0]->order.empty();
+    if (parent.column() > 0) return false;
+    const Listing *owner = listingAt(slotOf(parent.internalId()));
+    if (!owner) return false;
+    // 类型未知的条目（符号链接等）在取得属性前按可能有子项处理
+    const quint8 flags = owner->flags[entryOf(parent.internalId())];
+    return (flags & IsDir) || !(flags & TypeKnown);
+}
+
+Qt::ItemFlags NativeFileModel::flags(const QModelIndex &index) const {
+    if (!index.isValid()) return Qt::NoItemFlags;
+    Qt::ItemFlags result = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    const Listing *owner = listingAt(slotOf(index.internalId()));
+    if (owner) {
+        const quint8 flags = owner->flags[entryOf(index.internalId())];
+        if ((flags & TypeKnown) && !(flags & IsDir)) result |= Qt::ItemNeverHasChildren;
+    }
+    return result;
+}
+
+QVariant NativeFileModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid()) return QVariant();
+    Listing *listing = listingAt(slotOf(index.internalId()));
+    if (!listing) return QVariant();
+    const quint32 id = entryOf(index.internalId());
+    const quint8 flags = listing->flags[id];
+    const bool isDir = flags & IsDir;
+
+    // 视图只为绘制的行取大小和日期，在这里按需提交查询
+    if (m_lazyAttributes && role == Qt::DisplayRole && (index.column() == 1 || index.column() == 3)
+        && !(flags & Queued) && (!(flags & Statted) || (flags & Stale))) {
+        requestAttributes(listing, index.row());
+    }
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        switch (index.column()) {
+        case 0:
+            return listing->names[id];
+        case 1:
+            // 与 QFileSystemModel 相同，目录不显示大小
+            if (isDir || !(flags & Statted)) return QString();
+            return QLocale::system().formattedDataSize(listing->sizes[id]);
+        case 2:
+            return typeLabel(listing->names[id], isDir);
+        case 3:
+            if (!(flags & Statted)) return QString();
+            return QDateTime::fromMSecsSinceEpoch(listing->mtimes[id] / 1000000).toString("yyyy/MM/dd HH:mm");
+        default:
+            break;
+        }
+        break;
+    case Qt::DecorationRole:
+        if (index.column() == 0) return entryIcon(*listing, id);
+        break;
+    case Qt::TextAlignmentRole:
+        if (index.column() == 1) return int(Qt::AlignRight | Qt::AlignVCenter);
+        break;
+    case QFileSystemModel::FilePathRole:
+        return entryPath(*listing, id);
+    case QFileSystemModel::FileNameRole:
+        return listing->names[id];
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+QVariant NativeFileModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+            case 0: return tr("名称");
+            case 1: return tr("大小");
+            case 2: return tr("类型");
+            case 3: return tr("修改日期");
+            default: break;
+        }
+    }
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+QIcon NativeFileModel::entryIcon(const Listing &listing, quint32 id) const {
+    const bool isDir = listing.flags[id] & IsDir;
+    // 优先使用后台生成的缩略图（只有视图实际绘制的行才会触发生成）
+    if (!isDir && m_thumbnails) {
+        const QIcon thumb = m_thumbnails->thumbnail(entryPath(listing, id));
+        if (!thumb.isNull()) return thumb;
+    }
+    if (!m_iconProvider) return QIcon();
+    if (isDir) {
+        if (m_folderIcon.isNull()) m_folderIcon = m_iconProvider->icon(QFileIconProvider::Folder);
+        return m_folderIcon;
+    }
+    // 同一扩展名的文件共用图标，不为每个文件查询 MIME 类型
+    const QString &name = listing.names[id];
+    const int dot = name.lastIndexOf('.');
+    const QString suffix = dot < 0 ? QString() : name.mid(dot + 1).toLower();
+    auto it = m_suffixIcons.constFind(suffix);
+    if (it == m_suffixIcons.constEnd()) {
+        it = m_suffixIcons.insert(suffix, suffix.isEmpty() ? m_iconProvider->icon(QFileIconProvider::File)
+                                                           : m_iconProvider->icon(QFileInfo(entryPath(listing, id))));
+    }
+    return it.value();
+}
+
+// 类型文字按扩展名复用同一个字符串，与 CustomFileSystemModel 的显示一致
+QString NativeFileModel::typeLabel(const QString &name, bool isDir) const {
+    if (isDir) return tr("目录");
+    const int dot = name.lastIndexOf('.');
+    if (dot < 0 || dot == name.size() - 1) return tr("文件");
+    const QString suffix = name.mid(dot + 1);
+    auto it = m_typeLabels.constFind(suffix);
+    if (it == m_typeLabels.constEnd()) {
+        it = m_typeLabels.insert(suffix, suffix.toUpper() + " " + tr("文件"));
+    }
+    return it.value();
+}
+
+QModelIndex NativeFileModel::indexForPath(const QString &path) const {
+    if (path.isEmpty()) return QModelIndex();
+    const QString clean = QDir::cleanPath(path);
+    const Listing *top = m_listings[0].get();
+    const auto root = top->idOfName.constFind(clean);
+    if (root != top->idOfName.constEnd()) {
+        return createIndex(int(top->rowOf[root.value()]), 0, packId(0, root.value()));
+    }
+    const int slash = clean.lastIndexOf('/');
+    if (slash < 0) return QModelIndex();
+    const Listing *listing = listingAt(m_slotByPath.value(slash == 0 ? QStringLiteral("/") : clean.left(slash)));
+    if (!listing || listing->slot == 0) return QModelIndex();
+    const auto it = listing->idOfName.constFind(clean.mid(slash + 1));
+    if (it == listing->idOfName.constEnd()) return QModelIndex();
+    return createIndex(int(listing->rowOf[it.value()]), 0, packId(listing->slot, it.value()));
+}
+
+QString NativeFileModel::filePath(const QModelIndex &index) const {
+    if (!index.isValid()) return QString();
+    const Listing *listing = listingAt(slotOf(index.internalId()));
+    return listing ? entryPath(*listing, entryOf(index.internalId())) : QString();
+}
+
+QFileInfo NativeFileModel::fileInfo(const QModelIndex &index) const {
+    return QFileInfo(filePath(index));
+}
+
+QIcon NativeFileModel::fileIcon(const QModelIndex &index) const {
+    return data(index.sibling(index.row(), 0), Qt::DecorationRole).value<QIcon>();
+}
+
+void NativeFileModel::setRootPath(const QString &path) {
+    if (path.isEmpty()) return;
+    const QString clean = QDir::cleanPath(path);
+    Listing *top = m_listings[0].get();
+    Listing *listing = nullptr;
+    const auto it = top->idOfName.constFind(clean);
+    if (it != top->idOfName.constEnd()) {
+        listing = listingAt(top->children.value(it.value()));
+        m_rootLru.removeOne(clean);
+    } else {
+        const int row = int(top->order.size());
+        beginInsertRows(QModelIndex(), row, row);
+        const quint32 id = pushEntry(top, clean, m_collator.sortKey(clean), IsDir | TypeKnown | Statted);
+        listing = createListing(top, id);
+        endInsertRows();
+    }
+    // 作为根的目录优先于树形展开时读取的同一目录
+    m_slotByPath.insert(clean, listing->slot);
+    m_rootLru.append(clean);
+
+    if (clean != m_rootPath) {
+        if (!m_rootPath.isEmpty()) m_watcher->removePath(m_rootPath);
+        m_rootPath = clean;
+        m_watcher->addPath(clean);
+    }
+    // 再次进入的目录重新读取并只更新变化的行；快照仍有效（受信任）的目录直接使用现有内容
+    if (!listing->started || clean != m_trustedListing) startListing(listing);
+    evictRoots();
+}
+
+void NativeFileModel::evictRoots() {
+    Listing *top = m_listings[0].get();
+    while (m_rootLru.size() > kMaxRoots) {
+        const QString victim = m_rootLru.takeFirst();
+        if (victim == m_rootPath) {
+            m_rootLru.append(victim);
+            continue;
+        }
+        const auto it = top->idOfName.constFind(victim);
+        if (it != top->idOfName.constEnd()) removeEntries(top, {it.value()});
+    }
+    // 顶层没有后台查询，删除的编号可以立即复用
+    top->reusableIds = top->freeIds.size();
+}
+
+void NativeFileModel::setIconProvider(QFileIconProvider *provider) {
+    m_iconProvider = provider;
+    m_suffixIcons.clear();
+    m_folderIcon = QIcon();
+    const Listing *listing = listingAt(m_slotByPath.value(m_rootPath));
+    if (listing && listing->slot != 0 && !listing->order.empty()) {
+        const QModelIndex parent = parentIndex(listing);
+        emit dataChanged(index(0, 0, parent), index(int(listing->order.size()) - 1, 0, parent), {Qt::DecorationRole});
+    }
+}
+
+void NativeFileModel::thumbnailUpdated(const QString &filePath) {
+    const QModelIndex idx = indexForPath(filePath);
+    if (idx.isValid()) {
+        emit dataChanged(idx, idx, {Qt::DecorationRole});
+    }
+}
+
+void NativeFileModel::setTrustedListing(const QString &path) {
+    m_trustedListing = path.isEmpty() ? QString() : QDir::cleanPath(path);
+}
+
+void NativeFileModel::onDirectoryLoaded(QObject *context, const std::function<void(const QString &)> &slot) {
+    connect(this, &NativeFileModel::directoryLoaded, context, slot);
+}
+
+bool NativeFileModel::canFetchMore(const QModelIndex &parent) const {
+    if (!parent.isValid() || parent.column() > 0) return false;
+    const Listing *owner = listingAt(slotOf(parent.internalId()));
+    if (!owner || !(owner->flags[entryOf(parent.internalId())] & IsDir)) return false;
+    const Listing *listing = childListing(parent);
+    return !listing || !listing->started;
+}
+
+void NativeFileModel::fetchMore(const QModelIndex &parent) {
+    if (!parent.isValid() || parent.column() > 0) return;
+    Listing *owner = listingAt(slotOf(parent.internalId()));
+    const quint32 entry = entryOf(parent.internalId());
+    if (!owner || !(owner->flags[entry] & IsDir)) return;
+    Listing *listing = childListing(parent);
+    if (!listing) listing = createListing(owner, entry);
+    // 已读取过的目录只在明确要求时（如快照失效后的核对）重新读取
+    if (!listing->started || (!listing->enumerating && listing->path != m_trustedListing)) startListing(listing);
+}
+
+quint32 NativeFileModel::pushEntry(Listing *listing, const QString &name, const QCollatorSortKey &key, quint8 flags) {
+    quint32 id;
+    if (listing->reusableIds > 0) {
+        // 复用已删除条目的编号，频繁增删的目录不会无限增长
+        id = listing->freeIds[--listing->reusableIds];
+        listing->freeIds.erase(listing->freeIds.begin() + listing->reusableIds);
+        listing->names[id] = name;
+        listing->keys[id] = key;
+        listing->flags[id] = flags;
+        listing->sizes[id] = 0;
+        listing->mtimes[id] = 0;
+        listing->rowOf[id] = quint32(listing->order.size());
+    } else {
+        id = quint32(listing->names.size());
+        listing->names.push_back(name);
+        listing->keys.push_back(key);
+        listing->flags.push_back(flags);
+        listing->sizes.push_back(0);
+        listing->mtimes.push_back(0);
+        listing->rowOf.push_back(quint32(listing->order.size()));
+    }
+    listing->order.push_back(id);
+    listing->idOfName.insert(name, id);
+    return id;
+}
+
+void NativeFileModel::appendEntries(Listing *listing, const NameBatch &batch) {
+    if (batch.names.empty()) return;
+    const int first = int(listing->order.size());
+    beginInsertRows(parentIndex(listing), first, first + int(batch.names.size()) - 1);
+    std::vector<quint32> ids;
+    ids.reserve(batch.names.size());
+    for (size_t i = 0; i < batch.names.size(); ++i) {
+        // d_type 能直接区分目录和文件；符号链接和未知类型要等 statx 跟随后才知道
+        quint8 flags = 0;
+        switch (EntryType(batch.types[i])) {
+        case EntryType::Directory: flags = IsDir | TypeKnown; break;
+        case EntryType::File:
+        case EntryType::Other: flags = TypeKnown; break;
+        default: break;
+        }
+        ids.push_back(pushEntry(listing, batch.names[i], batch.keys[i], flags));
+    }
+    endInsertRows();
+    if (m_lazyAttributes) {
+        // 延迟模式下只为类型未知的条目立即查询（排序时目录在前需要知道类型），其余等显示时再查
+        ids.erase(std::remove_if(ids.begin(), ids.end(), [listing](quint32 id) {
+            return listing->flags[id] & TypeKnown;
+        }), ids.end());
+    }
+    scheduleStats(listing, ids, StatPurpose::Load);
+}
+
+void NativeFileModel::removeEntries(Listing *listing, const std::vector<quint32> &ids) {
+    if (ids.empty()) return;
+    std::vector<quint32> rows;
+    rows.reserve(ids.size());
+    for (const quint32 id : ids) rows.push_back(listing->rowOf[id]);
+    std::sort(rows.begin(), rows.end(), std::greater<quint32>());
+
+    // 从下往上按连续的行段删除，上方的行号不受影响
+    const QModelIndex parent = parentIndex(listing);
+    for (size_t i = 0; i < rows.size();) {
+        const quint32 last = rows[i];
+        quint32 first = last;
+        while (++i < rows.size() && rows[i] == first - 1) --first;
+
+        beginRemoveRows(parent, int(first), int(last));
+        for (quint32 row = first; row <= last; ++row) {
+            const quint32 id = listing->order[row];
+            const auto child = listing->children.find(id);
+            if (child != listing->children.end()) {
+                const quint32 slot = child.value();
+                listing->children.erase(child);
+                freeListing(slot);
+            }
+            listing->idOfName.remove(listing->names[id]);
+            listing->names[id] = QString();
+            listing->flags[id] = Removed;
+            listing->freeIds.push_back(id);
+        }
+        listing->order.erase(listing->order.begin() + first, listing->order.begin() + last + 1);
+        // 删除不影响其余行的相对顺序，已排序部分只是变短
+        if (first < listing->sortedCount) listing->sortedCount -= std::min<size_t>(listing->sortedCount, last + 1) - first;
+        for (size_t row = first; row < listing->order.size(); ++row) listing->rowOf[listing->order[row]] = quint32(row);
+        endRemoveRows();
+    }
+}
+
+void NativeFileModel::startListing(Listing *listing, bool restatAll) {
+    if (listing->cancel) listing->cancel->store(true);
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    listing->cancel = cancelled;
+    listing->started = true;
+    listing->enumerating = true;
+    listing->rescanning = !listing->order.empty();
+    listing->restatAll = restatAll;
+    // 上一轮尚未返回的结果按轮次丢弃，之前删除的编号从此可以复用
+    listing->reusableIds = listing->freeIds.size();
+    listing->pendingStats = 0;
+    listing->bulkPending = 0;
+    for (quint8 &flags : listing->flags) flags &= ~Queued;
+    const quint64 generation = ++listing->generation;
+    const quint32 slot = listing->slot;
+    const quint64 serial = listing->serial;
+    const bool rescanning = listing->rescanning;
+    const QByteArray dir = QFile::encodeName(listing->path);
+    const QLocale locale = m_collationLocale;
+
+    m_pool.start([this, dir, locale, slot, serial, generation, rescanning, cancelled]() {
+        // 排序键在这里生成，界面线程排序时只做比较
+        const QCollator collator = makeCollator(locale);
+        auto batch = std::make_shared<NameBatch>();
+        const auto post = [&](bool last) {
+            QMetaObject::invokeMethod(this, [this, slot, serial, generation, batch, last]() {
+                onListed(slot, serial, generation, batch, last);
+            }, Qt::QueuedConnection);
+        };
+        DirectoryReader::list(dir, [&](const char *name, EntryType type) {
+            // 与 QFileSystemModel 的默认过滤一致，不显示隐藏文件
+            if (name[0] == '.') return true;
+            batch->names.push_back(QFile::decodeName(name));
+            batch->keys.push_back(collator.sortKey(batch->names.back()));
+            batch->types.push_back(quint8(type));
+            // 首次读取时分批显示；重新读取要与完整结果比较，最后一次交付
+            if (!rescanning && batch->names.size() >= kListBatch) {
+                post(false);
+                batch = std::make_shared<NameBatch>();
+            }
+            return !cancelled->load();
+        });
+        if (!cancelled->load()) post(true);
+    });
+}
+
+void NativeFileModel::onListed(quint32 slot, quint64 serial, quint64 generation,
+                               const std::shared_ptr<NameBatch> &batch, bool last) {
+    Listing *listing = listingAt(slot);
+    if (!listing || listing->serial != serial || listing->generation != generation) return;
+
+    if (!listing->rescanning) {
+        appendEntries(listing, *batch);
+    } else {
+        // 与现有内容比较：消失的行删除，新出现的追加在末尾，其余保持原位
+        QSet<QString> present;
+        present.reserve(int(batch->names.size()));
+        for (const QString &name : batch->names) present.insert(name);
+        std::vector<quint32> removed;
+        std::vector<quint32> kept;
+        for (const quint32 id : listing->order) {
+            (present.contains(listing->names[id]) ? kept : removed).push_back(id);
+        }
+        NameBatch added;
+        for (size_t i = 0; i < batch->names.size(); ++i) {
+            if (listing->idOfName.contains(batch->names[i])) continue;
+            added.names.push_back(batch->names[i]);
+            added.keys.push_back(batch->keys[i]);
+            added.types.push_back(batch->types[i]);
+        }
+        removeEntries(listing, removed);
+        if (listing->restatAll && m_lazyAttributes) {
+            // 旧值先留着显示，视图重绘时为可见的行重新查询
+            for (const quint32 id : kept) listing->flags[id] |= Stale;
+            if (!kept.empty()) {
+                const QModelIndex parent = parentIndex(listing);
+                emit dataChanged(index(0, 0, parent), index(int(kept.size()) - 1, kColumns - 1, parent));
+            }
+        } else if (listing->restatAll) {
+            scheduleStats(listing, kept, StatPurpose::Load);
+        }
+        appendEntries(listing, added);
+    }
+
+    if (last) {
+        listing->enumerating = false;
+        finishIfDone(listing);
+    }
+}
+
+void NativeFileModel::scheduleStats(Listing *listing, const std::vector<quint32> &ids, StatPurpose purpose) {
+    const QByteArray dir = QFile::encodeName(listing->path);
+    const quint32 slot = listing->slot;
+    const quint64 serial = listing->serial;
+    const quint64 generation = listing->generation;
+    const std::shared_ptr<std::atomic_bool> cancelled = listing->cancel;
+    for (size_t begin = 0; begin < ids.size(); begin += kStatChunk) {
+        const size_t end = std::min(begin + kStatChunk, ids.size());
+        const std::vector<quint32> chunk(ids.begin() + begin, ids.begin() + end);
+        std::vector<QByteArray> names;
+        names.reserve(chunk.size());
+        for (const quint32 id : chunk) {
+            names.push_back(QFile::encodeName(listing->names[id]));
+            listing->flags[id] |= Queued;
+        }
+        if (purpose == StatPurpose::Load) ++listing->pendingStats;
+        if (purpose == StatPurpose::Bulk) ++listing->bulkPending;
+        // 各批在线程池中并行查询，同一批共用一个目录句柄
+        m_pool.start([this, dir, names, chunk, slot, serial, generation, purpose, cancelled]() {
+            if (cancelled->load()) return;
+            std::vector<FileAttributes> attributes;
+            DirectoryReader::statBatch(dir, names, attributes);
+            QMetaObject::invokeMethod(this, [this, slot, serial, generation, purpose, chunk, attributes]() {
+                onStatted(slot, serial, generation, purpose, chunk, attributes);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void NativeFileModel::onStatted(quint32 slot, quint64 serial, quint64 generation, StatPurpose purpose,
+                                const std::vector<quint32> &ids, const std::vector<FileAttributes> &attributes) {
+    Listing *listing = listingAt(slot);
+    if (!listing || listing->serial != serial || listing->generation != generation) return;
+
+    // 只通知属性确有变化的行（重新读取目录后大多数条目不变）
+    quint32 firstRow = UINT_MAX;
+    quint32 lastRow = 0;
+    bool orderChanged = false;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        const quint32 id = ids[i];
+        const quint8 old = listing->flags[id];
+        if (old & Removed) continue;
+        const qint64 oldSize = listing->sizes[id];
+        const qint64 oldTime = listing->mtimes[id];
+        quint8 flags = TypeKnown | Statted;
+        if (attributes[i].valid) {
+            if (attributes[i].isDir) flags |= IsDir;
+            listing->sizes[id] = attributes[i].size;
+            listing->mtimes[id] = attributes[i].mtimeNs;
+        } else if (old & TypeKnown) {
+            // 查询失败（如悬空的符号链接）时保留 d_type 的结果
+            flags |= old & IsDir;
+        }
+        listing->flags[id] = flags;
+        // 已排好的行的排序依据变了，下次排序需要整体重排
+        if (listing->rowOf[id] < listing->sortedCount
+            && ((old ^ flags) & IsDir
+                || (listing->sortedColumn == 1 && listing->sizes[id] != oldSize)
+                || (listing->sortedColumn == 3 && listing->mtimes[id] != oldTime))) {
+            orderChanged = true;
+        }
+        if ((old & ~(Queued | Stale)) == flags && listing->sizes[id] == oldSize && listing->mtimes[id] == oldTime) continue;
+        firstRow = std::min(firstRow, listing->rowOf[id]);
+        lastRow = std::max(lastRow, listing->rowOf[id]);
+    }
+    if (orderChanged) listing->sortedCount = 0;
+    if (firstRow <= lastRow) {
+        const QModelIndex parent = parentIndex(listing);
+        emit dataChanged(index(int(firstRow), 0, parent), index(int(lastRow), kColumns - 1, parent));
+    }
+
+    switch (purpose) {
+    case StatPurpose::Load:
+        --listing->pendingStats;
+        finishIfDone(listing);
+        break;
+    case StatPurpose::Bulk:
+        listing->bulkDone += int(ids.size());
+        if (--listing->bulkPending > 0) {
+            emit attributeProgress(listing->path, listing->bulkDone, listing->bulkTotal);
+        } else {
+            // 属性齐了，按当前设置重排
+            sortListings({listing});
+            emit attributeProgress(listing->path, listing->bulkTotal, listing->bulkTotal);
+        }
+        break;
+    case StatPurpose::Visible:
+        break;
+    }
+}
+
+void NativeFileModel::finishIfDone(Listing *listing) {
+    if (listing->enumerating || listing->pendingStats > 0) return;
+    if (attributesReadyForSort(listing)) sortListings({listing});
+    emit directoryLoaded(listing->path);
+}
+
+void NativeFileModel::requestAttributes(Listing *listing, int row) const {
+    const int first = qMax(0, row - kAttributePrefetch);
+    const int last = qMin(int(listing->order.size()) - 1, row + kAttributePrefetch);
+    std::vector<quint32> *queue = nullptr;
+    for (int r = first; r <= last; ++r) {
+        const quint32 id = listing->order[r];
+        quint8 &flags = listing->flags[id];
+        if ((flags & Queued) || ((flags & Statted) && !(flags & Stale))) continue;
+        // 先标记，避免同一轮绘制中其它行重复加入
+        flags |= Queued;
+        if (!queue) queue = &m_requestedAttributes[listing->slot];
+        queue->push_back(id);
+    }
+    if (queue && !m_requestTimer->isActive()) m_requestTimer->start();
+}
+
+void NativeFileModel::flushAttributeRequests() {
+    QHash<quint32, std::vector<quint32>> requests;
+    requests.swap(m_requestedAttributes);
+    for (auto it = requests.cbegin(); it != requests.cend(); ++it) {
+        if (Listing *listing = listingAt(it.key())) scheduleStats(listing, it.value(), StatPurpose::Visible);
+    }
+}
+
+bool NativeFileModel::attributesReadyForSort(Listing *listing) {
+    if (m_sortColumn != 1 && m_sortColumn != 3) return true;
+    // 正在批量查询：完成后会按当时的设置重排
+    if (listing->bulkPending > 0) return false;
+    std::vector<quint32> missing;
+    for (const quint32 id : listing->order) {
+        const quint8 flags = listing->flags[id];
+        if (!(flags & Statted) || (flags & Stale)) missing.push_back(id);
+    }
+    if (missing.empty()) return true;
+    listing->bulkDone = 0;
+    listing->bulkTotal = int(missing.size());
+    scheduleStats(listing, missing, StatPurpose::Bulk);
+    emit attributeProgress(listing->path, 0, listing->bulkTotal);
+    return false;
+}
+
+void NativeFileModel::sort(int column, Qt::SortOrder order) {
+    m_sortColumn = column;
+    m_sortOrder = order;
+    // 只排当前根目录及树形视图中展开的子目录；其它保留的目录在再次成为根时（视图会重新排序）再排。
+    // 仍在读取的目录在读完时按新的设置排序；缺少属性的目录先在后台查询，完成后再排
+    const QString prefix = m_rootPath.endsWith('/') ? m_rootPath : m_rootPath + '/';
+    std::vector<Listing *> ready;
+    for (size_t slot = 1; slot < m_listings.size(); ++slot) {
+        Listing *listing = m_listings[slot].get();
+        if (!listing || (listing->path != m_rootPath && !listing->path.startsWith(prefix))) continue;
+        if (listing->started && !listing->enumerating && listing->pendingStats == 0
+            && attributesReadyForSort(listing)) {
+            ready.push_back(listing);
+        }
+    }
+    sortListings(ready);
+}
+
+// 目录总在文件之前；比较结果相同时按名称的排序键。只重排行号映射，条目数组不动。
+// 排序设置未变时只把之后追加的行归并进已排好的部分，没有新行的目录不发出布局变化
+void NativeFileModel::sortListings(const std::vector<Listing *> &listings) {
+    std::vector<Listing *> pending;
+    for (Listing *listing : listings) {
+        if (listing->sortedColumn != m_sortColumn || listing->sortedOrder != m_sortOrder) {
+            listing->sortedColumn = m_sortColumn;
+            listing->sortedOrder = m_sortOrder;
+            listing->sortedCount = 0;
+        }
+        if (listing->sortedCount < listing->order.size()) pending.push_back(listing);
+    }
+    if (pending.empty()) return;
+
+    QList<QPersistentModelIndex> parents;
+    for (const Listing *listing : pending) parents.append(parentIndex(listing));
+    emit layoutAboutToBeChanged(parents, QAbstractItemModel::VerticalSortHint);
+
+    const QModelIndexList from = persistentIndexList();
+    for (Listing *listing : pending) {
+        // 按类型排序时先把各种类型文字排好，比较时只比较名次
+        std::vector<int> typeRanks;
+        if (m_sortColumn == 2) {
+            QHash<QString, int> rankOf;
+            for (const quint32 id : listing->order) rankOf.insert(typeLabel(listing->names[id], listing->flags[id] & IsDir), 0);
+            QStringList labels = rankOf.keys();
+            std::sort(labels.begin(), labels.end(), [this](const QString &a, const QString &b) {
+                return m_collator.compare(a, b) < 0;
+            });
+            for (int i = 0; i < labels.size(); ++i) rankOf[labels[i]] = i;
+            typeRanks.resize(listing->names.size());
+            for (const quint32 id : listing->order) typeRanks[id] = rankOf.value(typeLabel(listing->names[id], listing->flags[id] & IsDir));
+        }
+        // 比较函数会在多个线程中同时调用，只读取条目数组
+        const Listing &l = *listing;
+        const int column = m_sortColumn;
+        const bool ascending = m_sortOrder == Qt::AscendingOrder;
+        ParallelSort::sort(listing->order, [&l, &typeRanks, column, ascending](quint32 a, quint32 b) {
+            const bool dirA = l.flags[a] & IsDir;
+            const bool dirB = l.flags[b] & IsDir;
+            if (dirA != dirB) return dirA;
+            int cmp = 0;
+            switch (column) {
+            case 1:
+                if (!dirA) cmp = (l.sizes[a] > l.sizes[b]) - (l.sizes[a] < l.sizes[b]);
+                break;
+            case 2:
+                cmp = typeRanks[a] - typeRanks[b];
+                break;
+            case 3:
+                cmp = (l.mtimes[a] > l.mtimes[b]) - (l.mtimes[a] < l.mtimes[b]);
+                break;
+            default:
+                break;
+            }
+            if (cmp == 0) cmp = l.keys[a].compare(l.keys[b]);
+            return ascending ? cmp < 0 : cmp > 0;
+        }, listing->sortedCount);
+        listing->sortedCount = listing->order.size();
+        for (size_t row = 0; row < listing->order.size(); ++row) listing->rowOf[listing->order[row]] = quint32(row);
+    }
+
+    QModelIndexList to;
+    to.reserve(from.size());
+    for (const QModelIndex &index : from) {
+        const Listing *listing = listingAt(slotOf(index.internalId()));
+        to.append(listing ? createIndex(int(listing->rowOf[entryOf(index.internalId())]), index.column(), index.internalId())
+                          : index);
+    }
+    changePersistentIndexList(from, to);
+    emit layoutChanged(parents, QAbstractItemModel::VerticalSortHint);
+}
@@ -0,0 +1,186 @@
+#ifndef NATIVEFILEMODEL_H
+#define NATIVEFILEMODEL_H
+
+#include "DirectoryReader.h"
+#include "FileModel.h"
+
+#include <QAbstractItemModel>
+#include <QCollator>
+#include <QHash>
+#include <QIcon>
+#include <QLocale>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QFileSystemWatcher;
+class QTimer;
+
+// 自己读取目录的文件模型，可以替代 QFileSystemModel（配置项 view/nativeModel）。
+// 名称用大缓冲区的 getdents64 读取，目录/文件类型尽量取自 d_type；
+// 大小和修改时间由线程池分批 statx，只请求这几个字段。
+// 每个目录的条目按列存放（名称、排序键、标志、大小、时间各一个数组），排序只重排行号到条目编号的映射。
+// 名称的排序键（QCollator::sortKey，默认按中文拼音顺序）在读取目录的后台线程中生成，排序时只比较排序键，
+// 大目录分段并行排序后归并；排好的顺序一直保留，重新读取后只把新增的条目归并进去。
+// 顶层的每一行是一个曾作为视图根的目录（相当于 QFileSystemModel 保留的旧节点），视图以其中一行为根，
+// 因此三个视图和筛选代理的用法与 QFileSystemModel 相同。
+// 延迟属性模式下读完名称即算加载完成，大小和修改时间只为视图实际绘制的行（及其前后的预取区）查询，
+// 按大小或日期排序时才在后台查询整个目录，完成后再重排；网络目录的打开时间因此只与屏幕上的行数有关
+class NativeFileModel : public QAbstractItemModel, public FileModel {
+    Q_OBJECT
+public:
+    explicit NativeFileModel(QObject *parent = nullptr);
+    ~NativeFileModel() override;
+
+    QAbstractItemModel *itemModel() override { return this; }
+    QModelIndex indexForPath(const QString &path) const override;
+    QString filePath(const QModelIndex &index) const override;
+    QFileInfo fileInfo(const QModelIndex &index) const override;
+    QIcon fileIcon(const QModelIndex &index) const override;
+    void setRootPath(const QString &path) override;
+    void setIconProvider(QFileIconProvider *provider) override;
+    void setThumbnailProvider(const ThumbnailIconProvider *provider) override { m_thumbnails = provider; }
+    void thumbnailUpdated(const QString &filePath) override;
+    void setTrustedListing(const QString &path) override;
+    void onDirectoryLoaded(QObject *context, const std::function<void(const QString &)> &slot) override;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // 开启后只为显示到的行查询大小和修改时间（配置项 view/lazyAttributes）
+    void setLazyAttributes(bool lazy) { m_lazyAttributes = lazy; }
+    // 名称排序使用的区域设置（配置项 view/collationLocale），需在设置根目录之前调用
+    void setCollationLocale(const QLocale &locale);
+
+signals:
+    // 目录的名称（非延迟模式下还有属性）都已读完（相当于 QFileSystemModel::directoryLoaded）
+    void directoryLoaded(const QString &path);
+    // 为排序在后台查询整个目录的属性：done == total 表示完成并已重排
+    void attributeProgress(const QString &path, int done, int total);
+
+private:
+    enum EntryFlag : quint8 {
+        IsDir = 0x01,      // 目录（符号链接按目标判断）
+        TypeKnown = 0x02,  // 已知是否为目录（来自 d_type 或 statx）
+        Statted = 0x04,    // 大小和修改时间已取得
+        Removed = 0x08,    // 已从目录中消失，编号在下次重新读取后复用
+        Queued = 0x10,     // 已提交查询，结果尚未返回
+        Stale = 0x20,      // 重新读取目录后属性待更新，更新前仍显示旧值
+    };
+
+    // 属性查询的用途：加载时的查询决定何时算加载完成，排序前的批量查询完成后重排
+    enum class StatPurpose { Load, Visible, Bulk };
+
+    // 一个目录的内容。条目编号在目录内固定不变，行号随排序变化
+    struct Listing {
+        QString path;
+        quint32 slot {0};
+        quint64 serial {0};       // 槽位复用后区分新旧目录，丢弃投递给旧目录的结果
+        quint32 parentSlot {0};
+        quint32 parentEntry {0};  // 在父目录中的条目编号
+        std::vector<QString> names;
+        std::vector<QCollatorSortKey> keys;
+        std::vector<quint8> flags;
+        std::vector<qint64> sizes;
+        std::vector<qint64> mtimes;  // 纳秒
+        std::vector<quint32> order;  // 行号 -> 条目编号
+        std::vector<quint32> rowOf;  // 条目编号 -> 行号（已删除的条目无意义）
+        QHash<QString, quint32> idOfName;
+        QHash<quint32, quint32> children;  // 条目编号 -> 子目录所在槽位
+        // 已删除条目的编号。前 reusableIds 个在之后又开始过新一轮读取，不会再收到投递给旧条目的结果，可以复用
+        std::vector<quint32> freeIds;
+        size_t reusableIds {0};
+        std::shared_ptr<std::atomic_bool> cancel;
+        quint64 generation {0};  // 每次重新读取加一
+        bool started {false};
+        bool enumerating {false};
+        bool rescanning {false};  // 已有内容，本次读取的结果与之比较增删
+        bool restatAll {false};   // 重新读取时是否也重新查询仍存在的条目的属性
+        int pendingStats {0};
+        int bulkPending {0};  // 排序前批量查询尚未返回的任务数
+        int bulkDone {0};
+        int bulkTotal {0};
+        // order 的前 sortedCount 行已按 sortedColumn/sortedOrder 排好，之后追加的行尚未排序
+        int sortedColumn {-1};
+        Qt::SortOrder sortedOrder {Qt::AscendingOrder};
+        size_t sortedCount {0};
+    };
+
+    // 后台读取到的一批名称
+    struct NameBatch {
+        std::vector<QString> names;
+        std::vector<QCollatorSortKey> keys;
+        std::vector<quint8> types;  // EntryType
+    };
+
+    Listing *listingAt(quint32 slot) const;
+    Listing *childListing(const QModelIndex &parent) const;
+    Listing *createListing(Listing *parent, quint32 entry);
+    void freeListing(quint32 slot);
+    QModelIndex parentIndex(const Listing *listing) const;
+    QString entryPath(const Listing &listing, quint32 id) const;
+    QIcon entryIcon(const Listing &listing, quint32 id) const;
+    QString typeLabel(const QString &name, bool isDir) const;
+
+    static QCollator makeCollator(const QLocale &locale);
+    quint32 pushEntry(Listing *listing, const QString &name, const QCollatorSortKey &key, quint8 flags);
+    void appendEntries(Listing *listing, const NameBatch &batch);
+    void removeEntries(Listing *listing, const std::vector<quint32> &ids);
+
+    // 在后台（重新）读取目录；已有内容时与新结果比较，只增删变化的行
+    void startListing(Listing *listing, bool restatAll = true);
+    void onListed(quint32 slot, quint64 serial, quint64 generation, const std::shared_ptr<NameBatch> &batch, bool last);
+    void scheduleStats(Listing *listing, const std::vector<quint32> &ids, StatPurpose purpose);
+    void onStatted(quint32 slot, quint64 serial, quint64 generation, StatPurpose purpose,
+                   const std::vector<quint32> &ids, const std::vector<FileAttributes> &attributes);
+    void finishIfDone(Listing *listing);
+    // 在 data() 中调用：把该行及前后预取区内尚无属性的条目加入待查询队列
+    void requestAttributes(Listing *listing, int row) const;
+    void flushAttributeRequests();
+    // 按大小或日期排序且有条目缺少属性时先批量查询，返回 false 表示稍后再排序
+    bool attributesReadyForSort(Listing *listing);
+
+    void sortListings(const std::vector<Listing *> &listings);
+    void evictRoots();
+
+    std::vector<std::unique_ptr<Listing>> m_listings;  // 槽位 0 是虚拟顶层，其条目为各个根目录
+    std::vector<quint32> m_freeSlots;
+    quint64 m_nextSerial {0};
+    QHash<QString, quint32> m_slotByPath;
+    QStringList m_rootLru;  // 最近作为根的目录在末尾
+    QString m_rootPath;
+    QString m_trustedListing;
+
+    int m_sortColumn {0};
+    Qt::SortOrder m_sortOrder {Qt::AscendingOrder};
+    QLocale m_collationLocale;
+    QCollator m_collator;  // 界面线程使用；后台线程各自创建
+
+    QFileIconProvider *m_iconProvider {nullptr};
+    const ThumbnailIconProvider *m_thumbnails {nullptr};
+    mutable QHash<QString, QIcon> m_suffixIcons;
+    mutable QIcon m_folderIcon;
+    mutable QHash<QString, QString> m_typeLabels;
+
+    QFileSystemWatcher *m_watcher {nullptr};
+    QTimer *m_rescanTimer {nullptr};
+
+    bool m_lazyAttributes {false};
+    mutable QHash<quint32, std::vector<quint32>> m_requestedAttributes;  // 槽位 -> 待查询的条目
+    QTimer *m_requestTimer {nullptr};
+    QThreadPool m_pool;
+};
+
+#endif // NATIVEFILEMODEL_H
@@ -0,0 +1,368 @@
+#include "OfficeConversionCache.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <sys/stat.h>
+#endif
+
+namespace {
+// 索引格式变化时递增，旧索引连同其条目一起丢弃
+const char *kIndexHeader = "OFFICECACHE 1";
+// 只有最近使用时间变化时，至少间隔这么久才重写索引
+constexpr qint64 kTouchSaveIntervalSecs = 300;
+// 超过这么久的临时输出视为遗留（如取消后常驻进程才写完的文件），维护时删除
+constexpr qint64 kStalePartialSecs = 3600;
+
+// XXH64（种子 0），逐块输入整个文件
+class Xxh64 {
+public:
+    void update(const char *data, size_t length) {
+        const auto *p = reinterpret_cast<const unsigned char *>(data);
+        const unsigned char *const end = p + length;
+        m_total += length;
+        if (m_buffered + length < 32) {
+            std::memcpy(m_buffer + m_buffered, p, length);
+            m_buffered += length;
+            return;
+        }
+        if (m_buffered > 0) {
+            const size_t fill = 32 - m_buffered;
+            std::memcpy(m_buffer + m_buffered, p, fill);
+            consume(m_buffer);
+            p += fill;
+            m_buffered = 0;
+        }
+        for (; p + 32 <= end; p += 32) consume(p);
+        m_buffered = size_t(end - p);
+        std::memcpy(m_buffer, p, m_buffered);
+    }
+
+    quint64 digest() const {
+        quint64 h;
+        if (m_total >= 32) {
+            h = rotl(m_v[0], 1) + rotl(m_v[1], 7) + rotl(m_v[2], 12) + rotl(m_v[3], 18);
+            for (const quint64 v : m_v) h = (h ^ round(0, v)) * kPrime1 + kPrime4;
+        } else {
+            h = kPrime5;
+        }
+        h += m_total;
+        const unsigned char *p = m_buffer;
+        const unsigned char *const end = m_buffer + m_buffered;
+        for (; p + 8 <= end; p += 8) h = rotl(h ^ round(0, read64(p)), 27) * kPrime1 + kPrime4;
+        if (p + 4 <= end) {
+            h = rotl(h ^ (quint64(read32(p)) * kPrime1), 23) * kPrime2 + kPrime3;
+            p += 4;
+        }
+        for (; p < end; ++p) h = rotl(h ^ (*p * kPrime5), 11) * kPrime1;
+        h ^= h >> 33;
+        h *= kPrime2;
+        h ^= h >> 29;
+        h *= kPrime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    static constexpr quint64 kPrime1 = 11400714785074694791ULL;
+    static constexpr quint64 kPrime2 = 14029467366897019727ULL;
+    static constexpr quint64 kPrime3 = 1609587929392839161ULL;
+    static constexpr quint64 kPrime4 = 9650029242287828579ULL;
+    static constexpr quint64 kPrime5 = 2870177450012600261ULL;
+
+    static quint64 rotl(quint64 x, int r) { return (x << r) | (x >> (64 - r)); }
+    static quint64 round(quint64 acc, quint64 input) { return rotl(acc + input * kPrime2, 31) * kPrime1; }
+    static quint64 read64(const unsigned char *p) {
+        quint64 v = 0;
+        for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+        return v;
+    }
+    static quint32 read32(const unsigned char *p) {
+        return quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24);
+    }
+
+    void consume(const unsigned char *p) {
+        for (int i = 0; i < 4; ++i) m_v[i] = round(m_v[i], read64(p + 8 * i));
+    }
+
+    quint64 m_v[4] {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+    unsigned char m_buffer[32] {};
+    size_t m_buffered {0};
+    quint64 m_total {0};
+};
+
+struct Entry {
+    qint64 bytes {0};
+    qint64 lastUsed {0};  // 秒
+};
+
+// 全部缓存状态，由 mutex 保护
+struct CacheState {
+    QMutex mutex;
+    bool loaded {false};
+    QHash<QString, Entry> entries;        // 内容键 -> 条目
+    QHash<QString, QString> identities;   // 文件标识 -> 内容键
+    qint64 totalBytes {0};
+    qint64 budget {0};
+    bool maintenanceQueued {false};
+    qint64 lastSave {0};
+    QMutex saveMutex;  // 依次保存索引，后取的快照后写入
+};
+
+CacheState &cacheState() {
+    static CacheState state;
+    return state;
+}
+
+QString indexPath() {
+    return OfficeConversionCache::directory() + "/index";
+}
+
+QString partialDirectory() {
+    return OfficeConversionCache::directory() + "/partial";
+}
+
+void removeStalePartials() {
+    const QDateTime cutoff = QDateTime::currentDateTime().addSecs(-kStalePartialSecs);
+    const QFileInfoList files = QDir(partialDirectory()).entryInfoList(QDir::Files);
+    for (const QFileInfo &fi : files) {
+        if (fi.lastModified() < cutoff) QFile::remove(fi.absoluteFilePath());
+    }
+}
+
+// 文件内容未变时不变的标识，用于跳过重复计算内容键
+QString fileIdentity(const QString &filePath) {
+#ifdef Q_OS_LINUX
+    struct stat st;
+    if (::stat(QFile::encodeName(filePath).constData(), &st) != 0 || !S_ISREG(st.st_mode)) return QString();
+    return QString("%1:%2:%3:%4")
+        .arg(quint64(st.st_dev))
+        .arg(quint64(st.st_ino))
+        .arg(qint64(st.st_size))
+        .arg(qint64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec);
+#else
+    const QFileInfo fi(filePath);
+    if (!fi.isFile()) return QString();
+    return QString("%1:%2:%3").arg(fi.canonicalFilePath()).arg(fi.size()).arg(fi.lastModified().toMSecsSinceEpoch());
+#endif
+}
+
+// 在持有锁时调用
+void ensureLoaded(CacheState &state) {
+    if (state.loaded) return;
+    state.loaded = true;
+    state.budget = QSettings().value("office/cacheMegabytes", 1024).toLongLong() * 1024 * 1024;
+
+    QFile file(indexPath());
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        // 没有索引：目录中是按路径命名的旧缓存，无法按内容复用，全部删除
+        QDir dir(OfficeConversionCache::directory());
+        for (const QString &name : dir.entryList({"*.pdf"}, QDir::Files)) dir.remove(name);
+        return;
+    }
+    QTextStream in(&file);
+    if (in.readLine() != QLatin1String(kIndexHeader)) return;
+    while (!in.atEnd()) {
+        const QStringList fields = in.readLine().split('\t');
+        if (fields.size() == 4 && fields[0] == "E") {
+            Entry entry;
+            entry.bytes = fields[2].toLongLong();
+            entry.lastUsed = fields[3].toLongLong();
+            state.entries.insert(fields[1], entry);
+            state.totalBytes += entry.bytes;
+        } else if (fields.size() == 3 && fields[0] == "I") {
+            state.identities.insert(fields[2], fields[1]);
+        }
+    }
+}
+
+void writeIndex(const QHash<QString, Entry> &entries, const QHash<QString, QString> &identities) {
+    QSaveFile file(indexPath());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+    QTextStream out(&file);
+    out << kIndexHeader << '\n';
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        out << "E\t" << it.key() << '\t' << it->bytes << '\t' << it->lastUsed << '\n';
+    }
+    // 标识放在最后一列，其中可能含有制表符以外的任意字符
+    for (auto it = identities.constBegin(); it != identities.constEnd(); ++it) {
+        out << "I\t" << it.value() << '\t' << it.key() << '\n';
+    }
+    out.flush();
+    file.commit();
+}
+
+// 后台淘汰超出容量的条目并保存索引
+void runMaintenance() {
+    CacheState &state = cacheState();
+    QMutexLocker saveLocker(&state.saveMutex);
+    QStringList victims;
+    QHash<QString, Entry> entries;
+    QHash<QString, QString> identities;
+    {
+        QMutexLocker locker(&state.mutex);
+        state.maintenanceQueued = false;
+        if (state.totalBytes > state.budget) {
+            std::vector<std::pair<qint64, QString>> byAge;
+            byAge.reserve(size_t(state.entries.size()));
+            for (auto it = state.entries.constBegin(); it != state.entries.constEnd(); ++it) {
+                byAge.emplace_back(it->lastUsed, it.key());
+            }
+            std::sort(byAge.begin(), byAge.end());
+            for (const auto &item : byAge) {
+                if (state.totalBytes <= state.budget) break;
+                state.totalBytes -= state.entries.take(item.second).bytes;
+                victims.append(item.second);
+            }
+        }
+        // 只保留仍有转换结果的文件标识
+        for (auto it = state.identities.begin(); it != state.identities.end();) {
+            if (state.entries.contains(it.value())) {
+                ++it;
+            } else {
+                it = state.identities.erase(it);
+            }
+        }
+        state.lastSave = QDateTime::currentSecsSinceEpoch();
+        entries = state.entries;
+        identities = state.identities;
+    }
+    for (const QString &key : victims) QFile::remove(OfficeConversionCache::entryPath(key));
+    writeIndex(entries, identities);
+    removeStalePartials();
+}
+
+// 在持有锁时调用
+void queueMaintenance(CacheState &state) {
+    if (state.maintenanceQueued) return;
+    state.maintenanceQueued = true;
+    QtConcurrent::run(runMaintenance);
+}
+}
+
+QString OfficeConversionCache::directory() {
+    static const QString dir = [] {
+        const QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/office_cache";
+        QDir().mkpath(path);
+        return path;
+    }();
+    return dir;
+}
+
+QString OfficeConversionCache::contentKey(const QString &filePath) {
+    CacheState &state = cacheState();
+    const QString identity = fileIdentity(filePath);
+    if (identity.isEmpty()) return QString();
+    {
+        QMutexLocker locker(&state.mutex);
+        ensureLoaded(state);
+        const auto it = state.identities.constFind(identity);
+        if (it != state.identities.constEnd()) return it.value();
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return QString();
+    Xxh64 hash;
+    std::vector<char> buffer(1024 * 1024);
+    for (;;) {
+        const qint64 n = file.read(buffer.data(), qint64(buffer.size()));
+        if (n < 0) return QString();
+        if (n == 0) break;
+        hash.update(buffer.data(), size_t(n));
+    }
+    const QString key = QString("%1-%2").arg(hash.digest(), 16, 16, QLatin1Char('0')).arg(file.size());
+
+    QMutexLocker locker(&state.mutex);
+    state.identities.insert(identity, key);
+    return key;
+}
+
+QString OfficeConversionCache::entryPath(const QString &key) {
+    return directory() + "/" + key + ".pdf";
+}
+
+QString OfficeConversionCache::lookup(const QString &key) {
+    CacheState &state = cacheState();
+    QMutexLocker locker(&state.mutex);
+    ensureLoaded(state);
+    auto it = state.entries.find(key);
+    if (it == state.entries.end()) return QString();
+    const QString path = entryPath(key);
+    if (!QFile::exists(path)) {
+        // 被外部删除
+        state.totalBytes -= it->bytes;
+        state.entries.erase(it);
+        return QString();
+    }
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    it->lastUsed = now;
+    if (now - state.lastSave >= kTouchSaveIntervalSecs) queueMaintenance(state);
+    return path;
+}
+
+void OfficeConversionCache::insert(const QString &key) {
+    const qint64 bytes = QFileInfo(entryPath(key)).size();
+    CacheState &state = cacheState();
+    QMutexLocker locker(&state.mutex);
+    ensureLoaded(state);
+    Entry &entry = state.entries[key];
+    state.totalBytes += bytes - entry.bytes;
+    entry.bytes = bytes;
+    entry.lastUsed = QDateTime::currentSecsSinceEpoch();
+    queueMaintenance(state);
+}
+
+QString OfficeConversionCache::temporaryPath(const QString &key) {
+    static std::atomic<quint64> counter {0};
+    QDir().mkpath(partialDirectory());
+    return QString("%1/%2-%3-%4.pdf").arg(partialDirectory(), key)
+        .arg(QCoreApplication::applicationPid()).arg(++counter);
+}
+
+bool OfficeConversionCache::commit(const QString &path, const QString &key) {
+    const QString target = entryPath(key);
+#ifdef Q_OS_LINUX
+    // rename 原子地替换目标处的文件（可能是之前中断的转换留下的），读取方不会看到不完整的文件
+    const bool moved = std::rename(QFile::encodeName(path).constData(), QFile::encodeName(target).constData()) == 0;
+#else
+    QFile::remove(target);
+    const bool moved = QFile::rename(path, target);
+#endif
+    if (!moved) {
+        QFile::remove(path);
+        return false;
+    }
+    insert(key);
+    return true;
+}
+
+void OfficeConversionCache::clear() {
+    CacheState &state = cacheState();
+    QMutexLocker locker(&state.mutex);
+    state.entries.clear();
+    state.identities.clear();
+    state.totalBytes = 0;
+    state.loaded = true;
+    QDir dir(directory());
+    dir.removeRecursively();
+    dir.mkpath(".");
+    writeIndex(state.entries, state.identities);
+}
@@ -0,0 +1,32 @@
+#ifndef OFFICECONVERSIONCACHE_H
+#define OFFICECONVERSIONCACHE_H
+
+#include <QString>
+
+// 办公文档转换结果（PDF）的磁盘缓存：AppDataLocation/office_cache 下以文件内容的 XXH64 命名。
+// 改名、复制或移动文件都不需要重新转换，内容不同的文件也不会误用旧结果。
+// (设备, inode, 大小, 修改时间) 与上次相同时直接使用记录的内容键，不再读取文件。
+// 索引文件记录各条目的大小和最近使用时间，查询不需要扫描目录；
+// 总大小超过 office/cacheMegabytes 时在后台线程按最近使用时间淘汰。可在任意线程调用
+class OfficeConversionCache {
+public:
+    // 缓存目录
+    static QString directory();
+    // 文件的内容键；无法读取时返回空字符串。首次遇到的文件需要读取全部内容，不应在界面线程调用
+    static QString contentKey(const QString &filePath);
+    // 该内容键的转换结果路径（不论是否已存在）
+    static QString entryPath(const QString &key);
+    // 已有转换结果时返回其路径并更新最近使用时间，否则返回空字符串
+    static QString lookup(const QString &key);
+    // 登记 entryPath(key) 处新生成的转换结果，超出容量时在后台淘汰
+    static void insert(const QString &key);
+    // 一次转换的临时输出文件（缓存目录的 partial 子目录中，每次调用的文件名都不同）。
+    // 转换成功后用 commit() 移为转换结果，失败时删除；遗留的临时文件在后台维护时清理
+    static QString temporaryPath(const QString &key);
+    // 把转换成功生成的 path 移为 key 的转换结果（替换已有的文件）并登记
+    static bool commit(const QString &path, const QString &key);
+    // 删除全部缓存
+    static void clear();
+};
+
+#endif // OFFICECONVERSIONCACHE_H
@@ -0,0 +1,300 @@
+#include "OfficeConversionService.h"
+#include "OfficeConversionCache.h"
+#include "OfficeDaemonPool.h"
+
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QProcess>
+#include <QSettings>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+OfficeConversionService::OfficeConversionService(QObject *parent) : QObject(parent) {
+    setMaxConcurrent(QSettings().value("office/maxConversions", 2).toInt());
+    m_daemons = new OfficeDaemonPool(this);
+    connect(m_daemons, &OfficeDaemonPool::daemonReady, this, &OfficeConversionService::onDaemonReady);
+    connect(m_daemons, &OfficeDaemonPool::daemonFailed, this, &OfficeConversionService::onDaemonFailed);
+}
+
+OfficeConversionService::~OfficeConversionService() {
+    // 不再报告结果，子对象析构时终止仍在运行的转换进程
+    for (RunningJob &running : m_running) {
+        if (!running.process) continue;
+        running.process->disconnect(this);
+        OfficeConverter::killProcessGroup(running.process);
+        OfficeConverter::discardOutput(running.plan);
+    }
+}
+
+void OfficeConversionService::setMaxConcurrent(int count) {
+    m_maxConcurrent = std::max(1, count);
+    scheduleDispatch();
+}
+
+quint64 OfficeConversionService::convert(const QString &inputPath, Priority priority) {
+    const QString path = QFileInfo(inputPath).absoluteFilePath();
+    if (priority == Priority::Interactive) {
+        for (Job &job : m_queue) {
+            if (job.priority == Priority::Interactive && job.inputPath != path) job.priority = Priority::Normal;
+        }
+    }
+    for (const RunningJob &running : m_running) {
+        if (running.job.inputPath == path) return running.job.id;
+    }
+    for (Job &job : m_queue) {
+        if (job.inputPath != path) continue;
+        job.priority = std::max(job.priority, priority);
+        return job.id;
+    }
+
+    Job job;
+    job.id = ++m_nextId;
+    job.inputPath = path;
+    job.priority = priority;
+    m_queue.append(job);
+    scheduleDispatch();
+    return job.id;
+}
+
+void OfficeConversionService::cancel(quint64 job) {
+    if (m_running.contains(job)) {
+        complete(job, Outcome::Cancelled);
+        return;
+    }
+    for (int i = 0; i < m_queue.size(); ++i) {
+        if (m_queue[i].id != job) continue;
+        const Job removed = m_queue.takeAt(i);
+        emit finished(removed.id, removed.inputPath, false, QString(), tr("转换已取消"));
+        return;
+    }
+}
+
+void OfficeConversionService::cancelAll(Priority priority) {
+    QList<quint64> ids;
+    for (const Job &job : m_queue) {
+        if (job.priority <= priority) ids.append(job.id);
+    }
+    for (const RunningJob &running : m_running) {
+        if (running.job.priority <= priority) ids.append(running.job.id);
+    }
+    for (const quint64 id : ids) cancel(id);
+}
+
+void OfficeConversionService::scheduleDispatch() {
+    // 排到事件循环中执行，convert() 返回编号之前不会发出该任务的 finished
+    if (m_dispatchPending) return;
+    m_dispatchPending = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        m_dispatchPending = false;
+        dispatch();
+    }, Qt::QueuedConnection);
+}
+
+void OfficeConversionService::dispatch() {
+    const int backgroundLimit = std::max(1, m_maxConcurrent - 1);
+    int background = 0;
+    for (const RunningJob &running : m_running) {
+        if (running.job.priority == Priority::Background) ++background;
+    }
+    while (m_running.size() < m_maxConcurrent && !m_queue.isEmpty()) {
+        // 优先级最高的任务中最先提交的
+        int best = 0;
+        for (int i = 1; i < m_queue.size(); ++i) {
+            if (m_queue[i].priority > m_queue[best].priority) best = i;
+        }
+        // 剩下的都是后台任务
+        if (m_queue[best].priority == Priority::Background && background >= backgroundLimit) break;
+        if (m_queue[best].priority == Priority::Background) ++background;
+        start(m_queue.takeAt(best));
+    }
+}
+
+int OfficeConversionService::takeInstance(Priority priority) {
+    if (m_instanceBusy.size() < m_maxConcurrent) m_instanceBusy.resize(m_maxConcurrent);
+    int instance = -1;
+    if (priority == Priority::Background) {
+        // 从最后一个取起，前面的实例及其常驻进程保持正常优先级，留给其它任务
+        for (int i = int(m_instanceBusy.size()) - 1; i >= 0 && instance < 0; --i) {
+            if (!m_instanceBusy[i]) instance = i;
+        }
+    } else {
+        instance = int(m_instanceBusy.indexOf(false));
+    }
+    if (instance < 0) {
+        instance = int(m_instanceBusy.size());
+        m_instanceBusy.append(false);
+    }
+    m_instanceBusy[instance] = true;
+    return instance;
+}
+
+void OfficeConversionService::start(const Job &job) {
+    const int instance = takeInstance(job.priority);
+
+    RunningJob running;
+    running.job = job;
+    running.instance = instance;
+    const quint64 id = job.id;
+
+    // 设定超时，避免卡死的转换进程一直占用名额（准备和等待常驻进程启动的时间也计算在内）
+    running.timeout = new QTimer(this);
+    running.timeout->setSingleShot(true);
+    connect(running.timeout, &QTimer::timeout, this, [this, id]() { complete(id, Outcome::TimedOut); });
+    running.timeout->start(kConversionTimeoutMs);
+    m_running.insert(id, running);
+
+    // 计算缓存键要读取整个文件，检测转换工具要查找 PATH，都在后台线程进行
+    const QString inputPath = job.inputPath;
+    auto *watcher = new QFutureWatcher<Prepared>(this);
+    connect(watcher, &QFutureWatcher<Prepared>::finished, this, [this, watcher, id]() {
+        watcher->deleteLater();
+        onPrepared(id, watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([inputPath, instance]() {
+        Prepared prepared;
+        prepared.ok = OfficeConverter::prepareConversion(inputPath, prepared.plan, prepared.errorMsg, instance);
+        return prepared;
+    }));
+}
+
+void OfficeConversionService::onPrepared(quint64 id, const Prepared &prepared) {
+    auto it = m_running.find(id);
+    if (it == m_running.end()) return;  // 准备期间已取消或超时
+    RunningJob &running = it.value();
+    running.plan = prepared.plan;
+    if (!prepared.ok || prepared.plan.cached) {
+        const RunningJob done = takeRunning(it);
+        emit finished(id, done.job.inputPath, prepared.ok, prepared.ok ? prepared.plan.pdfPath : QString(),
+                      prepared.errorMsg);
+        scheduleDispatch();
+        return;
+    }
+
+    OfficeDaemonPool::State daemonState = OfficeDaemonPool::State::Stopped;
+    if (running.plan.usesLibreOffice && m_daemons->isAvailable()) {
+        daemonState = m_daemons->acquire(running.instance, running.job.priority == Priority::Background);
+        running.viaDaemon = daemonState != OfficeDaemonPool::State::Stopped;
+    }
+    // 常驻进程启动中时等待 daemonReady 或 daemonFailed
+    if (daemonState != OfficeDaemonPool::State::Starting) launch(running);
+}
+
+OfficeConversionService::RunningJob OfficeConversionService::takeRunning(QHash<quint64, RunningJob>::iterator it) {
+    const RunningJob running = it.value();
+    m_running.erase(it);
+    m_instanceBusy[running.instance] = false;
+    running.timeout->deleteLater();
+    return running;
+}
+
+void OfficeConversionService::launch(RunningJob &running) {
+    QString program = running.plan.program;
+    QStringList arguments = running.plan.arguments;
+    if (running.viaDaemon) {
+        // 常驻进程写到单独的临时文件：取消的转换在常驻进程中仍会完成，不能与之后同名文件的转换共用暂存路径
+        running.plan.outputPdf = OfficeConversionCache::temporaryPath(running.plan.cacheKey);
+        m_daemons->clientCommand(running.instance, running.plan.inputPath, running.plan.outputPdf, program, arguments);
+    } else if (running.job.priority == Priority::Background) {
+        OfficeConverter::lowerPriority(program, arguments);
+    }
+
+    const quint64 id = running.job.id;
+    // 直接运行的 soffice 同样会派生 soffice.bin，取消或超时时要连同它一起终止
+    running.process = OfficeConverter::createGroupedProcess(this);
+    if (!running.viaDaemon && !running.plan.environment.isEmpty()) {
+        running.process->setProcessEnvironment(running.plan.environment);
+    }
+    running.process->setProgram(program);
+    running.process->setArguments(arguments);
+    running.process->setProcessChannelMode(QProcess::MergedChannels);
+    connect(running.process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, [this, id]() {
+        complete(id, Outcome::Exited);
+    });
+    connect(running.process, &QProcess::errorOccurred, this, [this, id](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) complete(id, Outcome::FailedToStart);
+    });
+    running.process->start();
+}
+
+void OfficeConversionService::onDaemonReady(int instance) {
+    for (RunningJob &running : m_running) {
+        if (running.instance == instance && running.viaDaemon && !running.process) {
+            launch(running);
+            return;
+        }
+    }
+}
+
+void OfficeConversionService::onDaemonFailed(int instance) {
+    for (RunningJob &running : m_running) {
+        if (running.instance != instance || !running.viaDaemon) continue;
+        // 常驻进程正在重启时继续等待；已停用时还在等待的转换改为直接运行 soffice。
+        // 已提交的转换由客户端报告失败后重试
+        if (!running.process && m_daemons->state(instance) == OfficeDaemonPool::State::Stopped) {
+            running.viaDaemon = false;
+            m_daemons->release(instance);
+            launch(running);
+        }
+        return;
+    }
+}
+
+void OfficeConversionService::complete(quint64 id, Outcome outcome) {
+    auto it = m_running.find(id);
+    if (it == m_running.end()) return;
+    const RunningJob running = takeRunning(it);
+
+    QString output;
+    int exitCode = 0;
+    if (running.process) {
+        running.process->disconnect(this);
+        if (running.process->state() != QProcess::NotRunning) {
+            OfficeConverter::killProcessGroup(running.process);
+        } else {
+            exitCode = running.process->exitStatus() == QProcess::NormalExit ? running.process->exitCode() : -1;
+        }
+        output = QString::fromLocal8Bit(running.process->readAllStandardOutput());
+        running.process->deleteLater();
+    }
+
+    if (running.viaDaemon) {
+        // 常驻进程卡在文档上时重启它；取消的转换在常驻进程中仍会完成，写出的临时文件由缓存维护时清理
+        if (outcome == Outcome::TimedOut) m_daemons->recycle(running.instance);
+        if (exitCode == OfficeDaemonPool::kClientUnavailableExitCode) m_daemons->disable();
+        m_daemons->release(running.instance);
+        // 常驻进程在转换中退出或客户端不可用时重试一次（届时已重启或改为直接运行 soffice）
+        const bool daemonLost = m_daemons->state(running.instance) != OfficeDaemonPool::State::Ready;
+        if (outcome == Outcome::Exited && exitCode != 0 && daemonLost && running.job.attempts == 0) {
+            OfficeConverter::discardOutput(running.plan);
+            Job retry = running.job;
+            retry.attempts = 1;
+            m_queue.prepend(retry);
+            scheduleDispatch();
+            return;
+        }
+    }
+
+    QString pdfPath;
+    QString errorMsg;
+    bool ok = false;
+    switch (outcome) {
+    case Outcome::Exited:
+        ok = OfficeConverter::finishConversion(running.plan, exitCode, output, pdfPath, errorMsg);
+        break;
+    case Outcome::FailedToStart:
+        errorMsg = tr("%1 启动失败").arg(running.plan.toolName);
+        break;
+    case Outcome::TimedOut:
+        OfficeConverter::discardOutput(running.plan);
+        errorMsg = tr("%1 转换超时").arg(running.plan.toolName);
+        break;
+    case Outcome::Cancelled:
+        OfficeConverter::discardOutput(running.plan);
+        errorMsg = tr("转换已取消");
+        break;
+    }
+    emit finished(id, running.job.inputPath, ok, pdfPath, errorMsg);
+    scheduleDispatch();
+}
@@ -0,0 +1,91 @@
+#ifndef OFFICECONVERSIONSERVICE_H
+#define OFFICECONVERSIONSERVICE_H
+
+#include "OfficeConverter.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class OfficeDaemonPool;
+class QProcess;
+class QTimer;
+
+// 办公文档转 PDF 的异步队列：转换进程由 QProcess 异步运行，结束时通过 finished 信号报告，界面线程从不等待。
+// 同时运行的转换进程数不超过 maxConcurrent（配置项 office/maxConversions）；
+// 队列按优先级取任务，同一优先级先提交的先转换。当前选中的文件用 Interactive 提交，排在其它任务之前。
+// 由 LibreOffice 完成的转换提交给 OfficeDaemonPool 中常驻的进程，不再每个文档冷启动一次 soffice。
+// Background 任务（如预热整个目录）以最低的 CPU 和磁盘优先级运行，且最多占用 maxConcurrent - 1 个名额，
+// 使用编号靠后的实例，始终给用户点击的文件留出一个正常优先级的实例
+class OfficeConversionService : public QObject {
+    Q_OBJECT
+public:
+    enum class Priority { Background, Normal, Interactive };
+
+    explicit OfficeConversionService(QObject *parent = nullptr);
+    ~OfficeConversionService() override;
+
+    void setMaxConcurrent(int count);
+    int maxConcurrent() const { return m_maxConcurrent; }
+
+    // 提交转换，返回任务编号。同一文件已在队列中或正在转换时返回原编号，优先级只升不降。
+    // 以 Interactive 提交时，之前排队的 Interactive 任务降为 Normal（只有当前选中的文件优先）
+    quint64 convert(const QString &inputPath, Priority priority = Priority::Normal);
+    // 取消排队中或正在运行的任务（终止其进程），该任务以失败结束
+    void cancel(quint64 job);
+    // 取消所有不高于 priority 的任务
+    void cancelAll(Priority priority = Priority::Interactive);
+    int pendingCount() const { return m_queue.size() + m_running.size(); }
+
+signals:
+    // 每个任务恰好报告一次：成功时 pdfPath 为缓存中的 PDF，失败或取消时 errorMsg 说明原因
+    void finished(quint64 job, const QString &inputPath, bool ok, const QString &pdfPath, const QString &errorMsg);
+
+private:
+    struct Job {
+        quint64 id {0};
+        QString inputPath;
+        Priority priority {Priority::Normal};
+        int attempts {0};
+    };
+    struct RunningJob {
+        Job job;
+        OfficeConverter::ConversionPlan plan;
+        QProcess *process {nullptr};
+        QTimer *timeout {nullptr};
+        int instance {-1};
+        bool viaDaemon {false};  // 由常驻进程转换；process 为空时正在准备或等待常驻进程就绪
+    };
+    struct Prepared {
+        bool ok {false};
+        OfficeConverter::ConversionPlan plan;
+        QString errorMsg;
+    };
+    enum class Outcome { Exited, FailedToStart, TimedOut, Cancelled };
+
+    static constexpr int kConversionTimeoutMs = 120000;
+
+    void scheduleDispatch();
+    void dispatch();
+    // 取一个空闲的并发实例编号
+    int takeInstance(Priority priority);
+    void start(const Job &job);
+    void onPrepared(quint64 id, const Prepared &prepared);
+    RunningJob takeRunning(QHash<quint64, RunningJob>::iterator it);
+    void launch(RunningJob &running);
+    void complete(quint64 id, Outcome outcome);
+    void onDaemonReady(int instance);
+    void onDaemonFailed(int instance);
+
+    int m_maxConcurrent {2};
+    quint64 m_nextId {0};
+    bool m_dispatchPending {false};
+    QList<Job> m_queue;
+    QHash<quint64, RunningJob> m_running;
+    QVector<bool> m_instanceBusy;  // 并发实例的编号，LibreOffice 按实例区分配置目录和常驻进程
+    OfficeDaemonPool *m_daemons {nullptr};
+};
+
+#endif // OFFICECONVERSIONSERVICE_H
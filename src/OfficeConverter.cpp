@@ -1,133 +1,123 @@
 #include "OfficeConverter.h"
+#include "OfficeConversionCache.h"
+#include "OfficeToolRegistry.h"
 
-#include <QCryptographicHash>
 #include <QDir>
 #include <QFileInfo>
 #include <QProcess>
 #include <QRegularExpression>
 #include <QStandardPaths>
+#include <QUrl>
 
-enum class OfficeType {
-    None,
-    LibreOffice,
-    WPS,
-    OnlyOffice,
-    Unoconv,      // 基于 LibreOffice 的转换工具
-    Pandoc,       // 通用文档转换工具
-    TextExtract   // 纯文本提取（降级方案）
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <csignal>
+#include <unistd.h>
+#endif
+
+namespace {
+const char *const kProcessGroupProperty = "officeProcessGroup";
+
+#if defined(Q_OS_LINUX) && QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+// Qt 5 没有 setChildProcessModifier，在子进程 exec 之前的回调中建立新会话
+class GroupedProcess : public QProcess {
+public:
+    using QProcess::QProcess;
+
+protected:
+    void setupChildProcess() override { ::setsid(); }
 };
+#endif
+}
 
-static OfficeType detectOfficeApp(QString *exePathOut = nullptr, QString *typeNameOut = nullptr) {
-    // 1. 优先检测 unoconv（最稳定的转换工具）
-    QString unoconv = QStandardPaths::findExecutable("unoconv");
-    if (!unoconv.isEmpty()) {
-        if (exePathOut) *exePathOut = unoconv;
-        if (typeNameOut) *typeNameOut = "Unoconv";
-        return OfficeType::Unoconv;
-    }
-    
-    // 2. 检测 LibreOffice（开源免费，功能完整，已验证转换命令可用）
-    QString soffice = QStandardPaths::findExecutable("soffice");
-    if (soffice.isEmpty()) {
-        soffice = QStandardPaths::findExecutable("libreoffice");
-    }
-    // 尝试常见的安装路径
-    if (soffice.isEmpty()) {
-        QStringList possiblePaths = {
-            "/usr/bin/libreoffice",
-            "/usr/bin/soffice",
-            "/opt/libreoffice/program/soffice",
-            "/snap/bin/libreoffice"
-        };
-        for (const QString& path : possiblePaths) {
-            if (QFile::exists(path)) {
-                soffice = path;
-                break;
-            }
-        }
-    }
-    if (!soffice.isEmpty()) {
-        if (exePathOut) *exePathOut = soffice;
-        if (typeNameOut) *typeNameOut = "LibreOffice";
-        return OfficeType::LibreOffice;
-    }
-    
-    // 3. 检测 WPS（中国市场常用）
-    QString wps = QStandardPaths::findExecutable("wps");
-    if (wps.isEmpty()) {
-        // Deepin/UOS 的 WPS 可能安装在 /opt/apps 目录
-        wps = "/opt/apps/cn.wps.wps-office/files/bin/wps";
-        if (!QFile::exists(wps)) {
-            wps.clear();
-        }
-    }
-    if (!wps.isEmpty()) {
-        if (exePathOut) *exePathOut = wps;
-        if (typeNameOut) *typeNameOut = "WPS Office";
-        return OfficeType::WPS;
-    }
-    
-    // 4. 检测 pandoc（通用文档转换）
-    QString pandoc = QStandardPaths::findExecutable("pandoc");
-    if (!pandoc.isEmpty()) {
-        if (exePathOut) *exePathOut = pandoc;
-        if (typeNameOut) *typeNameOut = "Pandoc";
-        return OfficeType::Pandoc;
-    }
-    
-    // 5. 检测 OnlyOffice
-    QString onlyoffice = QStandardPaths::findExecutable("onlyoffice-desktopeditors");
-    if (onlyoffice.isEmpty()) {
-        onlyoffice = QStandardPaths::findExecutable("desktopeditors");
-    }
-    if (!onlyoffice.isEmpty()) {
-        if (exePathOut) *exePathOut = onlyoffice;
-        if (typeNameOut) *typeNameOut = "OnlyOffice";
-        return OfficeType::OnlyOffice;
-    }
-    
-    // 6. 检测文本提取工具（降级方案）
-    QString docx2txt = QStandardPaths::findExecutable("docx2txt");
-    if (!docx2txt.isEmpty()) {
-        if (exePathOut) *exePathOut = docx2txt;
-        if (typeNameOut) *typeNameOut = "Text Extract";
-        return OfficeType::TextExtract;
-    }
-    
-    return OfficeType::None;
+QString OfficeConverter::libreOfficeProfile(int instance) {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+           + "/office_profiles/" + QString::number(instance);
 }
 
-QString OfficeConverter::cacheDir() {
-    const QString base = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QDir d(base);
-    if (!d.exists()) d.mkpath(".");
-    const QString cache = base + "/office_cache";
-    QDir c(cache);
-    if (!c.exists()) c.mkpath(".");
-    return cache;
+void OfficeConverter::lowerPriority(QString &program, QStringList &arguments) {
+#ifdef Q_OS_LINUX
+    static const QString nice = QStandardPaths::findExecutable("nice");
+    static const QString ionice = QStandardPaths::findExecutable("ionice");
+    QStringList command;
+    if (!nice.isEmpty()) command << nice << "-n" << "19";
+    // 空闲类：只在磁盘没有其它请求时读写
+    if (!ionice.isEmpty()) command << ionice << "-c" << "3";
+    if (command.isEmpty()) return;
+    command << program << arguments;
+    program = command.takeFirst();
+    arguments = command;
+#else
+    Q_UNUSED(program);
+    Q_UNUSED(arguments);
+#endif
 }
 
-QString OfficeConverter::hashedName(const QString &path) {
-    QByteArray key = QFileInfo(path).absoluteFilePath().toUtf8();
-    QByteArray hash = QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
-    return QString::fromUtf8(hash);
+QProcess *OfficeConverter::createGroupedProcess(QObject *parent) {
+#if defined(Q_OS_LINUX) && QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    QProcess *process = new GroupedProcess(parent);
+#else
+    auto *process = new QProcess(parent);
+#ifdef Q_OS_LINUX
+    process->setChildProcessModifier([]() { ::setsid(); });
+#endif
+#endif
+    // 新会话的进程组号就是其首个进程的进程号（nice/ionice 以 exec 方式运行命令，进程号不变）。
+    // 启动程序退出后 processId() 变为 0，而派生的进程可能还在，所以在启动时记下
+    QObject::connect(process, &QProcess::started, process, [process]() {
+        process->setProperty(kProcessGroupProperty, process->processId());
+    });
+    return process;
 }
 
-bool OfficeConverter::convertToPdf(const QString &inputPath, QString &pdfPath, QString &errorMsg) {
+void OfficeConverter::killProcessGroup(QProcess *process) {
+#ifdef Q_OS_LINUX
+    const qint64 group = process->property(kProcessGroupProperty).toLongLong();
+    if (group > 0) ::kill(-pid_t(group), SIGKILL);
+#endif
+    process->kill();
+}
+
+bool OfficeConverter::prepareConversion(const QString &inputPath, ConversionPlan &plan, QString &errorMsg, int instance) {
     errorMsg.clear();
-    pdfPath.clear();
+    plan = ConversionPlan();
 
     QFileInfo fi(inputPath);
     if (!fi.exists() || !fi.isFile()) {
         errorMsg = QObject::tr("输入文件不存在: %1").arg(inputPath);
         return false;
     }
+    plan.inputPath = fi.absoluteFilePath();
 
-    QString officeExe;
-    QString officeName;
-    OfficeType officeType = detectOfficeApp(&officeExe, &officeName);
-    
-    if (officeType == OfficeType::None) {
+    // 缓存按文件内容查找，改名或复制过的文件也能直接复用
+    plan.cacheKey = OfficeConversionCache::contentKey(plan.inputPath);
+    if (plan.cacheKey.isEmpty()) {
+        errorMsg = QObject::tr("无法读取文件: %1").arg(inputPath);
+        return false;
+    }
+    const QString outDir = OfficeConversionCache::directory();
+    plan.pdfPath = OfficeConversionCache::entryPath(plan.cacheKey);
+    if (!OfficeConversionCache::lookup(plan.cacheKey).isEmpty()) {
+        plan.cached = true;
+        return true;
+    }
+    // 工具写到本次转换自己的临时文件，正常结束后才移到缓存中的目标位置；
+    // 被终止的进程留下的不完整文件不会成为缓存结果
+    plan.outputPdf = OfficeConversionCache::temporaryPath(plan.cacheKey);
+    const QString outPdf = plan.outputPdf;
+
+    // 在能转换该格式的工具中选择；工具列表在启动时已在后台查找
+    using Kind = OfficeToolRegistry::Kind;
+    OfficeToolRegistry::Tool tool;
+    if (!OfficeToolRegistry::toolForFormat(fi.suffix(), tool)) {
+        const QList<OfficeToolRegistry::Tool> installed = OfficeToolRegistry::tools();
+        const bool anyConverter = std::any_of(installed.begin(), installed.end(),
+                                              [](const OfficeToolRegistry::Tool &t) { return !t.pdfFormats.isEmpty(); });
+        if (anyConverter) {
+            errorMsg = QObject::tr("已安装的转换工具都不支持 %1 格式").arg(fi.suffix());
+            return false;
+        }
         errorMsg = QObject::tr("未检测到办公软件或转换工具，请安装以下任一软件：\n\n"
                               "【推荐方案】\n"
                               "• unoconv (最稳定): sudo apt install unoconv\n"
@@ -138,60 +128,63 @@ bool OfficeConverter::convertToPdf(const QString &inputPath, QString &pdfPath, Q
                               "• OnlyOffice (现代界面)");
         return false;
     }
-
-    const QString outDir = cacheDir();
-    const QString baseName = hashedName(inputPath) + ".pdf";
-    const QString outPdf = outDir + "/" + baseName;
-
-    // 若缓存存在且比源文件新，直接复用
-    QFileInfo outInfo(outPdf);
-    if (outInfo.exists() && outInfo.lastModified() >= fi.lastModified()) {
-        pdfPath = outPdf;
-        return true;
-    }
+    plan.toolName = tool.name;
+    plan.program = tool.program;
+    // 这两种方式都由 LibreOffice 完成转换，可以改为提交给常驻的 LibreOffice 进程
+    plan.usesLibreOffice = tool.kind == Kind::LibreOffice || tool.kind == Kind::Unoconv;
 
     // 根据不同的办公软件使用不同的转换命令
-    QProcess proc;
-    QStringList args;
+    QStringList &args = plan.arguments;
     
     // 对于 LibreOffice，添加环境变量优化
-    if (officeType == OfficeType::LibreOffice) {
+    if (tool.kind == Kind::LibreOffice) {
         QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
         // 设置 LibreOffice 使用的显示为虚拟显示，避免窗口弹出
         env.insert("DISPLAY", ":99");
-        proc.setProcessEnvironment(env);
+        plan.environment = env;
     }
     
-    switch (officeType) {
-        case OfficeType::Unoconv:
+    switch (tool.kind) {
+        case Kind::Unoconv:
             // unoconv 是最稳定的转换工具
             args << "-f" << "pdf" << "-o" << outPdf << fi.absoluteFilePath();
             break;
             
-        case OfficeType::LibreOffice:
-            // LibreOffice 标准转换命令（已验证可用）
+        case Kind::LibreOffice: {
+            // LibreOffice 标准转换命令（已验证可用），输出文件名取自源文件名
+            QString convertDir = QFileInfo(outPdf).absolutePath();
+            if (instance >= 0) {
+                // 同一配置目录只能有一个 LibreOffice 进程，并发转换时各实例使用自己的配置目录；
+                // 不同目录下的同名文件也会同时转换，输出目录同样按实例分开
+                args << "-env:UserInstallation=" + QUrl::fromLocalFile(libreOfficeProfile(instance)).toString();
+                convertDir = outDir + "/staging/" + QString::number(instance);
+                QDir().mkpath(convertDir);
+            }
             args << "--headless" << "--convert-to" << "pdf" 
-                 << "--outdir" << outDir << fi.absoluteFilePath();
+                 << "--outdir" << convertDir << fi.absoluteFilePath();
+            plan.outputPdf = convertDir + "/" + fi.completeBaseName() + ".pdf";
             break;
+        }
             
-        case OfficeType::WPS:
+        case Kind::WPS:
             // WPS 命令行转换（如果支持）
             // 注意：WPS 的命令行转换功能可能需要专业版
+            // 只接受写到 outPdf 的结果：源文件目录中同名的 PDF 可能是用户自己的文件，不能移走
             args << "--export-pdf" << fi.absoluteFilePath() << outPdf;
             break;
             
-        case OfficeType::Pandoc:
+        case Kind::Pandoc:
             // Pandoc 通用文档转换
             args << fi.absoluteFilePath() << "-o" << outPdf;
             break;
             
-        case OfficeType::OnlyOffice:
+        case Kind::OnlyOffice:
             // OnlyOffice 转换命令（如果支持命令行）
             args << "--convert-to" << "pdf" 
                  << "--output" << outPdf << fi.absoluteFilePath();
             break;
             
-        case OfficeType::TextExtract:
+        case Kind::TextExtract:
             // 纯文本提取（降级方案）
             // 这里只是占位，实际需要特殊处理
             errorMsg = QObject::tr("仅支持文本提取，无法生成 PDF");
@@ -201,48 +194,37 @@ bool OfficeConverter::convertToPdf(const QString &inputPath, QString &pdfPath, Q
             errorMsg = QObject::tr("不支持的办公软件类型");
             return false;
     }
-    
-    proc.setProgram(officeExe);
-    proc.setArguments(args);
-    proc.setProcessChannelMode(QProcess::MergedChannels);
+    // 暂存目录中可能有之前被终止的同名转换留下的文件
+    QFile::remove(plan.outputPdf);
+    return true;
+}
 
-    // 设定超时，避免卡死
-    proc.start();
-    if (!proc.waitForStarted(15000)) {
-        errorMsg = QObject::tr("%1 启动失败").arg(officeName);
+bool OfficeConverter::finishConversion(const ConversionPlan &plan, int exitCode, const QString &output,
+                                       QString &pdfPath, QString &errorMsg) {
+    errorMsg.clear();
+    pdfPath.clear();
+
+    // 只有正常结束（退出码为 0）且写出了文件才算成功，否则输出可能不完整
+    if (exitCode != 0) {
+        discardOutput(plan);
+        errorMsg = QObject::tr("%1 转换失败（退出码 %2）\n输出: %3").arg(plan.toolName).arg(exitCode).arg(output);
         return false;
     }
-    if (!proc.waitForFinished(120000)) { // 最多等 120s
-        proc.kill();
-        errorMsg = QObject::tr("%1 转换超时").arg(officeName);
+    if (!QFile::exists(plan.outputPdf)) {
+        errorMsg = QObject::tr("未生成 PDF，%1 可能不支持此文件格式: %2\n输出: %3")
+                      .arg(plan.toolName, QFileInfo(plan.inputPath).suffix(), output);
         return false;
     }
-
-    const QString output = QString::fromLocal8Bit(proc.readAllStandardOutput());
-    
-    // WPS 可能生成的文件名不同，尝试查找
-    if (officeType == OfficeType::WPS && !QFile::exists(outPdf)) {
-        // WPS 可能直接在当前目录生成，尝试移动
-        QString wpsOutput = fi.absolutePath() + "/" + fi.completeBaseName() + ".pdf";
-        if (QFile::exists(wpsOutput)) {
-            QFile::rename(wpsOutput, outPdf);
-        }
-    }
-
-    if (!QFile::exists(outPdf)) {
-        errorMsg = QObject::tr("未生成 PDF，%1 可能不支持此文件格式: %2\n输出: %3")
-                      .arg(officeName, fi.suffix(), output);
+    if (!OfficeConversionCache::commit(plan.outputPdf, plan.cacheKey)) {
+        errorMsg = QObject::tr("无法保存转换结果: %1").arg(plan.pdfPath);
         return false;
     }
-
-    pdfPath = outPdf;
+    pdfPath = plan.pdfPath;
     return true;
 }
 
-QString OfficeConverter::detectInstalledOffice() {
-    QString officeName;
-    detectOfficeApp(nullptr, &officeName);
-    return officeName;
+void OfficeConverter::discardOutput(const ConversionPlan &plan) {
+    if (!plan.outputPdf.isEmpty()) QFile::remove(plan.outputPdf);
 }
 
 bool OfficeConverter::isOfficeDocument(const QString &filePath) {
@@ -329,10 +311,5 @@ bool OfficeConverter::extractTextContent(const QString &inputPath, QString &text
 }
 
 void OfficeConverter::clearCache() {
-    QString cache = cacheDir();
-    QDir cacheDir(cache);
-    if (cacheDir.exists()) {
-        cacheDir.removeRecursively();
-        cacheDir.mkpath(".");
-    }
+    OfficeConversionCache::clear();
 }
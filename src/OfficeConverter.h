@@ -1,16 +1,49 @@
 #ifndef OFFICECONVERTER_H
 #define OFFICECONVERTER_H
 
+#include <QProcessEnvironment>
 #include <QString>
+#include <QStringList>
+
+class QObject;
+class QProcess;
 
 class OfficeConverter {
 public:
-    // 将办公文件转换为 PDF；成功返回 true，并输出 pdfPath；失败返回 false，并输出错误信息
-    static bool convertToPdf(const QString &inputPath, QString &pdfPath, QString &errorMsg);
-    
-    // 检测已安装的办公软件，返回软件名称（如 "WPS Office"、"LibreOffice" 等），未检测到返回空字符串
-    static QString detectInstalledOffice();
-    
+    // 一次转换要执行的命令；由 prepareConversion 生成，外部可以同步或异步运行该命令
+    struct ConversionPlan {
+        QString inputPath;    // 源文件的绝对路径
+        QString cacheKey;     // 源文件的内容键（OfficeConversionCache）
+        QString pdfPath;      // 缓存中的目标 PDF
+        bool cached {false};  // 缓存有效，无需运行命令
+        QString toolName;
+        QString program;
+        QStringList arguments;
+        QProcessEnvironment environment;  // 为空时继承当前环境
+        QString outputPdf;    // 本次转换的输出：缓存目录中的临时文件（LibreOffice 为暂存目录中按源文件名输出的文件），成功后移到 pdfPath
+        bool usesLibreOffice {false};  // 由 LibreOffice 转换（LibreOffice 或 unoconv）
+    };
+
+    // 检查输入、选择转换工具并检查缓存。首次遇到的文件需要读取全部内容计算缓存键，应在后台线程调用。
+    // instance >= 0 时为并发运行的第 instance 个转换，
+    // LibreOffice 使用该实例独立的配置目录和输出目录，几个进程同时运行也互不干扰
+    static bool prepareConversion(const QString &inputPath, ConversionPlan &plan, QString &errorMsg, int instance = -1);
+    // 命令正常退出后收集结果：退出码为 0 时把输出移入缓存，否则删除输出；output 为命令的输出，用于错误信息
+    static bool finishConversion(const ConversionPlan &plan, int exitCode, const QString &output,
+                                 QString &pdfPath, QString &errorMsg);
+    // 转换失败、超时或取消时删除不完整的输出
+    static void discardOutput(const ConversionPlan &plan);
+
+    // 第 instance 个并发 LibreOffice 实例的配置目录
+    static QString libreOfficeProfile(int instance);
+    // 改为经 nice/ionice 运行该命令，以最低的 CPU 和磁盘优先级执行（子进程继承）；系统没有这些工具时不变
+    static void lowerPriority(QString &program, QStringList &arguments);
+    // 创建在新会话（独立进程组）中启动命令的 QProcess。LibreOffice 的启动程序会再派生 soffice.bin，
+    // 只终止启动程序会留下 soffice.bin 继续占用配置目录和端口，应改用 killProcessGroup 一起终止
+    static QProcess *createGroupedProcess(QObject *parent);
+    // 终止 process 所在的整个进程组（非 Linux 上只终止该进程）
+    static void killProcessGroup(QProcess *process);
+
     // 检查文件是否为支持的 Office 文档格式
     static bool isOfficeDocument(const QString &filePath);
     
@@ -19,10 +52,6 @@ public:
     
     // 清理缓存文件
     static void clearCache();
-
-private:
-    static QString cacheDir();
-    static QString hashedName(const QString &path);
 };
 
 #endif // OFFICECONVERTER_H
@@ -0,0 +1,279 @@
+#include "OfficeDaemonPool.h"
+#include "OfficeConverter.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QRandomGenerator>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QUrl>
+
+#ifdef Q_OS_LINUX
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// 连接常驻进程、加载文档并按文档类型选择 PDF 导出过滤器；参数：管道名 源文件 目标文件
+const char *kClientScript = R"(
+import sys
+try:
+    import uno
+    from com.sun.star.beans import PropertyValue
+except ImportError:
+    sys.exit(3)
+
+def prop(name, value):
+    p = PropertyValue()
+    p.Name = name
+    p.Value = value
+    return p
+
+pipe, src, dst = sys.argv[1], sys.argv[2], sys.argv[3]
+local = uno.getComponentContext()
+resolver = local.ServiceManager.createInstanceWithContext("com.sun.star.bridge.UnoUrlResolver", local)
+try:
+    ctx = resolver.resolve("uno:pipe,name=%s;urp;StarOffice.ComponentContext" % pipe)
+except Exception:
+    sys.exit(4)
+desktop = ctx.ServiceManager.createInstanceWithContext("com.sun.star.frame.Desktop", ctx)
+doc = desktop.loadComponentFromURL(uno.systemPathToFileUrl(src), "_blank", 0,
+                                   (prop("Hidden", True), prop("ReadOnly", True)))
+if doc is None:
+    sys.exit(1)
+try:
+    name = "writer_pdf_Export"
+    for service, exportFilter in (("com.sun.star.sheet.SpreadsheetDocument", "calc_pdf_Export"),
+                                  ("com.sun.star.presentation.PresentationDocument", "impress_pdf_Export"),
+                                  ("com.sun.star.drawing.DrawingDocument", "draw_pdf_Export")):
+        if doc.supportsService(service):
+            name = exportFilter
+            break
+    doc.storeToURL(uno.systemPathToFileUrl(dst), (prop("FilterName", name),))
+finally:
+    doc.close(True)
+)";
+
+#ifdef Q_OS_LINUX
+// 每次启动随机取名，其它程序无法预先占用或猜到
+QString newPipeName(int instance) {
+    return QString("filemanager-%1-%2-%3").arg(QCoreApplication::applicationPid()).arg(instance)
+        .arg(QRandomGenerator::global()->generate64(), 16, 16, QLatin1Char('0'));
+}
+
+// LibreOffice 把名为 name 的 UNO 管道建为 /tmp（不可写时为 /var/tmp）下的本地套接字 OSL_PIPE_<uid>_<name>，
+// 只有本用户可以连接。本地连接立即成功或被拒绝，不会阻塞
+bool isPipeListening(const QString &name) {
+    const QByteArray file = "OSL_PIPE_" + QByteArray::number(::getuid()) + '_' + name.toUtf8();
+    for (const char *dir : {"/tmp/", "/var/tmp/"}) {
+        const QByteArray path = dir + file;
+        sockaddr_un addr {};
+        if (size_t(path.size()) >= sizeof(addr.sun_path)) return false;
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.constData(), size_t(path.size()));
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+        const bool ok = ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+        ::close(fd);
+        if (ok) return true;
+    }
+    return false;
+}
+#endif
+
+// 使用命名管道而不是 TCP 端口：本机端口上的 UNO 连接不需要认证，其它用户也能连上并借此执行命令
+QString acceptString(const QString &pipeName) {
+    return QString("pipe,name=%1;urp;StarOffice.ComponentContext").arg(pipeName);
+}
+}
+
+OfficeDaemonPool::OfficeDaemonPool(QObject *parent) : QObject(parent) {
+    QSettings settings;
+    m_enabled = settings.value("office/warmDaemons", true).toBool();
+    m_idleMinutes = settings.value("office/daemonIdleMinutes", 10).toInt();
+}
+
+void OfficeDaemonPool::loadTools(const QList<OfficeToolRegistry::Tool> &tools) {
+    m_toolsLoaded = true;
+    for (const OfficeToolRegistry::Tool &tool : tools) {
+#ifdef Q_OS_LINUX
+        if (tool.kind == OfficeToolRegistry::Kind::LibreOffice) m_soffice = tool.program;
+#endif
+        if (tool.kind == OfficeToolRegistry::Kind::Unoconv) m_unoconv = tool.program;
+    }
+    if (m_soffice.isEmpty()) return;
+    // 官方安装包自带能导入 uno 的 Python，发行版的 LibreOffice 则使用系统的 python3（需安装 python3-uno）
+    const QString bundled = QFileInfo(QFileInfo(m_soffice).canonicalFilePath()).absolutePath() + "/python";
+    m_python = QFileInfo(bundled).isExecutable() ? bundled : QStandardPaths::findExecutable("python3");
+    if (m_unoconv.isEmpty() && m_python.isEmpty()) m_enabled = false;
+}
+
+bool OfficeDaemonPool::isAvailable() {
+    if (!m_toolsLoaded) {
+        QList<OfficeToolRegistry::Tool> tools;
+        if (!OfficeToolRegistry::tryTools(tools)) return false;
+        loadTools(tools);
+    }
+    return m_enabled && !m_soffice.isEmpty();
+}
+
+OfficeDaemonPool::~OfficeDaemonPool() {
+    for (size_t i = 0; i < m_daemons.size(); ++i) stopDaemon(int(i));
+}
+
+OfficeDaemonPool::Daemon &OfficeDaemonPool::daemonAt(int instance) {
+    if (size_t(instance) >= m_daemons.size()) m_daemons.resize(size_t(instance) + 1);
+    return m_daemons[size_t(instance)];
+}
+
+OfficeDaemonPool::State OfficeDaemonPool::state(int instance) const {
+    return size_t(instance) < m_daemons.size() ? m_daemons[size_t(instance)].state : State::Stopped;
+}
+
+OfficeDaemonPool::State OfficeDaemonPool::acquire(int instance, bool idle) {
+    Daemon &daemon = daemonAt(instance);
+    if (daemon.state != State::Stopped && daemon.idle != idle && !daemon.inUse) stopDaemon(instance);
+    daemon.inUse = true;
+    daemon.idle = idle;
+    if (daemon.idleTimer) daemon.idleTimer->stop();
+    if (daemon.state == State::Stopped && isAvailable()) startDaemon(instance);
+    return daemon.state;
+}
+
+void OfficeDaemonPool::release(int instance) {
+    Daemon &daemon = daemonAt(instance);
+    daemon.inUse = false;
+    if (m_idleMinutes <= 0 || daemon.state == State::Stopped) return;
+    if (!daemon.idleTimer) {
+        daemon.idleTimer = new QTimer(this);
+        daemon.idleTimer->setSingleShot(true);
+        connect(daemon.idleTimer, &QTimer::timeout, this, [this, instance]() {
+            if (!m_daemons[size_t(instance)].inUse) stopDaemon(instance);
+        });
+    }
+    daemon.idleTimer->start(m_idleMinutes * 60 * 1000);
+}
+
+void OfficeDaemonPool::clientCommand(int instance, const QString &inputPath, const QString &outputPdf,
+                                     QString &program, QStringList &arguments) const {
+    const QString &pipeName = m_daemons[size_t(instance)].pipeName;
+    if (!m_unoconv.isEmpty()) {
+        program = m_unoconv;
+        arguments = {"--no-launch", "--connection", acceptString(pipeName), "-f", "pdf", "-o", outputPdf, inputPath};
+    } else {
+        program = m_python;
+        arguments = {"-c", QString::fromUtf8(kClientScript), pipeName, inputPath, outputPdf};
+    }
+}
+
+void OfficeDaemonPool::recycle(int instance) {
+    stopDaemon(instance);
+    if (daemonAt(instance).inUse && isAvailable()) startDaemon(instance);
+}
+
+void OfficeDaemonPool::disable() {
+    if (!m_enabled) return;
+    qWarning() << "Office daemons disabled, falling back to one soffice per conversion";
+    m_enabled = false;
+    for (size_t i = 0; i < m_daemons.size(); ++i) {
+        const bool waiting = m_daemons[i].state == State::Starting;
+        stopDaemon(int(i));
+        if (waiting) emit daemonFailed(int(i));
+    }
+}
+
+void OfficeDaemonPool::startDaemon(int instance) {
+    Daemon &daemon = daemonAt(instance);
+#ifdef Q_OS_LINUX
+    daemon.pipeName = newPipeName(instance);
+#else
+    // 只实现了 Linux 上的就绪检测
+    disable();
+    return;
+#endif
+    const QString profile = OfficeConverter::libreOfficeProfile(instance);
+    QDir().mkpath(profile);
+
+    QString program = m_soffice;
+    QStringList arguments = {
+        "--headless", "--invisible", "--nologo", "--norestore", "--nodefault", "--nolockcheck",
+        "-env:UserInstallation=" + QUrl::fromLocalFile(profile).toString(),
+        "--accept=" + acceptString(daemon.pipeName),
+    };
+    if (daemon.idle) OfficeConverter::lowerPriority(program, arguments);
+
+    daemon.process = OfficeConverter::createGroupedProcess(this);
+    daemon.process->setProgram(program);
+    daemon.process->setArguments(arguments);
+    daemon.process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    daemon.process->setStandardOutputFile(QProcess::nullDevice());
+    connect(daemon.process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            [this, instance]() { onDaemonExited(instance); });
+    connect(daemon.process, &QProcess::errorOccurred, this, [this, instance](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) onDaemonExited(instance);
+    });
+
+    daemon.state = State::Starting;
+    daemon.probes = 0;
+    if (!daemon.probeTimer) {
+        daemon.probeTimer = new QTimer(this);
+        daemon.probeTimer->setInterval(kProbeIntervalMs);
+        connect(daemon.probeTimer, &QTimer::timeout, this, [this, instance]() { probeDaemon(instance); });
+    }
+    daemon.process->start();
+    daemon.probeTimer->start();
+}
+
+void OfficeDaemonPool::stopDaemon(int instance) {
+    Daemon &daemon = daemonAt(instance);
+    if (daemon.probeTimer) daemon.probeTimer->stop();
+    if (daemon.idleTimer) daemon.idleTimer->stop();
+    daemon.state = State::Stopped;
+    if (!daemon.process) return;
+    daemon.process->disconnect(this);
+    OfficeConverter::killProcessGroup(daemon.process);
+    daemon.process->deleteLater();
+    daemon.process = nullptr;
+}
+
+void OfficeDaemonPool::probeDaemon(int instance) {
+    Daemon &daemon = daemonAt(instance);
+    if (daemon.state != State::Starting) return;
+#ifdef Q_OS_LINUX
+    if (isPipeListening(daemon.pipeName)) {
+        daemon.probeTimer->stop();
+        daemon.state = State::Ready;
+        daemon.readySince.start();
+        if (!daemon.inUse) release(instance);
+        emit daemonReady(instance);
+        return;
+    }
+#endif
+    if (++daemon.probes * kProbeIntervalMs >= kStartTimeoutMs) {
+        qWarning() << "LibreOffice daemon did not start in time, instance" << instance;
+        // 按退出处理：计入启动失败并通知等待的转换
+        stopDaemon(instance);
+        onDaemonExited(instance);
+    }
+}
+
+void OfficeDaemonPool::onDaemonExited(int instance) {
+    Daemon &daemon = daemonAt(instance);
+    // 启动失败和就绪后很快又退出（如配置目录损坏）都计为失败；稳定运行过一段时间后才退出的重新计数
+    const bool stable = daemon.state == State::Ready && daemon.readySince.elapsed() >= kStableUptimeMs;
+    stopDaemon(instance);
+    if (stable) daemon.failures = 0;
+    if (!stable && ++daemon.failures >= kMaxStartFailures) {
+        disable();
+    } else if (daemon.inUse && isAvailable()) {
+        // 有转换在用时立即重启；空闲的实例等下次 acquire 时再启动
+        startDaemon(instance);
+    }
+    emit daemonFailed(instance);
+}
@@ -0,0 +1,91 @@
+#ifndef OFFICEDAEMONPOOL_H
+#define OFFICEDAEMONPOOL_H
+
+#include "OfficeToolRegistry.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+class QProcess;
+class QTimer;
+
+// 常驻的无界面 LibreOffice 进程，每个并发转换实例一个，按需启动后保持运行。
+// 每个进程在只有本用户能连接的命名管道上接受 UNO 连接（--accept=pipe），转换时用 unoconv（--no-launch）
+// 或一段使用 uno 模块的 Python 脚本连接过去加载文档并导出 PDF，只有第一次转换需要等 LibreOffice 启动。
+// 正在使用的进程意外退出后自动重启；连续启动失败（包括就绪后很快退出）或没有可用的 UNO 客户端时停用，
+// 转换回到每次启动 soffice 的方式。
+// 空闲超过 office/daemonIdleMinutes 分钟的进程会退出以释放内存
+class OfficeDaemonPool : public QObject {
+    Q_OBJECT
+public:
+    enum class State { Stopped, Starting, Ready };
+
+    explicit OfficeDaemonPool(QObject *parent = nullptr);
+    ~OfficeDaemonPool() override;
+
+    // 找到 LibreOffice 且未被停用。工具路径取自 OfficeToolRegistry 已完成的查找结果，不在界面线程等待查找；
+    // 后台查找尚未完成时返回 false（这次转换直接运行 soffice），之后的调用再读取结果
+    bool isAvailable();
+    // 开始使用第 instance 个进程，未运行时启动它；返回 Ready 时可以立即提交转换，否则等待 daemonReady。
+    // idle 为 true 时该进程以最低的 CPU 和磁盘优先级运行（优先级只能在启动时设定，
+    // soffice 会再派生 soffice.bin），已运行的进程优先级不符时重新启动
+    State acquire(int instance, bool idle = false);
+    // 该实例的转换已结束，开始计算空闲时间
+    void release(int instance);
+    State state(int instance) const;
+    // 生成向第 instance 个进程提交转换的命令
+    void clientCommand(int instance, const QString &inputPath, const QString &outputPdf,
+                       QString &program, QStringList &arguments) const;
+    // 客户端以该退出码结束表示本机无法使用 UNO 客户端
+    static constexpr int kClientUnavailableExitCode = 3;
+    // 进程卡在某个文档上时重启它
+    void recycle(int instance);
+    // 停用常驻进程，之后的转换直接运行 soffice
+    void disable();
+
+signals:
+    void daemonReady(int instance);
+    // 启动失败或运行中退出；等待该实例的转换应改用其它方式
+    void daemonFailed(int instance);
+
+private:
+    struct Daemon {
+        QProcess *process {nullptr};
+        QTimer *probeTimer {nullptr};  // 启动期间轮询端口是否开始接受连接
+        QTimer *idleTimer {nullptr};
+        QString pipeName;  // UNO 管道名，每次启动重新生成
+        QElapsedTimer readySince;
+        State state {State::Stopped};
+        bool inUse {false};
+        bool idle {false};  // 以最低优先级运行
+        int probes {0};
+        int failures {0};  // 连续启动失败的次数
+    };
+
+    static constexpr int kProbeIntervalMs = 250;
+    static constexpr int kStartTimeoutMs = 60000;
+    static constexpr int kMaxStartFailures = 3;
+    // 就绪后运行不到这么久就退出的计为启动失败
+    static constexpr qint64 kStableUptimeMs = 60000;
+
+    Daemon &daemonAt(int instance);
+    void startDaemon(int instance);
+    void stopDaemon(int instance);
+    void probeDaemon(int instance);
+    void onDaemonExited(int instance);
+    void loadTools(const QList<OfficeToolRegistry::Tool> &tools);
+
+    QString m_soffice;
+    QString m_unoconv;
+    QString m_python;
+    bool m_toolsLoaded {false};
+    bool m_enabled {true};
+    int m_idleMinutes {10};
+    std::vector<Daemon> m_daemons;
+};
+
+#endif // OFFICEDAEMONPOOL_H
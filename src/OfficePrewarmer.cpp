@@ -0,0 +1,94 @@
+#include "OfficePrewarmer.h"
+#include "OfficeConversionService.h"
+#include "ThumbnailDiskCache.h"
+#include "ThumbnailRenderer.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QMetaObject>
+#include <QtConcurrent>
+
+OfficePrewarmer::OfficePrewarmer(OfficeConversionService *conversions, QObject *parent)
+    : QObject(parent), m_conversions(conversions) {
+    m_pool.setMaxThreadCount(1);
+    connect(m_conversions, &OfficeConversionService::finished, this,
+            [this](quint64 job, const QString &inputPath, bool ok, const QString &pdfPath, const QString &) {
+        onConversionFinished(job, inputPath, ok, pdfPath);
+    });
+}
+
+OfficePrewarmer::~OfficePrewarmer() {
+    // 缓存查询任务会向 m_thumbnails 提交渲染，先等它们结束
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void OfficePrewarmer::warmDirectory(const QString &dirPath) {
+    // 网络目录列出文件可能很慢，不在界面线程进行
+    const quint64 generation = m_generation;
+    auto *watcher = new QFutureWatcher<QStringList>(this);
+    connect(watcher, &QFutureWatcher<QStringList>::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation == m_generation) enqueue(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([dirPath]() {
+        QStringList files;
+        const QDir dir(dirPath);
+        for (const QString &name : dir.entryList(QDir::Files | QDir::Readable, QDir::Name)) {
+            const QString path = dir.absoluteFilePath(name);
+            if (OfficeConverter::isOfficeDocument(path)) files.append(path);
+        }
+        return files;
+    }));
+}
+
+void OfficePrewarmer::enqueue(const QStringList &files) {
+    for (const QString &path : files) {
+        // 同一文件已在转换时得到原任务编号，只计一次
+        const quint64 job = m_conversions->convert(path, OfficeConversionService::Priority::Background);
+        if (m_jobs.contains(job)) continue;
+        m_jobs.insert(job);
+        ++m_total;
+    }
+    emit progress(m_done, m_total, m_failed);
+}
+
+void OfficePrewarmer::cancel() {
+    ++m_generation;
+    m_jobs.clear();
+    m_total = m_done = m_failed = 0;
+    // 只有预热以 Background 提交；其中被点击的文件已提升优先级，不会被取消
+    m_conversions->cancelAll(OfficeConversionService::Priority::Background);
+}
+
+void OfficePrewarmer::onConversionFinished(quint64 job, const QString &inputPath, bool ok, const QString &pdfPath) {
+    if (!m_jobs.remove(job)) return;
+    ++m_done;
+    if (ok) {
+        renderThumbnail(inputPath, pdfPath);
+    } else {
+        ++m_failed;
+    }
+    emit progress(m_done, m_total, m_failed);
+    // 本轮结束，下次预热重新计数
+    if (m_jobs.isEmpty()) m_total = m_done = m_failed = 0;
+}
+
+void OfficePrewarmer::renderThumbnail(const QString &filePath, const QString &pdfPath) {
+    const qreal dpr = m_devicePixelRatio;
+    m_pool.start([this, filePath, pdfPath, dpr]() {
+        if (!ThumbnailDiskCache::load(filePath, dpr).isNull()) return;
+        const QString label = QFileInfo(filePath).suffix().toUpper();
+        m_thumbnails.render(pdfPath, ThumbnailRenderer::pdfPageBound(dpr), [this, filePath, label, dpr](const QImage &page) {
+            QString typeKey;
+            const QImage image = ThumbnailRenderer::renderPdfThumbnail(page, dpr, &typeKey, label);
+            // 渲染失败时得到的是 PDF 占位图，不记录
+            if (!typeKey.isEmpty()) return;
+            ThumbnailDiskCache::store(filePath, image);
+            QMetaObject::invokeMethod(this, [this, filePath, image]() {
+                emit thumbnailReady(filePath, image);
+            }, Qt::QueuedConnection);
+        });
+    });
+}
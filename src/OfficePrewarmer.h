@@ -0,0 +1,55 @@
+#ifndef OFFICEPREWARMER_H
+#define OFFICEPREWARMER_H
+
+#include "PdfThumbnailWorker.h"
+
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+class OfficeConversionService;
+
+// 预热目录：把目录中的办公文档以 Background 优先级提交给 OfficeConversionService 转为 PDF，
+// 转换完成后用 PDF 首页生成缩略图写入 ThumbnailDiskCache（以办公文档本身为键）。
+// 已有转换缓存的文件很快完成，不会重新转换；点击时直接显示缓存的 PDF
+class OfficePrewarmer : public QObject {
+    Q_OBJECT
+public:
+    explicit OfficePrewarmer(OfficeConversionService *conversions, QObject *parent = nullptr);
+    ~OfficePrewarmer() override;
+
+    // 缩略图按该设备像素比生成
+    void setDevicePixelRatio(qreal dpr) { m_devicePixelRatio = dpr; }
+
+    // 在后台列出目录中的办公文档并加入转换队列；之前未完成的预热继续进行，进度合并计算
+    void warmDirectory(const QString &dirPath);
+    // 取消尚未完成的预热转换
+    void cancel();
+    bool isActive() const { return !m_jobs.isEmpty(); }
+
+signals:
+    // 每有一个文件完成时报告；done == total 时本轮预热结束
+    void progress(int done, int total, int failed);
+    void thumbnailReady(const QString &filePath, const QImage &image);
+
+private:
+    void enqueue(const QStringList &files);
+    void onConversionFinished(quint64 job, const QString &inputPath, bool ok, const QString &pdfPath);
+    // 缩略图已在磁盘缓存中时跳过（在后台线程检查）
+    void renderThumbnail(const QString &filePath, const QString &pdfPath);
+
+    OfficeConversionService *m_conversions {nullptr};
+    QSet<quint64> m_jobs;
+    int m_total {0};
+    int m_done {0};
+    int m_failed {0};
+    quint64 m_generation {0};  // cancel() 时递增，丢弃之后才列出的目录
+    qreal m_devicePixelRatio {1.0};
+    QThreadPool m_pool;  // 查询缩略图缓存
+    // 放在最后，先于其它成员析构：等待仍在渲染的首页
+    PdfThumbnailWorker m_thumbnails {1};
+};
+
+#endif // OFFICEPREWARMER_H
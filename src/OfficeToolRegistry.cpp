@@ -0,0 +1,247 @@
+#include "OfficeToolRegistry.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+namespace {
+using Tool = OfficeToolRegistry::Tool;
+using Kind = OfficeToolRegistry::Kind;
+
+// 保存格式或下面的格式表变化时递增，使保存的探测结果失效
+constexpr int kFormatVersion = 1;
+// 两次检查 PATH 指纹的最短间隔
+constexpr qint64 kRecheckIntervalMs = 5000;
+constexpr int kProbeTimeoutMs = 10000;
+
+// 不在 PATH 中时查找的安装位置
+const QStringList kLibreOfficePaths = {
+    "/usr/bin/libreoffice",
+    "/usr/bin/soffice",
+    "/opt/libreoffice/program/soffice",
+    "/snap/bin/libreoffice"
+};
+// Deepin/UOS 的 WPS 可能安装在 /opt/apps 目录
+const QString kWpsPath = "/opt/apps/cn.wps.wps-office/files/bin/wps";
+
+const QStringList kLibreOfficeFormats = {
+    "doc", "docx", "dot", "dotx", "xls", "xlsx", "xlt", "xltx", "ppt", "pptx", "pot", "potx",
+    "odt", "ott", "ods", "ots", "odp", "otp", "rtf"
+};
+// WPS 额外支持金山自有格式，不读取 ODF 模板
+const QStringList kWpsFormats = {
+    "doc", "docx", "dot", "dotx", "xls", "xlsx", "xlt", "xltx", "ppt", "pptx", "pot", "potx",
+    "rtf", "wps", "et", "dps"
+};
+const QStringList kOnlyOfficeFormats = {
+    "doc", "docx", "dotx", "xls", "xlsx", "xltx", "ppt", "pptx", "potx", "odt", "ods", "odp", "rtf"
+};
+// pandoc 输入格式名与扩展名相同，实际支持哪些由 --list-input-formats 给出
+const QStringList kPandocCandidates = {"docx", "odt", "rtf"};
+
+struct RegistryState {
+    QMutex mutex;  // 查找期间一直持有，其它调用方等待结果
+    bool detected {false};
+    QString fingerprint;
+    QElapsedTimer lastCheck;
+    QList<Tool> tools;
+};
+
+RegistryState &registryState() {
+    static RegistryState state;
+    return state;
+}
+
+qint64 modifiedTime(const QString &path) {
+    const QFileInfo fi(path);
+    return fi.exists() ? fi.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+// 安装或卸载软件会改变所在目录的修改时间；只需 stat 几个目录，比逐个查找工具便宜得多
+QString pathFingerprint() {
+    const QString path = QString::fromLocal8Bit(qgetenv("PATH"));
+    QStringList parts = {QString::number(kFormatVersion), path};
+    for (const QString &dir : path.split(QDir::listSeparator(), Qt::SkipEmptyParts)) {
+        parts << QString::number(modifiedTime(dir));
+    }
+    for (const QString &file : kLibreOfficePaths) parts << QString::number(modifiedTime(file));
+    parts << QString::number(modifiedTime(kWpsPath));
+    return QString::fromLatin1(QCryptographicHash::hash(parts.join('\n').toUtf8(), QCryptographicHash::Md5).toHex());
+}
+
+// 运行工具的查询命令并返回输出；超时或失败时返回空字符串
+QString runProbe(const QString &program, const QStringList &arguments) {
+    QProcess proc;
+    proc.setProgram(program);
+    proc.setArguments(arguments);
+    proc.setProcessChannelMode(QProcess::MergedChannels);
+    proc.start();
+    if (!proc.waitForFinished(kProbeTimeoutMs)) {
+        proc.kill();
+        proc.waitForFinished();
+        return QString();
+    }
+    if (proc.exitStatus() != QProcess::NormalExit || proc.exitCode() != 0) return QString();
+    return QString::fromLocal8Bit(proc.readAllStandardOutput());
+}
+
+// 取 --version 输出中的第一个版本号，如 "LibreOffice 7.3.7.2 30(Build:2)" -> "7.3.7.2"
+QString probeVersion(const QString &program) {
+    static const QRegularExpression versionPattern("\\d+(\\.\\d+)+");
+    return versionPattern.match(runProbe(program, {"--version"})).captured(0);
+}
+
+Tool makeTool(Kind kind, const QString &name, const QString &program, const QStringList &pdfFormats) {
+    Tool tool;
+    tool.kind = kind;
+    tool.name = name;
+    tool.program = program;
+    tool.pdfFormats = pdfFormats;
+    return tool;
+}
+
+QList<Tool> detectTools() {
+    QList<Tool> tools;
+
+    const QString unoconv = QStandardPaths::findExecutable("unoconv");
+    if (!unoconv.isEmpty()) {
+        // unoconv 由 LibreOffice 完成转换，支持的格式相同
+        tools << makeTool(Kind::Unoconv, "Unoconv", unoconv, kLibreOfficeFormats);
+        tools.last().version = probeVersion(unoconv);
+    }
+
+    QString soffice = QStandardPaths::findExecutable("soffice");
+    if (soffice.isEmpty()) soffice = QStandardPaths::findExecutable("libreoffice");
+    for (int i = 0; soffice.isEmpty() && i < kLibreOfficePaths.size(); ++i) {
+        if (QFileInfo(kLibreOfficePaths[i]).isExecutable()) soffice = kLibreOfficePaths[i];
+    }
+    if (!soffice.isEmpty()) {
+        tools << makeTool(Kind::LibreOffice, "LibreOffice", soffice, kLibreOfficeFormats);
+        tools.last().version = probeVersion(soffice);
+    }
+
+    // WPS 和 OnlyOffice 没有只输出版本的命令行参数，运行它们会打开窗口，不探测版本
+    QString wps = QStandardPaths::findExecutable("wps");
+    if (wps.isEmpty() && QFileInfo(kWpsPath).isExecutable()) wps = kWpsPath;
+    if (!wps.isEmpty()) tools << makeTool(Kind::WPS, "WPS Office", wps, kWpsFormats);
+
+    const QString pandoc = QStandardPaths::findExecutable("pandoc");
+    if (!pandoc.isEmpty()) {
+        // pandoc 输出 PDF 需要默认的 LaTeX 引擎 pdflatex，没有时只能用于其它用途
+        QStringList formats;
+        if (!QStandardPaths::findExecutable("pdflatex").isEmpty()) {
+            const QStringList inputs = runProbe(pandoc, {"--list-input-formats"}).split('\n', Qt::SkipEmptyParts);
+            for (const QString &format : kPandocCandidates) {
+                if (inputs.contains(format)) formats << format;
+            }
+        }
+        tools << makeTool(Kind::Pandoc, "Pandoc", pandoc, formats);
+        tools.last().version = probeVersion(pandoc);
+    }
+
+    QString onlyoffice = QStandardPaths::findExecutable("onlyoffice-desktopeditors");
+    if (onlyoffice.isEmpty()) onlyoffice = QStandardPaths::findExecutable("desktopeditors");
+    if (!onlyoffice.isEmpty()) tools << makeTool(Kind::OnlyOffice, "OnlyOffice", onlyoffice, kOnlyOfficeFormats);
+
+    // 只能提取文本，不能生成 PDF
+    const QString docx2txt = QStandardPaths::findExecutable("docx2txt");
+    if (!docx2txt.isEmpty()) tools << makeTool(Kind::TextExtract, "Text Extract", docx2txt, {});
+
+    return tools;
+}
+
+bool loadTools(const QString &fingerprint, QList<Tool> &tools) {
+    QSettings settings;
+    if (settings.value("office/toolsFingerprint").toString() != fingerprint) return false;
+    tools.clear();
+    const int count = settings.beginReadArray("office/tools");
+    for (int i = 0; i < count; ++i) {
+        settings.setArrayIndex(i);
+        Tool tool;
+        tool.kind = Kind(settings.value("kind").toInt());
+        tool.name = settings.value("name").toString();
+        tool.program = settings.value("program").toString();
+        tool.version = settings.value("version").toString();
+        tool.pdfFormats = settings.value("pdfFormats").toStringList();
+        tools << tool;
+    }
+    settings.endArray();
+    return true;
+}
+
+void saveTools(const QString &fingerprint, const QList<Tool> &tools) {
+    QSettings settings;
+    settings.beginWriteArray("office/tools", int(tools.size()));
+    for (int i = 0; i < tools.size(); ++i) {
+        settings.setArrayIndex(i);
+        settings.setValue("kind", int(tools[i].kind));
+        settings.setValue("name", tools[i].name);
+        settings.setValue("program", tools[i].program);
+        settings.setValue("version", tools[i].version);
+        settings.setValue("pdfFormats", tools[i].pdfFormats);
+    }
+    settings.endArray();
+    settings.setValue("office/toolsFingerprint", fingerprint);
+}
+
+// 在持有锁时调用
+void refresh(RegistryState &state) {
+    if (state.detected && state.lastCheck.elapsed() < kRecheckIntervalMs) return;
+    const QString fingerprint = pathFingerprint();
+    state.lastCheck.start();
+    if (state.detected && fingerprint == state.fingerprint) return;
+    state.detected = true;
+    state.fingerprint = fingerprint;
+    if (loadTools(fingerprint, state.tools)) return;
+    state.tools = detectTools();
+    saveTools(fingerprint, state.tools);
+}
+}
+
+void OfficeToolRegistry::startDetection() {
+    QtConcurrent::run([]() { tools(); });
+}
+
+QList<OfficeToolRegistry::Tool> OfficeToolRegistry::tools() {
+    RegistryState &state = registryState();
+    QMutexLocker locker(&state.mutex);
+    refresh(state);
+    return state.tools;
+}
+
+bool OfficeToolRegistry::tryTools(QList<Tool> &tools) {
+    RegistryState &state = registryState();
+    if (!state.mutex.tryLock()) return false;
+    const bool ready = state.detected;
+    if (ready) tools = state.tools;
+    state.mutex.unlock();
+    return ready;
+}
+
+bool OfficeToolRegistry::toolForFormat(const QString &suffix, Tool &tool) {
+    const QString format = suffix.toLower();
+    for (const Tool &candidate : tools()) {
+        if (!candidate.pdfFormats.contains(format)) continue;
+        tool = candidate;
+        return true;
+    }
+    return false;
+}
+
+bool OfficeToolRegistry::find(Kind kind, Tool &tool) {
+    for (const Tool &candidate : tools()) {
+        if (candidate.kind != kind) continue;
+        tool = candidate;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,37 @@
+#ifndef OFFICETOOLREGISTRY_H
+#define OFFICETOOLREGISTRY_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// 已安装的办公文档转换工具：程序启动时在后台线程查找一次，并探测各工具的版本和能转换的格式。
+// 结果连同 PATH 指纹（PATH 本身、其中各目录及常见安装位置的修改时间）保存在配置文件中，
+// 指纹不变时下次启动直接使用；之后的查询只在指纹变化（安装或卸载了软件）时重新查找。
+// 转换时按文件格式在能处理它的工具中选择。可在任意线程调用
+class OfficeToolRegistry {
+public:
+    // 同一格式有多个工具可以转换时按此顺序选择
+    enum class Kind { Unoconv, LibreOffice, WPS, Pandoc, OnlyOffice, TextExtract };
+
+    struct Tool {
+        Kind kind {Kind::LibreOffice};
+        QString name;            // 显示名称
+        QString program;
+        QString version;         // 探测到的版本号，无法获取时为空
+        QStringList pdfFormats;  // 能转换为 PDF 的扩展名（小写）
+    };
+
+    // 在后台线程开始查找（程序启动时调用）
+    static void startDetection();
+    // 已安装的工具，按选择顺序排列。第一次调用或指纹变化时要等待查找和版本探测（可能需要数秒），不应在界面线程调用
+    static QList<Tool> tools();
+    // 不等待的查询（可在界面线程调用）：取得上次查找的结果；查找尚未完成或正在进行时返回 false
+    static bool tryTools(QList<Tool> &tools);
+    // 能把该扩展名的文件转换为 PDF 的工具中排在最前的一个
+    static bool toolForFormat(const QString &suffix, Tool &tool);
+    // 指定种类的工具
+    static bool find(Kind kind, Tool &tool);
+};
+
+#endif // OFFICETOOLREGISTRY_H
@@ -0,0 +1,74 @@
+#include "ParallelSort.h"
+
+#include <QFuture>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+namespace {
+// 少于该数量时单线程排序更快
+constexpr size_t kParallelThreshold = 32768;
+
+void runAll(int count, const std::function<void(int)> &task) {
+    QVector<QFuture<void>> futures;
+    futures.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        futures.append(QtConcurrent::run([&task, i]() { task(i); }));
+    }
+    // 尚未开始的任务会在等待时由当前线程直接执行，线程池被占满也不会卡住
+    for (QFuture<void> &future : futures) future.waitForFinished();
+}
+}
+
+void ParallelSort::sort(std::vector<quint32> &items, const Less &less, size_t sortedCount) {
+    sortedCount = std::min(sortedCount, items.size());
+    const size_t added = items.size() - sortedCount;
+    if (added == 0) return;
+    // 新增部分比原有部分还多时直接整体重排
+    if (sortedCount == 0 || added > sortedCount) {
+        sortAll(items, less);
+        return;
+    }
+    std::vector<quint32> tail(items.begin() + sortedCount, items.end());
+    sortAll(tail, less);
+    std::copy(tail.begin(), tail.end(), items.begin() + sortedCount);
+    std::inplace_merge(items.begin(), items.begin() + sortedCount, items.end(), less);
+}
+
+void ParallelSort::sortAll(std::vector<quint32> &items, const Less &less) {
+    const size_t n = items.size();
+    const int threads = QThread::idealThreadCount();
+    if (n < kParallelThreshold || threads < 2) {
+        std::stable_sort(items.begin(), items.end(), less);
+        return;
+    }
+
+    // 段数取 2 的幂，便于逐轮两两归并
+    size_t parts = 1;
+    while (parts < size_t(threads)) parts *= 2;
+    std::vector<size_t> bounds(parts + 1);
+    for (size_t i = 0; i <= parts; ++i) bounds[i] = n * i / parts;
+
+    runAll(int(parts), [&](int i) {
+        std::stable_sort(items.begin() + bounds[i], items.begin() + bounds[i + 1], less);
+    });
+
+    // std::merge 相等时先取前一段，归并结果仍是稳定的
+    std::vector<quint32> buffer(n);
+    std::vector<quint32> *source = &items;
+    std::vector<quint32> *target = &buffer;
+    for (size_t width = 1; width < parts; width *= 2) {
+        const int pairs = int(parts / (2 * width));
+        runAll(pairs, [&](int pair) {
+            const size_t first = size_t(pair) * 2 * width;
+            const auto begin = source->begin();
+            std::merge(begin + bounds[first], begin + bounds[first + width],
+                       begin + bounds[first + width], begin + bounds[first + 2 * width],
+                       target->begin() + bounds[first], less);
+        });
+        std::swap(source, target);
+    }
+    if (source != &items) items.swap(*source);
+}
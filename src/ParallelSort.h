@@ -0,0 +1,23 @@
+#ifndef PARALLELSORT_H
+#define PARALLELSORT_H
+
+#include <QtGlobal>
+
+#include <functional>
+#include <vector>
+
+// 大数组的稳定排序：分段在线程池中各自排序，再逐轮两两归并（每轮的各对也并行）。
+// 比较函数会在多个线程中同时调用，只能读取共享数据
+class ParallelSort {
+public:
+    using Less = std::function<bool(quint32, quint32)>;
+
+    // 对 items 稳定排序。sortedCount 表示开头已排好序的元素个数：
+    // 只追加了少量元素时只排新元素再与原有部分归并，不重排整个数组
+    static void sort(std::vector<quint32> &items, const Less &less, size_t sortedCount = 0);
+
+private:
+    static void sortAll(std::vector<quint32> &items, const Less &less);
+};
+
+#endif // PARALLELSORT_H
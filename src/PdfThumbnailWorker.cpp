@@ -0,0 +1,86 @@
+#include "PdfThumbnailWorker.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutexLocker>
+#ifdef HAVE_QT_PDF_CORE
+#include <QtPdf/QPdfDocument>
+#endif
+
+PdfThumbnailWorker::PdfThumbnailWorker(int maxDocuments) {
+    m_pool.setMaxThreadCount(qMax(1, maxDocuments));
+    // 空闲一段时间后线程退出，同时释放其持有的文档
+    m_pool.setExpiryTimeout(60 * 1000);
+}
+
+PdfThumbnailWorker::~PdfThumbnailWorker() {
+    cancelPending();
+    waitForDone();
+}
+
+void PdfThumbnailWorker::setLimits(qint64 maxFileBytes, int timeoutMs) {
+    QMutexLocker locker(&m_mutex);
+    m_maxFileBytes = maxFileBytes;
+    m_timeoutMs = timeoutMs;
+}
+
+void PdfThumbnailWorker::render(const QString &filePath, const QSize &bound, std::function<void(const QImage &)> done) {
+    m_pool.start([this, filePath, bound, done]() {
+        done(renderFirstPage(filePath, bound));
+    });
+}
+
+void PdfThumbnailWorker::cancelPending() {
+    m_pool.clear();
+}
+
+void PdfThumbnailWorker::waitForDone() {
+    m_pool.waitForDone();
+}
+
+QImage PdfThumbnailWorker::renderFirstPage(const QString &filePath, const QSize &bound) {
+#ifdef HAVE_QT_PDF_CORE
+    const QFileInfo info(filePath);
+    const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+    qint64 maxFileBytes = 0;
+    int timeoutMs = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        maxFileBytes = m_maxFileBytes;
+        timeoutMs = m_timeoutMs;
+        if (m_slowFiles.value(filePath, -1) == mtime) return QImage();
+    }
+    if (maxFileBytes > 0 && info.size() > maxFileBytes) return QImage();
+
+    if (!m_documents.hasLocalData()) {
+        m_documents.setLocalData(new QPdfDocument());
+    }
+    QPdfDocument *pdfDoc = m_documents.localData();
+
+    QElapsedTimer timer;
+    timer.start();
+    QImage page;
+    if (pdfDoc->load(filePath) == QPdfDocument::Error::None && pdfDoc->pageCount() > 0) {
+        // QPdfDocument::load 无法中途打断，只能在加载完成后检查耗时，超时则跳过最耗时的页面渲染
+        const QSizeF pageSize = pdfDoc->pagePointSize(0);
+        if ((timeoutMs <= 0 || timer.elapsed() <= timeoutMs) && !pageSize.isEmpty()) {
+            const QSize renderSize = pageSize.scaled(QSizeF(bound), Qt::KeepAspectRatio).toSize();
+            page = pdfDoc->render(0, renderSize);
+        }
+    }
+    // 文档实例留给下一个文件复用，只释放当前文件的内容
+    pdfDoc->close();
+
+    // 超时的文件记下来，文件未修改前不再重试
+    if (timeoutMs > 0 && timer.elapsed() > timeoutMs) {
+        QMutexLocker locker(&m_mutex);
+        m_slowFiles.insert(filePath, mtime);
+    }
+    return page;
+#else
+    Q_UNUSED(filePath);
+    Q_UNUSED(bound);
+    return QImage();
+#endif
+}
@@ -0,0 +1,45 @@
+#ifndef PDFTHUMBNAILWORKER_H
+#define PDFTHUMBNAILWORKER_H
+
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QThreadStorage>
+
+#include <functional>
+
+class QPdfDocument;
+
+// PDF 首页缩略图的专用后台线程池：与图片缩略图分开排队，大体积 PDF 不会占满通用工作线程。
+// 每个工作线程复用一个 QPdfDocument，文档实例数量受线程数限制
+class PdfThumbnailWorker {
+public:
+    explicit PdfThumbnailWorker(int maxDocuments = 2);
+    ~PdfThumbnailWorker();
+
+    // 超过 maxFileBytes 的文件不渲染；加载耗时超过 timeoutMs 的文件放弃渲染并记住，之后直接返回空图像
+    void setLimits(qint64 maxFileBytes, int timeoutMs);
+
+    // 在后台线程渲染首页（不超过 bound 物理像素），完成后在该后台线程调用 done；失败时 image 为空
+    void render(const QString &filePath, const QSize &bound, std::function<void(const QImage &)> done);
+
+    // 丢弃尚未开始的任务（正在渲染的页面无法中断）
+    void cancelPending();
+    void waitForDone();
+
+private:
+    QImage renderFirstPage(const QString &filePath, const QSize &bound);
+
+    // 声明在线程池之前，因此晚于线程池析构：线程池析构时工作线程退出，由 QThreadStorage 释放各自的文档
+    QThreadStorage<QPdfDocument *> m_documents;
+    QThreadPool m_pool;
+    QMutex m_mutex;
+    // 超时文件 -> 当时的修改时间，文件更新后重新尝试
+    QHash<QString, qint64> m_slowFiles;
+    qint64 m_maxFileBytes {100LL * 1024 * 1024};
+    int m_timeoutMs {3000};
+};
+
+#endif // PDFTHUMBNAILWORKER_H
@@ -0,0 +1,183 @@
+#include "StreamingFilterProxyModel.h"
+#include "CaseFoldedMatcher.h"
+
+#include <QFileSystemModel>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace {
+// 每批匹配的条目数，以及合并刷新的最短间隔（避免每批都让视图重新筛选一遍）
+constexpr size_t kBatchSize = 8192;
+constexpr int kFlushIntervalMs = 100;
+}
+
+StreamingFilterProxyModel::StreamingFilterProxyModel(QObject *parent) : QSortFilterProxyModel(parent) {
+    // 同时只需一个任务在匹配，新一轮排在已取消的旧任务之后
+    m_pool.setMaxThreadCount(1);
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kFlushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &StreamingFilterProxyModel::flush);
+}
+
+StreamingFilterProxyModel::~StreamingFilterProxyModel() {
+    // 后台任务会向本对象投递结果，等所有任务（包括已取消但尚未退出的）结束后再析构
+    cancelJob();
+    m_pool.waitForDone();
+}
+
+void StreamingFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel) {
+    if (this->sourceModel()) disconnect(this->sourceModel(), nullptr, this, nullptr);
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+    m_root = QPersistentModelIndex();
+    m_candidates.reset();
+    if (!sourceModel) return;
+
+    // 在基类的处理之后执行：新增的行已按旧结果被筛掉，这里补上匹配的行
+    connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &StreamingFilterProxyModel::onRowsInserted);
+    connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &StreamingFilterProxyModel::onRowsRemoved);
+    connect(sourceModel, &QAbstractItemModel::modelReset, this, [this]() {
+        cancelJob();
+        // 已投递但尚未处理的批次引用的是重置前的节点，按轮次丢弃
+        ++m_generation;
+        m_lateMatches.clear();
+        m_candidates.reset();
+        m_accepted.clear();
+        m_finished = true;
+    });
+}
+
+void StreamingFilterProxyModel::sort(int column, Qt::SortOrder order) {
+    if (sourceModel()) sourceModel()->sort(column, order);
+}
+
+void StreamingFilterProxyModel::setFilterRoot(const QModelIndex &sourceRoot) {
+    if (m_root == sourceRoot) return;
+    m_root = sourceRoot;
+    m_candidates.reset();
+    m_accepted.clear();
+    if (isFiltering()) restart();
+}
+
+void StreamingFilterProxyModel::setFilterText(const QString &text) {
+    if (text == m_text) return;
+    m_text = text;
+    restart();
+}
+
+bool StreamingFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const {
+    if (m_text.isEmpty() || !m_root.isValid() || m_root != sourceParent) return true;
+    return m_accepted.contains(sourceModel()->index(sourceRow, 0, sourceParent).internalPointer());
+}
+
+void StreamingFilterProxyModel::cancelJob() {
+    if (m_cancel) m_cancel->store(true);
+    m_cancel.reset();
+    m_flushTimer->stop();
+}
+
+void StreamingFilterProxyModel::restart() {
+    cancelJob();
+    ++m_generation;
+    m_lateMatches.clear();
+    if (m_text.isEmpty() || !m_root.isValid() || !sourceModel()) {
+        m_accepted.clear();
+        m_finished = true;
+        flush();
+        return;
+    }
+
+    m_finished = false;
+    m_replaceOnNextBatch = true;
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    m_cancel = cancelled;
+
+    // 后台只读取文件名快照，不访问模型；结果带上轮次编号，过期的批次在界面线程丢弃
+    const std::shared_ptr<const Candidates> list = candidates();
+    const CaseFoldedMatcher matcher(m_text);
+    const quint64 generation = m_generation;
+    m_pool.start([this, list, matcher, cancelled, generation]() {
+        QVector<const void *> matched;
+        for (size_t begin = 0;; begin += kBatchSize) {
+            if (cancelled->load()) return;
+            const size_t end = std::min(begin + kBatchSize, list->size());
+            for (size_t i = begin; i < end; ++i) {
+                if (matcher.matches((*list)[i].name)) matched.append((*list)[i].node);
+            }
+            const bool last = end == list->size();
+            QMetaObject::invokeMethod(this, [this, generation, matched, last]() {
+                applyBatch(generation, matched, last);
+            }, Qt::QueuedConnection);
+            if (last) return;
+            matched.clear();
+        }
+    });
+}
+
+std::shared_ptr<const StreamingFilterProxyModel::Candidates> StreamingFilterProxyModel::candidates() {
+    if (m_candidates) return m_candidates;
+    auto list = std::make_shared<Candidates>();
+    QAbstractItemModel *model = sourceModel();
+    const int rows = model->rowCount(m_root);
+    list->reserve(rows);
+    for (int row = 0; row < rows; ++row) {
+        const QModelIndex index = model->index(row, 0, m_root);
+        list->push_back({index.internalPointer(), index.data(QFileSystemModel::FileNameRole).toString()});
+    }
+    m_candidates = list;
+    return m_candidates;
+}
+
+void StreamingFilterProxyModel::applyBatch(quint64 generation, const QVector<const void *> &matched, bool last) {
+    if (generation != m_generation) return;
+    if (m_replaceOnNextBatch) {
+        // 本轮开始后新增的行已单独匹配过，保留下来
+        m_accepted = m_lateMatches;
+        m_replaceOnNextBatch = false;
+    }
+    for (const void *node : matched) m_accepted.insert(node);
+
+    if (last) {
+        m_finished = true;
+        m_cancel.reset();
+        flush();
+    } else if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void StreamingFilterProxyModel::flush() {
+    m_flushTimer->stop();
+    invalidateFilter();
+    emit filterUpdated(m_finished);
+}
+
+void StreamingFilterProxyModel::onRowsInserted(const QModelIndex &parent, int first, int last) {
+    if (!m_root.isValid() || m_root != parent) return;
+    m_candidates.reset();
+    if (!isFiltering()) return;
+
+    // 新增的行通常很少（目录监视或逐批加载），直接在界面线程匹配
+    const CaseFoldedMatcher matcher(m_text);
+    for (int row = first; row <= last; ++row) {
+        const QModelIndex index = sourceModel()->index(row, 0, parent);
+        const void *node = index.internalPointer();
+        if (matcher.matches(index.data(QFileSystemModel::FileNameRole).toString())) {
+            m_accepted.insert(node);
+            if (!m_finished) m_lateMatches.insert(node);
+        } else {
+            // 节点地址可能被复用，清掉已删除节点留下的旧结果
+            m_accepted.remove(node);
+            m_lateMatches.remove(node);
+        }
+    }
+    if (!m_flushTimer->isActive()) m_flushTimer->start();
+}
+
+void StreamingFilterProxyModel::onRowsRemoved(const QModelIndex &parent) {
+    if (!m_root.isValid() || m_root != parent) return;
+    m_candidates.reset();
+    // 正在进行的一轮用的快照里有已删除的节点，重新开始以免其地址被新节点复用后误判
+    if (isFiltering() && !m_finished) restart();
+}
@@ -0,0 +1,74 @@
+#ifndef STREAMINGFILTERPROXYMODEL_H
+#define STREAMINGFILTERPROXYMODEL_H
+
+#include <QPersistentModelIndex>
+#include <QSet>
+#include <QSortFilterProxyModel>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QTimer;
+
+// 目录内筛选：只筛选当前目录（filterRoot）的直接子项，祖先目录等其它节点原样保留。
+// 文件名匹配在后台线程按批进行，每批的结果回到界面线程后合并刷新，
+// 大目录中输入时界面不会卡住，匹配到的条目陆续出现。
+// 排序交给源模型（QFileSystemModel 的目录在前、按数值比较大小等规则），代理保持源模型的顺序
+class StreamingFilterProxyModel : public QSortFilterProxyModel {
+    Q_OBJECT
+public:
+    explicit StreamingFilterProxyModel(QObject *parent = nullptr);
+    ~StreamingFilterProxyModel() override;
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    void setFilterRoot(const QModelIndex &sourceRoot);
+    QModelIndex filterRoot() const { return m_root; }
+    // 忽略大小写的子串筛选，空字符串表示不筛选
+    void setFilterText(const QString &text);
+    QString filterText() const { return m_text; }
+    bool isFiltering() const { return !m_text.isEmpty(); }
+
+signals:
+    // 每次合并结果后发出；finished 为 true 表示当前目录已全部匹配完
+    void filterUpdated(bool finished);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    struct Candidate {
+        const void *node;
+        QString name;
+    };
+    using Candidates = std::vector<Candidate>;
+
+    void restart();
+    void cancelJob();
+    // 当前目录子项的节点和文件名，目录内容不变时各次筛选共用
+    std::shared_ptr<const Candidates> candidates();
+    void applyBatch(quint64 generation, const QVector<const void *> &matched, bool last);
+    void flush();
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsRemoved(const QModelIndex &parent);
+
+    QPersistentModelIndex m_root;
+    QString m_text;
+    QSet<const void *> m_accepted;
+    QSet<const void *> m_lateMatches;  // 本轮开始后新增并匹配的行
+    bool m_replaceOnNextBatch {false};  // 新一轮的第一批结果到达时替换旧结果，避免列表先被清空
+    bool m_finished {true};
+
+    std::shared_ptr<const Candidates> m_candidates;
+    quint64 m_generation {0};
+    std::shared_ptr<std::atomic_bool> m_cancel;
+    QThreadPool m_pool;  // 匹配任务；取消的任务在下一批之前退出
+    QTimer *m_flushTimer {nullptr};
+};
+
+#endif // STREAMINGFILTERPROXYMODEL_H
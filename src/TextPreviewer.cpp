@@ -3,6 +3,7 @@
 #include <QFile>
 #include <QTextStream>
 #include <QFileInfo>
+#include <QTextBlock>
 
 TextPreviewer::TextPreviewer(QWidget *parent) : QPlainTextEdit(parent) {
     setReadOnly(true);
@@ -10,6 +11,7 @@ TextPreviewer::TextPreviewer(QWidget *parent) : QPlainTextEdit(parent) {
 }
 
 bool TextPreviewer::loadText(const QString &path) {
+    setExtraSelections({});
     QFileInfo fi(path);
     if (!fi.exists() || !fi.isFile()) return false;
 
@@ -34,3 +36,17 @@ bool TextPreviewer::loadText(const QString &path) {
     document()->setDefaultFont(QFont("Monospace"));
     return true;
 }
+
+void TextPreviewer::highlightLine(int line) {
+    const QTextBlock block = document()->findBlockByNumber(line - 1);
+    if (!block.isValid()) return;
+    QTextCursor cursor(block);
+    setTextCursor(cursor);
+    centerCursor();
+
+    QTextEdit::ExtraSelection selection;
+    selection.format.setBackground(palette().highlight().color().lighter(160));
+    selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+    selection.cursor = cursor;
+    setExtraSelections({selection});
+}
@@ -8,6 +8,8 @@ class TextPreviewer : public QPlainTextEdit {
 public:
     explicit TextPreviewer(QWidget *parent = nullptr);
     bool loadText(const QString &path);
+    // 滚动到第 line 行（从 1 开始）并高亮整行
+    void highlightLine(int line);
 };
 
 #endif // TEXTPREVIEWER_H
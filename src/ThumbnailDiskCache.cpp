@@ -0,0 +1,145 @@
+#include "ThumbnailDiskCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+namespace {
+// 缩略图绘制方式变化时递增，使旧缓存全部失效
+const int kFormatVersion = 2;
+// 命中的文件超过这么久没有更新修改时间时更新它，清理时按修改时间近似最近使用的顺序
+constexpr qint64 kTouchIntervalSecs = 24 * 3600;
+
+struct PruneState {
+    QMutex mutex;
+    bool queued {false};
+    bool checked {false};     // 本次运行中是否已检查过总大小
+    qint64 writtenBytes {0};  // 上次检查以来写入的字节数
+};
+
+PruneState &pruneState() {
+    static PruneState state;
+    return state;
+}
+
+qint64 budgetBytes() {
+    static const qint64 budget = QSettings().value("thumbnails/cacheMegabytes", 512).toLongLong() * 1024 * 1024;
+    return budget;
+}
+
+// 总大小超出预算时删除最久未使用的文件，删到预算的九成，避免之后每次写入都要清理
+void prune(const QString &dir) {
+    QFileInfoList files = QDir(dir).entryInfoList({"*.png"}, QDir::Files);
+    qint64 total = 0;
+    for (const QFileInfo &fi : files) total += fi.size();
+    const qint64 budget = budgetBytes();
+    if (total <= budget) return;
+    std::sort(files.begin(), files.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastModified() < b.lastModified();
+    });
+    const qint64 target = budget / 10 * 9;
+    for (const QFileInfo &fi : files) {
+        if (total <= target) break;
+        if (QFile::remove(fi.absoluteFilePath())) total -= fi.size();
+    }
+}
+
+// 每次运行的第一次写入，以及之后每写入预算的十分之一，在后台检查一次总大小
+void notePruneNeeded(const QString &dir, qint64 bytes) {
+    PruneState &state = pruneState();
+    {
+        QMutexLocker locker(&state.mutex);
+        state.writtenBytes += bytes;
+        if (state.queued || (state.checked && state.writtenBytes < budgetBytes() / 10)) return;
+        state.queued = true;
+        state.checked = true;
+        state.writtenBytes = 0;
+    }
+    QtConcurrent::run([dir]() {
+        prune(dir);
+        PruneState &state = pruneState();
+        QMutexLocker locker(&state.mutex);
+        state.queued = false;
+    });
+}
+}
+
+QString ThumbnailDiskCache::cacheDir() {
+    static const QString dir = [] {
+        const QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+        QDir().mkpath(path);
+        return path;
+    }();
+    return dir;
+}
+
+QString ThumbnailDiskCache::entryPath(const QString &filePath, qreal dpr) {
+    const QFileInfo fi(filePath);
+    const QString canonical = fi.canonicalFilePath();
+    if (canonical.isEmpty() || !fi.isFile()) return QString();
+
+    const QByteArray key = QString("%1\n%2\n%3\n%4@%5")
+        .arg(canonical)
+        .arg(fi.lastModified().toMSecsSinceEpoch())
+        .arg(fi.size())
+        .arg(kFormatVersion)
+        .arg(dpr)
+        .toUtf8();
+    const QByteArray hash = QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex();
+    return cacheDir() + "/" + QString::fromLatin1(hash) + ".png";
+}
+
+QImage ThumbnailDiskCache::load(const QString &filePath, qreal dpr) {
+    const QString entry = entryPath(filePath, dpr);
+    if (entry.isEmpty()) return QImage();
+    const QFileInfo entryInfo(entry);
+    if (!entryInfo.exists()) return QImage();
+
+    // PNG 不保存像素比，读回后恢复
+    QImageReader reader(entry, "png");
+    QImage image = reader.read();
+    image.setDevicePixelRatio(dpr);
+    if (!image.isNull() && entryInfo.lastModified().secsTo(QDateTime::currentDateTime()) > kTouchIntervalSecs) {
+        // 记录最近使用，清理时保留
+        QFile file(entry);
+        if (file.open(QIODevice::Append)) file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    return image;
+}
+
+void ThumbnailDiskCache::store(const QString &filePath, const QImage &image) {
+    if (image.isNull()) return;
+    const QString entry = entryPath(filePath, image.devicePixelRatio());
+    if (entry.isEmpty()) return;
+
+    const QFileInfo fi(filePath);
+    QImage tagged = image;
+    tagged.setText("Thumb::URI", QUrl::fromLocalFile(fi.canonicalFilePath()).toString(QUrl::FullyEncoded));
+    tagged.setText("Thumb::MTime", QString::number(fi.lastModified().toSecsSinceEpoch()));
+    tagged.setText("Thumb::Size", QString::number(fi.size()));
+    tagged.setText("Software", "FileManagerPreview");
+
+    // 先写临时文件再替换，避免并发读取到不完整的 PNG
+    QSaveFile file(entry);
+    if (!file.open(QIODevice::WriteOnly)) return;
+    QImageWriter writer(&file, "png");
+    if (!writer.write(tagged)) {
+        file.cancelWriting();
+        return;
+    }
+    const qint64 bytes = file.size();
+    if (file.commit()) notePruneNeeded(cacheDir(), bytes);
+}
+
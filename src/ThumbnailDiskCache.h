@@ -0,0 +1,24 @@
+#ifndef THUMBNAILDISKCACHE_H
+#define THUMBNAILDISKCACHE_H
+
+#include <QImage>
+#include <QString>
+
+// 缩略图磁盘缓存：CacheLocation/thumbnails 下的 PNG 文件
+// 参照 freedesktop 缩略图规范，文件名为键的 MD5，PNG 文本块记录 Thumb::URI/Thumb::MTime/Thumb::Size；
+// 键由规范路径 + 修改时间 + 文件大小（以及设备像素比）组成，文件变化后自动失效。
+// 失效的旧文件不会再被读到，总大小超过 thumbnails/cacheMegabytes 时在后台按最近使用时间删除。可在任意线程调用。
+class ThumbnailDiskCache {
+public:
+    // 读取缓存；未命中或已失效返回空图像
+    static QImage load(const QString &filePath, qreal dpr);
+
+    // 写入缓存（原子替换），像素比取自 image.devicePixelRatio()
+    static void store(const QString &filePath, const QImage &image);
+
+private:
+    static QString cacheDir();
+    static QString entryPath(const QString &filePath, qreal dpr);
+};
+
+#endif // THUMBNAILDISKCACHE_H
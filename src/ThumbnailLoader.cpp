@@ -0,0 +1,143 @@
+#include "ThumbnailLoader.h"
+#include "ThumbnailRenderer.h"
+#include "ThumbnailDiskCache.h"
+
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+
+namespace {
+// 快速滚动时绘制请求会不断插到队首，超过上限的队尾（最早滚过的行）直接丢弃
+constexpr size_t kMaxQueuedJobs = 512;
+}
+
+ThumbnailLoader::ThumbnailLoader(QObject *parent) : QObject(parent) {
+    // 留出一个核心给界面线程和文件系统模型的信息收集线程
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+ThumbnailLoader::~ThumbnailLoader() {
+    cancelAll();
+    // 图片工作线程可能还会提交 PDF 任务，先等它们结束
+    m_pool.waitForDone();
+    m_pdfWorker.waitForDone();
+}
+
+void ThumbnailLoader::request(const QString &filePath) {
+    QMutexLocker locker(&m_mutex);
+    if (m_running.contains(filePath)) return;
+    if (m_queued.contains(filePath)) {
+        // 正在绘制的行优先级最高，移到队首
+        m_queue.erase(std::find(m_queue.begin(), m_queue.end(), filePath));
+    } else {
+        m_queued.insert(filePath);
+    }
+    m_queue.push_front(filePath);
+    while (m_queue.size() > kMaxQueuedJobs) {
+        m_queued.remove(m_queue.back());
+        m_queue.pop_back();
+    }
+    startWorkers();
+}
+
+void ThumbnailLoader::schedule(const QStringList &orderedPaths) {
+    QMutexLocker locker(&m_mutex);
+    m_queue.clear();
+    m_queued.clear();
+    for (const QString &path : orderedPaths) {
+        if (m_running.contains(path) || m_queued.contains(path)) continue;
+        m_queue.push_back(path);
+        m_queued.insert(path);
+    }
+    startWorkers();
+}
+
+void ThumbnailLoader::cancelAll() {
+    QMutexLocker locker(&m_mutex);
+    m_queue.clear();
+    m_queued.clear();
+    m_running.clear();
+    ++m_generation;
+    m_pdfWorker.cancelPending();
+}
+
+void ThumbnailLoader::setDevicePixelRatio(qreal dpr) {
+    QMutexLocker locker(&m_mutex);
+    m_devicePixelRatio = dpr;
+}
+
+void ThumbnailLoader::setPdfLimits(qint64 maxFileBytes, int timeoutMs) {
+    m_pdfWorker.setLimits(maxFileBytes, timeoutMs);
+}
+
+void ThumbnailLoader::startWorkers() {
+    const int wanted = qMin<int>(m_pool.maxThreadCount(), int(m_queue.size()));
+    while (m_activeWorkers < wanted) {
+        ++m_activeWorkers;
+        m_pool.start([this]() { workerLoop(); });
+    }
+}
+
+void ThumbnailLoader::workerLoop() {
+    for (;;) {
+        QString filePath;
+        quint64 generation = 0;
+        qreal dpr = 1.0;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_queue.empty()) {
+                --m_activeWorkers;
+                return;
+            }
+            filePath = m_queue.front();
+            m_queue.pop_front();
+            m_queued.remove(filePath);
+            m_running.insert(filePath);
+            generation = m_generation;
+            dpr = m_devicePixelRatio;
+        }
+
+        // 先查磁盘缓存，命中时无需解码源文件；按类型共享的占位图标不写入磁盘
+        QImage image = ThumbnailDiskCache::load(filePath, dpr);
+        if (!image.isNull()) {
+            finishJob(filePath, generation, image, QString());
+            continue;
+        }
+
+        if (ThumbnailRenderer::isPdfFile(filePath)) {
+            // PDF 交给专用线程池，当前线程继续处理图片和文本
+            m_pdfWorker.render(filePath, ThumbnailRenderer::pdfPageBound(dpr),
+                               [this, filePath, generation, dpr](const QImage &page) {
+                QString typeKey;
+                const QImage image = ThumbnailRenderer::renderPdfThumbnail(page, dpr, &typeKey);
+                if (typeKey.isEmpty()) {
+                    ThumbnailDiskCache::store(filePath, image);
+                }
+                finishJob(filePath, generation, image, typeKey);
+            });
+            continue;
+        }
+
+        QString typeKey;
+        image = ThumbnailRenderer::render(filePath, dpr, &typeKey);
+        if (typeKey.isEmpty()) {
+            ThumbnailDiskCache::store(filePath, image);
+        }
+        finishJob(filePath, generation, image, typeKey);
+    }
+}
+
+void ThumbnailLoader::finishJob(const QString &filePath, quint64 generation, const QImage &image, const QString &typeKey) {
+    {
+        // 切换目录后旧任务的结果不再需要
+        QMutexLocker locker(&m_mutex);
+        if (generation != m_generation) return;
+        m_running.remove(filePath);
+    }
+
+    QMetaObject::invokeMethod(this, [this, filePath, image, typeKey]() {
+        emit thumbnailReady(filePath, image, typeKey);
+    }, Qt::QueuedConnection);
+}
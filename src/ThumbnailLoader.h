@@ -0,0 +1,60 @@
+#ifndef THUMBNAILLOADER_H
+#define THUMBNAILLOADER_H
+
+#include <QObject>
+#include <QImage>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+
+#include "PdfThumbnailWorker.h"
+
+#include <deque>
+
+// 后台缩略图生成：在线程池中解码/绘制，完成后在界面线程发出 thumbnailReady
+// 任务按优先级排队：视图绘制时请求的行最先处理，其次是 schedule() 给出的可见范围及预取区
+class ThumbnailLoader : public QObject {
+    Q_OBJECT
+public:
+    explicit ThumbnailLoader(QObject *parent = nullptr);
+    ~ThumbnailLoader() override;
+
+    // 提交单个任务并放到队首（可在任意线程调用）；同一路径在完成前只会排队一次
+    void request(const QString &filePath);
+
+    // 用按优先级排好的路径替换整个等待队列，不在其中的旧任务直接丢弃
+    void schedule(const QStringList &orderedPaths);
+    void cancelAll();
+
+    // 缩略图按该设备像素比生成（界面线程设置）
+    void setDevicePixelRatio(qreal dpr);
+
+    // PDF 缩略图的文件大小上限和加载超时，超出时显示占位图
+    void setPdfLimits(qint64 maxFileBytes, int timeoutMs);
+
+signals:
+    // image 为空表示该文件无法生成缩略图；typeKey 非空表示 image 是按类型共享的占位图标
+    void thumbnailReady(const QString &filePath, const QImage &image, const QString &typeKey);
+
+private:
+    // 调用方需持有 m_mutex
+    void startWorkers();
+    void workerLoop();
+    // 保存结果并通知界面线程（在工作线程中调用）
+    void finishJob(const QString &filePath, quint64 generation, const QImage &image, const QString &typeKey);
+
+    QThreadPool m_pool;
+    QMutex m_mutex;
+    std::deque<QString> m_queue;
+    QSet<QString> m_queued;
+    QSet<QString> m_running;
+    int m_activeWorkers {0};
+    // cancelAll() 时递增，丢弃旧目录中仍在生成的结果
+    quint64 m_generation {0};
+    qreal m_devicePixelRatio {1.0};
+    // 放在最后，先于其它成员析构：析构时等待仍在渲染的 PDF 任务结束
+    PdfThumbnailWorker m_pdfWorker;
+};
+
+#endif // THUMBNAILLOADER_H
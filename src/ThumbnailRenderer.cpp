@@ -0,0 +1,450 @@
+#include "ThumbnailRenderer.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QFont>
+#include <QFontInfo>
+#include <QHash>
+#include <QImageIOHandler>
+#include <QImageReader>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPolygonF>
+#include <QSet>
+#include <QTextStream>
+#include <QTransform>
+
+#include <cstring>
+
+namespace {
+// 缩略图画布尺寸（文档比例 5:6）及纸张区域
+const QSize kCanvasSize(80, 96);
+const QRectF kDocRect(4, 4, 72, 88);
+
+// EXIF 位于 JPEG 开头的 APP1 段，只需读取文件头部
+constexpr qint64 kExifScanBytes = 128 * 1024;
+
+quint16 readU16(const uchar *p, bool littleEndian) {
+    return littleEndian ? quint16(p[0] | (p[1] << 8)) : quint16((p[0] << 8) | p[1]);
+}
+
+quint32 readU32(const uchar *p, bool littleEndian) {
+    return littleEndian
+        ? quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24)
+        : (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+// 预先绘制好的纸张模板及与文件内容无关的占位图标，按尺寸/类型和设备像素比缓存，所有缩略图共享
+QMutex g_templateMutex;
+QHash<QString, QImage> g_templates;
+
+QString templateKey(const QString &name, const QSize &size, qreal dpr) {
+    return QString("%1@%2x%3@%4").arg(name).arg(size.width()).arg(size.height()).arg(dpr);
+}
+
+QImage cachedTemplate(const QString &key) {
+    QMutexLocker locker(&g_templateMutex);
+    return g_templates.value(key);
+}
+
+QImage storeTemplate(const QString &key, const QImage &image) {
+    QMutexLocker locker(&g_templateMutex);
+    // 多个线程同时生成时保留先写入的那份，保证共享同一份像素数据
+    auto it = g_templates.constFind(key);
+    if (it != g_templates.constEnd()) return it.value();
+    g_templates.insert(key, image);
+    return image;
+}
+
+// 在内容区域内按比例居中绘制图像（image 为物理像素尺寸）
+void drawFitted(QPainter &painter, const QRectF &contentRect, const QImage &image, qreal dpr) {
+    const QImage scaled = image.scaled(
+        (contentRect.size() * dpr).toSize(),
+        Qt::KeepAspectRatio,
+        Qt::SmoothTransformation
+    );
+    const QSizeF logical = QSizeF(scaled.size()) / dpr;
+    const QPointF pos = contentRect.center() - QPointF(logical.width() / 2, logical.height() / 2);
+    painter.drawImage(QRectF(pos, logical), scaled);
+}
+
+// 与 QImageReader::setAutoTransform 相同的方向处理
+QImage applyTransformation(QImage image, QImageIOHandler::Transformations t) {
+    if (t == QImageIOHandler::TransformationNone) return image;
+    if (t == QImageIOHandler::TransformationRotate270) {
+        return image.transformed(QTransform().rotate(270));
+    }
+    image = image.mirrored(t & QImageIOHandler::TransformationMirror, t & QImageIOHandler::TransformationFlip);
+    if (t & QImageIOHandler::TransformationRotate90) {
+        image = image.transformed(QTransform().rotate(90));
+    }
+    return image;
+}
+}
+
+bool ThumbnailRenderer::isImageFile(const QString &filePath) {
+    // 支持的格式列表只查询一次，避免每次调用都重新构造
+    static const QSet<QByteArray> formats = [] {
+        const QList<QByteArray> list = QImageReader::supportedImageFormats();
+        return QSet<QByteArray>(list.begin(), list.end());
+    }();
+    return formats.contains(QFileInfo(filePath).suffix().toLower().toUtf8());
+}
+
+bool ThumbnailRenderer::isTextFile(const QString &filePath) {
+    static const QSet<QString> textTypes = {"txt", "md", "cpp", "h", "hpp", "c", "py", "js", "ts", "html", "css", "xml", "json", "yml", "yaml", "ini", "conf", "log", "sh", "bat"};
+    return textTypes.contains(QFileInfo(filePath).suffix().toLower());
+}
+
+bool ThumbnailRenderer::isDocumentSuffix(const QString &suffix) {
+    static const QSet<QString> types = {
+        "doc", "docx", "txt", "rtf", "odt",
+        "xls", "xlsx", "ods", "csv",
+        "ppt", "pptx", "odp"
+    };
+    return types.contains(suffix);
+}
+
+bool ThumbnailRenderer::hasContentThumbnail(const QString &filePath) {
+    return isImageFile(filePath) || isTextFile(filePath) || isPdfFile(filePath);
+}
+
+bool ThumbnailRenderer::isPdfFile(const QString &filePath) {
+    return QFileInfo(filePath).suffix().compare("pdf", Qt::CaseInsensitive) == 0;
+}
+
+QImage ThumbnailRenderer::render(const QString &filePath, qreal dpr, QString *typeKey) {
+    const QString ext = QFileInfo(filePath).suffix().toLower();
+    if (typeKey) typeKey->clear();
+    QImage result;
+    if (isImageFile(filePath)) {
+        result = renderImage(filePath, dpr);
+    } else if (isPdfFile(filePath)) {
+        // PDF 首页由 PdfThumbnailWorker 在专用线程池中渲染，这里只给出占位图
+        return renderPdfThumbnail(QImage(), dpr, typeKey);
+    } else if (isTextFile(filePath)) {
+        result = renderText(filePath, dpr);
+    }
+
+    // 空文本等无法预览内容的文档，退回到通用文档图标
+    if (result.isNull() && isDocumentSuffix(ext)) {
+        if (typeKey) *typeKey = documentTypeKey(ext);
+        return renderDocumentIcon(ext, dpr);
+    }
+    return result;
+}
+
+QImage ThumbnailRenderer::readExifThumbnail(const QString &filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return QImage();
+    const QByteArray head = file.read(kExifScanBytes);
+    const auto *data = reinterpret_cast<const uchar *>(head.constData());
+    const qint64 size = head.size();
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) return QImage(); // 不是 JPEG
+
+    // 依次遍历 JPEG 段，查找 APP1 "Exif\0\0"
+    qint64 pos = 2;
+    while (pos + 4 <= size && data[pos] == 0xFF) {
+        const uchar marker = data[pos + 1];
+        const qint64 segLen = readU16(data + pos + 2, false);
+        if (marker == 0xDA || segLen < 2) break; // 图像数据开始
+        const qint64 segStart = pos + 4;
+        const qint64 segEnd = qMin(size, pos + 2 + segLen);
+        if (marker == 0xE1 && segEnd - segStart > 14 && memcmp(data + segStart, "Exif\0\0", 6) == 0) {
+            const uchar *tiff = data + segStart + 6;
+            const qint64 tiffLen = segEnd - segStart - 6;
+            const bool le = tiff[0] == 'I' && tiff[1] == 'I';
+            if (!le && !(tiff[0] == 'M' && tiff[1] == 'M')) return QImage();
+
+            // IFD0 之后的链接指向 IFD1，缩略图信息在 IFD1 中。
+            // 偏移量来自文件内容，边界检查一律用 qint64，避免接近 0xFFFFFFFF 的偏移在 32 位运算中回绕
+            const quint32 ifd0 = readU32(tiff + 4, le);
+            if (qint64(ifd0) + 2 > tiffLen) return QImage();
+            const quint16 count0 = readU16(tiff + ifd0, le);
+            const qint64 nextPos = qint64(ifd0) + 2 + qint64(count0) * 12;
+            if (nextPos + 4 > tiffLen) return QImage();
+            const quint32 ifd1 = readU32(tiff + nextPos, le);
+            if (ifd1 == 0 || qint64(ifd1) + 2 > tiffLen) return QImage();
+
+            quint32 thumbOffset = 0, thumbLength = 0;
+            const quint16 count1 = readU16(tiff + ifd1, le);
+            for (quint16 i = 0; i < count1; ++i) {
+                const qint64 entry = qint64(ifd1) + 2 + qint64(i) * 12;
+                if (entry + 12 > tiffLen) break;
+                const quint16 tag = readU16(tiff + entry, le);
+                if (tag == 0x0201) thumbOffset = readU32(tiff + entry + 8, le);      // JPEGInterchangeFormat
+                else if (tag == 0x0202) thumbLength = readU32(tiff + entry + 8, le); // JPEGInterchangeFormatLength
+            }
+            if (thumbOffset == 0 || thumbLength == 0 || qint64(thumbOffset) + qint64(thumbLength) > tiffLen) {
+                return QImage();
+            }
+            return QImage::fromData(tiff + thumbOffset, int(thumbLength), "JPEG");
+        }
+        pos += 2 + segLen;
+    }
+    return QImage();
+}
+
+QImage ThumbnailRenderer::decodeScaled(const QString &filePath, const QSize &bound) {
+    QImageReader reader(filePath);
+    // transformation() 只解析文件头中的 EXIF 方向
+    const QImageIOHandler::Transformations transform = reader.transformation();
+
+    // 内嵌缩略图足够大时直接使用，完全跳过主图解码
+    const QImage exifThumb = readExifThumbnail(filePath);
+    if (!exifThumb.isNull()) {
+        const QImage oriented = applyTransformation(exifThumb, transform);
+        if (oriented.width() >= bound.width() || oriented.height() >= bound.height()) {
+            return oriented.scaled(bound, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+    }
+
+    reader.setAutoTransform(true);
+    QSize sourceSize = reader.size();
+    if (sourceSize.isValid()) {
+        // setScaledSize 作用于旋转前的图像
+        QSize target = bound;
+        if (transform & QImageIOHandler::TransformationRotate90) {
+            target.transpose();
+        }
+        if (sourceSize.width() > target.width() || sourceSize.height() > target.height()) {
+            reader.setScaledSize(sourceSize.scaled(target, Qt::KeepAspectRatio));
+        }
+    }
+    return reader.read();
+}
+
+QImage ThumbnailRenderer::documentFrame(const QSize &size, qreal dpr) {
+    const QString key = templateKey("frame", size, dpr);
+    QImage frame = cachedTemplate(key);
+    if (!frame.isNull()) return frame;
+
+    // 透明画布 + 阴影、白色纸张和折角，只在首次使用某个尺寸/像素比时绘制
+    frame = QImage((QSizeF(size) * dpr).toSize(), QImage::Format_ARGB32_Premultiplied);
+    frame.setDevicePixelRatio(dpr);
+    frame.fill(Qt::transparent);
+    {
+        QPainter painter(&frame);
+        paintDocumentFrame(painter, QRectF(QPointF(0, 0), QSizeF(size)).adjusted(4, 4, -4, -4));
+    }
+    return storeTemplate(key, frame);
+}
+
+void ThumbnailRenderer::paintDocumentFrame(QPainter &painter, const QRectF &docRect) {
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // 绘制阴影
+    painter.setBrush(QColor(0, 0, 0, 40));
+    painter.setPen(Qt::NoPen);
+    painter.drawRoundedRect(docRect.translated(2, 2), 4, 4);
+
+    // 绘制白色纸张背景
+    painter.setBrush(Qt::white);
+    painter.setPen(QPen(QColor(200, 200, 200), 1));
+    painter.drawRoundedRect(docRect, 4, 4);
+
+    // 绘制右上角折叠效果
+    QPolygonF foldTriangle;
+    foldTriangle << QPointF(docRect.right() - 12, docRect.top())
+                 << QPointF(docRect.right(), docRect.top() + 12)
+                 << QPointF(docRect.right(), docRect.top());
+    painter.setBrush(QColor(230, 230, 230));
+    painter.setPen(QPen(QColor(200, 200, 200), 1));
+    painter.drawPolygon(foldTriangle);
+}
+
+QImage ThumbnailRenderer::renderImage(const QString &filePath, qreal dpr) {
+    // 在纸张内部绘制缩略图内容
+    const QRectF contentRect = kDocRect.adjusted(6, 8, -6, -8);
+
+    const QImage original = decodeScaled(filePath, (contentRect.size() * dpr).toSize());
+    if (original.isNull()) return QImage();
+
+    // 复制纸张模板（写时复制，只拷贝像素，不再重复抗锯齿绘制）
+    QImage canvas = documentFrame(kCanvasSize, dpr);
+    QPainter painter(&canvas);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    // 居中绘制缩略图（解码结果已不超过该区域，这里只放大小图）
+    drawFitted(painter, contentRect, original, dpr);
+    return canvas;
+}
+
+QSize ThumbnailRenderer::pdfPageBound(qreal dpr) {
+    return (QSizeF(60, 72) * dpr).toSize();
+}
+
+QImage ThumbnailRenderer::renderPdfThumbnail(const QImage &firstPage, qreal dpr, QString *typeKey, const QString &label) {
+    if (typeKey) typeKey->clear();
+    if (firstPage.isNull()) {
+        // 如果PDF预览失败，使用模拟内容
+        if (typeKey) *typeKey = "pdf";
+        return renderPdfPlaceholder(dpr);
+    }
+
+    QImage canvas = documentFrame(kCanvasSize, dpr);
+    QPainter painter(&canvas);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // 在纸张内部居中绘制PDF内容
+    const QRectF contentRect = kDocRect.adjusted(6, 8, -6, -12);
+    drawFitted(painter, contentRect, firstPage, dpr);
+
+    // 绘制类型标识（办公文档转换得到的首页标注原文件的扩展名）
+    painter.setFont(QFont("Arial", 7, QFont::Bold));
+    painter.setPen(QColor(220, 53, 69));
+    painter.drawText(kDocRect.adjusted(6, kDocRect.height() - 16, -6, -4),
+                     Qt::AlignLeft | Qt::AlignBottom, label);
+    return canvas;
+}
+
+QImage ThumbnailRenderer::renderPdfPlaceholder(qreal dpr) {
+    // 与文件内容无关，每种像素比只绘制一次
+    const QString key = templateKey("pdf", kCanvasSize, dpr);
+    const QImage cached = cachedTemplate(key);
+    if (!cached.isNull()) return cached;
+
+    QImage canvas = documentFrame(kCanvasSize, dpr);
+    QPainter painter(&canvas);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // 绘制PDF内容样式（模拟文本行）
+    painter.setPen(QPen(QColor(100, 100, 100), 1));
+    const QRectF contentRect = kDocRect.adjusted(8, 12, -8, -8);
+
+    // 绘制标题区域
+    painter.setBrush(QColor(220, 220, 220));
+    painter.drawRect(QRectF(contentRect.left(), contentRect.top(), contentRect.width(), 8));
+
+    // 绘制文本行
+    for (int i = 0; i < 8; ++i) {
+        const qreal y = contentRect.top() + 16 + i * 6;
+        const qreal width = contentRect.width() * (0.7 + (i % 3) * 0.1);
+        painter.drawLine(QPointF(contentRect.left(), y), QPointF(contentRect.left() + width, y));
+    }
+
+    // 绘制PDF标识
+    painter.setFont(QFont("Arial", 8, QFont::Bold));
+    painter.setPen(QColor(220, 53, 69)); // PDF红色
+    painter.drawText(contentRect.adjusted(0, contentRect.height() - 16, 0, 0),
+                     Qt::AlignLeft | Qt::AlignBottom, "PDF");
+    painter.end();
+    return storeTemplate(key, canvas);
+}
+
+QImage ThumbnailRenderer::renderText(const QString &filePath, qreal dpr) {
+    // 读取文件内容
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text) || file.size() >= 1024 * 1024) { // 限制1MB
+        return QImage();
+    }
+    QTextStream stream(&file);
+    // Qt6 中不再需要 setCodec，默认使用 UTF-8
+    const QString content = stream.read(2000); // 读取前2000个字符
+    file.close();
+    if (content.isEmpty()) return QImage();
+
+    QImage canvas = documentFrame(kCanvasSize, dpr);
+    QPainter painter(&canvas);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    // 绘制真实文本内容
+    const QRectF contentRect = kDocRect.adjusted(6, 8, -6, -12);
+
+    // 设置字体
+    QFont font("Consolas", 5); // 使用等宽字体
+    if (!QFontInfo(font).exactMatch()) {
+        font = QFont("Courier New", 5);
+    }
+    if (!QFontInfo(font).exactMatch()) {
+        font = QFont("monospace", 5);
+    }
+    painter.setFont(font);
+
+    // 设置文本颜色
+    painter.setPen(QColor(60, 60, 60));
+
+    // 分行显示文本
+    const QStringList lines = content.split('\n');
+    const int maxLines = qMin(lines.size(), 12); // 最多显示12行
+
+    for (int i = 0; i < maxLines; ++i) {
+        QString line = lines[i];
+        if (line.length() > 15) {
+            line = line.left(15) + "...";
+        }
+
+        const QRectF lineRect(contentRect.left(),
+                              contentRect.top() + i * 6,
+                              contentRect.width(), 6);
+
+        painter.drawText(lineRect, Qt::AlignLeft | Qt::AlignTop, line);
+    }
+
+    // 绘制文件类型标识
+    painter.setFont(QFont("Arial", 7, QFont::Bold));
+    painter.setPen(QColor(70, 130, 180));
+    painter.drawText(kDocRect.adjusted(6, kDocRect.height() - 16, -6, -4),
+                     Qt::AlignLeft | Qt::AlignBottom, QFileInfo(filePath).suffix().toUpper());
+    return canvas;
+}
+
+QImage ThumbnailRenderer::renderDocumentIcon(const QString &suffix, qreal dpr) {
+    const QString ext = suffix.toLower();
+    static const QStringList docTypes = {"doc", "docx", "txt", "rtf", "odt"};
+    static const QStringList spreadsheetTypes = {"xls", "xlsx", "ods", "csv"};
+    static const QStringList presentationTypes = {"ppt", "pptx", "odp"};
+
+    // 只依赖扩展名，每种类型/像素比只绘制一次
+    const QString key = templateKey("doc-" + ext, kCanvasSize, dpr);
+    const QImage cached = cachedTemplate(key);
+    if (!cached.isNull()) return cached;
+
+    QImage canvas = documentFrame(kCanvasSize, dpr);
+    QPainter painter(&canvas);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // 根据文件类型绘制不同的内容
+    const QRectF contentRect = kDocRect.adjusted(8, 12, -8, -8);
+
+    if (docTypes.contains(ext)) {
+        // 文档类型 - 绘制文本行
+        painter.setPen(QPen(QColor(100, 100, 100), 1));
+        for (int i = 0; i < 10; ++i) {
+            const qreal y = contentRect.top() + i * 6;
+            const qreal width = contentRect.width() * (0.8 + (i % 3) * 0.1);
+            painter.drawLine(QPointF(contentRect.left(), y), QPointF(contentRect.left() + width, y));
+        }
+    } else if (spreadsheetTypes.contains(ext)) {
+        // 表格类型 - 绘制网格
+        painter.setPen(QPen(QColor(150, 150, 150), 1));
+        for (int i = 0; i <= 4; ++i) {
+            const qreal x = contentRect.left() + i * (contentRect.width() / 4);
+            painter.drawLine(QPointF(x, contentRect.top()), QPointF(x, contentRect.bottom()));
+        }
+        for (int i = 0; i <= 6; ++i) {
+            const qreal y = contentRect.top() + i * (contentRect.height() / 6);
+            painter.drawLine(QPointF(contentRect.left(), y), QPointF(contentRect.right(), y));
+        }
+    } else if (presentationTypes.contains(ext)) {
+        // 演示文稿类型 - 绘制幻灯片样式
+        painter.setBrush(QColor(240, 240, 240));
+        painter.setPen(QPen(QColor(200, 200, 200), 1));
+        const QRectF slideRect = contentRect.adjusted(4, 4, -4, -20);
+        painter.drawRect(slideRect);
+
+        // 绘制标题区域
+        painter.setBrush(QColor(220, 220, 220));
+        painter.drawRect(QRectF(slideRect.left(), slideRect.top(), slideRect.width(), 12));
+    }
+
+    // 绘制文件类型标识
+    painter.setFont(QFont("Arial", 7, QFont::Bold));
+    painter.setPen(QColor(70, 130, 180));
+    painter.drawText(contentRect.adjusted(0, contentRect.height() - 12, 0, 0),
+                     Qt::AlignLeft | Qt::AlignBottom, ext.toUpper());
+    painter.end();
+    return storeTemplate(key, canvas);
+}
@@ -0,0 +1,49 @@
+#ifndef THUMBNAILRENDERER_H
+#define THUMBNAILRENDERER_H
+
+#include <QImage>
+#include <QString>
+
+class QPainter;
+class QRectF;
+
+// 缩略图绘制：只使用 QImage/QPainter，可在后台线程中调用
+class ThumbnailRenderer {
+public:
+    // 需要读取文件内容才能生成的缩略图（图片、PDF、文本），应交给后台线程生成
+    static bool hasContentThumbnail(const QString &filePath);
+
+    // 生成文件缩略图（dpr 为设备像素比，图像尺寸为 80x96 * dpr）；无法生成时返回空图像。
+    // 结果是与文件内容无关的类型图标（PDF 占位图、通用文档图标）时，typeKey 返回类型键，调用方可按类型共享
+    static QImage render(const QString &filePath, qreal dpr, QString *typeKey = nullptr);
+
+    // 文档/表格/演示文稿的通用图标，只依赖扩展名，不读取文件内容；同一类型返回共享的同一份图像
+    static bool isDocumentSuffix(const QString &suffix);
+    static QImage renderDocumentIcon(const QString &suffix, qreal dpr);
+    static QString documentTypeKey(const QString &suffix) { return "doc-" + suffix.toLower(); }
+
+    static bool isImageFile(const QString &filePath);
+    static bool isTextFile(const QString &filePath);
+    static bool isPdfFile(const QString &filePath);
+
+    // PDF 首页渲染尺寸上限（物理像素），以及把首页图像放入纸张模板（左下角标注 label）；firstPage 为空时返回按类型共享的占位图
+    static QSize pdfPageBound(qreal dpr);
+    static QImage renderPdfThumbnail(const QImage &firstPage, qreal dpr, QString *typeKey = nullptr,
+                                     const QString &label = QStringLiteral("PDF"));
+
+    // 按目标尺寸解码图片（保持比例，不超过 bound）：优先使用 JPEG 内嵌的 EXIF 缩略图，
+    // 否则通过 QImageReader::setScaledSize 让解码器直接输出小图，内存和耗时与原图分辨率无关
+    static QImage decodeScaled(const QString &filePath, const QSize &bound);
+
+private:
+    static QImage readExifThumbnail(const QString &filePath);
+    static QImage renderImage(const QString &filePath, qreal dpr);
+    static QImage renderPdfPlaceholder(qreal dpr);
+    static QImage renderText(const QString &filePath, qreal dpr);
+
+    // 纸张模板（透明画布 + 阴影、白色纸张和折角），按尺寸和像素比各绘制一次后共享
+    static QImage documentFrame(const QSize &size, qreal dpr);
+    static void paintDocumentFrame(QPainter &painter, const QRectF &docRect);
+};
+
+#endif // THUMBNAILRENDERER_H
@@ -0,0 +1,147 @@
+#include "TreemapWidget.h"
+#include "FileSizeFormat.h"
+
+#include <QColor>
+#include <QFontMetrics>
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+// 一行中最差（最细长）矩形的长宽比，squarified 算法据此决定是否换行
+qreal worstRatio(const QVector<qreal> &row, qreal side) {
+    if (row.isEmpty()) return std::numeric_limits<qreal>::max();
+    const auto [minIt, maxIt] = std::minmax_element(row.begin(), row.end());
+    qreal sum = 0;
+    for (qreal area : row) sum += area;
+    const qreal side2 = side * side;
+    const qreal sum2 = sum * sum;
+    return qMax(side2 * *maxIt / sum2, sum2 / (side2 * *minIt));
+}
+}
+
+TreemapWidget::TreemapWidget(QWidget *parent) : QWidget(parent) {
+    setMinimumSize(200, 150);
+    setMouseTracking(true);
+}
+
+void TreemapWidget::setItems(const QVector<Item> &items) {
+    m_items.clear();
+    for (const Item &item : items) {
+        if (item.value > 0) m_items.append(item);
+    }
+    layoutItems();
+    update();
+}
+
+void TreemapWidget::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    layoutItems();
+}
+
+void TreemapWidget::layoutItems() {
+    m_rects.fill(QRectF(), m_items.size());
+    qint64 total = 0;
+    for (const Item &item : m_items) total += item.value;
+    QRectF remaining = QRectF(rect()).adjusted(1, 1, -1, -1);
+    if (total <= 0 || remaining.isEmpty()) return;
+
+    // 把数值换算成面积
+    const qreal scale = remaining.width() * remaining.height() / qreal(total);
+    QVector<qreal> areas;
+    areas.reserve(m_items.size());
+    for (const Item &item : m_items) areas.append(item.value * scale);
+
+    int start = 0;
+    while (start < areas.size()) {
+        // 沿较短边排一行，加入下一项会让该行更细长时结束本行
+        const qreal side = qMin(remaining.width(), remaining.height());
+        QVector<qreal> row;
+        int end = start;
+        while (end < areas.size()) {
+            QVector<qreal> candidate = row;
+            candidate.append(areas[end]);
+            if (!row.isEmpty() && worstRatio(candidate, side) > worstRatio(row, side)) break;
+            row = candidate;
+            ++end;
+        }
+
+        qreal rowArea = 0;
+        for (qreal area : row) rowArea += area;
+        const bool horizontal = remaining.width() >= remaining.height();
+        const qreal thickness = rowArea / side;
+        qreal offset = 0;
+        for (int i = start; i < end; ++i) {
+            const qreal length = areas[i] / thickness;
+            m_rects[i] = horizontal
+                ? QRectF(remaining.left(), remaining.top() + offset, thickness, length)
+                : QRectF(remaining.left() + offset, remaining.top(), length, thickness);
+            offset += length;
+        }
+        remaining = horizontal ? remaining.adjusted(thickness, 0, 0, 0) : remaining.adjusted(0, thickness, 0, 0);
+        start = end;
+    }
+}
+
+void TreemapWidget::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    painter.setFont(font());
+    const QFontMetrics metrics = painter.fontMetrics();
+
+    for (int i = 0; i < m_items.size(); ++i) {
+        const QRectF r = m_rects[i];
+        if (r.width() < 1 || r.height() < 1) continue;
+        // 颜色由名称决定，刷新部分结果时同一目录颜色不变
+        const QColor color = m_items[i].activatable
+            ? QColor::fromHsv(int(qHash(m_items[i].label) % 360), 90, 225)
+            : QColor(210, 210, 210);
+        painter.fillRect(r, color);
+        painter.setPen(color.darker(140));
+        painter.drawRect(r);
+
+        // 放得下时显示名称和大小
+        if (r.width() > 40 && r.height() > metrics.height() + 4) {
+            painter.setPen(Qt::black);
+            const QRectF textRect = r.adjusted(4, 2, -4, -2);
+            const QString text = metrics.elidedText(m_items[i].label, Qt::ElideMiddle, int(textRect.width()));
+            painter.drawText(textRect, Qt::AlignLeft | Qt::AlignTop, text);
+            if (r.height() > 2 * metrics.height() + 4) {
+                painter.drawText(textRect.adjusted(0, metrics.height(), 0, 0), Qt::AlignLeft | Qt::AlignTop,
+                                 FileSizeFormat::format(m_items[i].value));
+            }
+        }
+    }
+}
+
+int TreemapWidget::itemAt(const QPointF &pos) const {
+    for (int i = 0; i < m_rects.size(); ++i) {
+        if (m_rects[i].contains(pos)) return i;
+    }
+    return -1;
+}
+
+void TreemapWidget::mouseDoubleClickEvent(QMouseEvent *event) {
+    const int index = itemAt(event->pos());
+    if (index >= 0 && m_items[index].activatable) {
+        emit itemActivated(m_items[index].id);
+    }
+}
+
+bool TreemapWidget::event(QEvent *event) {
+    if (event->type() == QEvent::ToolTip) {
+        auto *help = static_cast<QHelpEvent *>(event);
+        const int index = itemAt(help->pos());
+        if (index >= 0) {
+            QToolTip::showText(help->globalPos(), m_items[index].label + "\n" + FileSizeFormat::format(m_items[index].value), this);
+        } else {
+            QToolTip::hideText();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
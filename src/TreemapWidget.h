@@ -0,0 +1,42 @@
+#ifndef TREEMAPWIDGET_H
+#define TREEMAPWIDGET_H
+
+#include <QWidget>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+
+// 矩形树图：按 squarified 算法把各项按大小铺满控件，矩形尽量接近正方形便于比较
+class TreemapWidget : public QWidget {
+    Q_OBJECT
+public:
+    struct Item {
+        QString label;
+        qint64 value {0};
+        quint32 id {0};
+        bool activatable {true};  // 可双击进入（如子目录）；“文件”汇总块不可进入
+    };
+
+    explicit TreemapWidget(QWidget *parent = nullptr);
+
+    // 项应按 value 降序排列
+    void setItems(const QVector<Item> &items);
+
+signals:
+    void itemActivated(quint32 id);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    bool event(QEvent *event) override;
+
+private:
+    void layoutItems();
+    int itemAt(const QPointF &pos) const;
+
+    QVector<Item> m_items;
+    QVector<QRectF> m_rects;  // 与 m_items 一一对应
+};
+
+#endif // TREEMAPWIDGET_H
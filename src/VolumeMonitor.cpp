@@ -0,0 +1,200 @@
+#include "VolumeMonitor.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSocketNotifier>
+#include <QStorageInfo>
+#include <QTimer>
+
+#include <thread>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+struct VolumeMonitor::Channel {
+    QMutex mutex;
+    VolumeMonitor *owner {nullptr};
+};
+
+namespace {
+#ifdef Q_OS_LINUX
+// mountinfo 中的空格、制表符、换行和反斜杠写作 \ooo
+QString decodeMountField(const QByteArray &field) {
+    QByteArray out;
+    out.reserve(field.size());
+    for (int i = 0; i < field.size(); ++i) {
+        if (field[i] == '\\' && i + 3 < field.size()
+            && field[i + 1] >= '0' && field[i + 1] <= '7'
+            && field[i + 2] >= '0' && field[i + 2] <= '7'
+            && field[i + 3] >= '0' && field[i + 3] <= '7') {
+            out.append(char(((field[i + 1] - '0') << 6) | ((field[i + 2] - '0') << 3) | (field[i + 3] - '0')));
+            i += 3;
+        } else {
+            out.append(field[i]);
+        }
+    }
+    return QFile::decodeName(out);
+}
+#endif
+}
+
+VolumeMonitor::VolumeMonitor(QObject *parent) : QObject(parent), m_channel(std::make_shared<Channel>()) {
+    m_channel->owner = this;
+}
+
+VolumeMonitor::~VolumeMonitor() {
+    {
+        QMutexLocker locker(&m_channel->mutex);
+        m_channel->owner = nullptr;
+    }
+#ifdef Q_OS_LINUX
+    if (m_mountInfoFd >= 0) ::close(m_mountInfoFd);
+#endif
+}
+
+void VolumeMonitor::start() {
+    if (m_started) return;
+#ifdef Q_OS_LINUX
+    m_mountInfoFd = ::open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+    if (m_mountInfoFd >= 0) {
+        // 挂载表变化时 poll 报告 POLLPRI，对应 QSocketNotifier::Exception
+        m_notifier = new QSocketNotifier(m_mountInfoFd, QSocketNotifier::Exception, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &VolumeMonitor::readMountChanges);
+    }
+#endif
+    readMountChanges();
+    m_started = true;
+    if (m_initialProbes.isEmpty()) emit initialScanFinished();
+}
+
+bool VolumeMonitor::isPseudoFileSystem(const MountEntry &mount) {
+    // 内核虚拟文件系统没有容量可查；autofs 被访问时才挂载，查询它会触发挂载
+    static const QSet<QString> pseudo = {
+        "autofs", "binfmt_misc", "bpf", "cgroup", "cgroup2", "configfs", "debugfs", "devpts", "devtmpfs",
+        "efivarfs", "fusectl", "hugetlbfs", "mqueue", "nsfs", "proc", "pstore", "rpc_pipefs", "securityfs",
+        "sysfs", "tracefs",
+    };
+    if (pseudo.contains(mount.fileSystemType)) return true;
+    return mount.rootPath.startsWith("/proc/") || mount.rootPath.startsWith("/sys/") || mount.rootPath.startsWith("/dev/");
+}
+
+QList<VolumeMonitor::MountEntry> VolumeMonitor::readMountTable() const {
+    QList<MountEntry> table;
+#ifdef Q_OS_LINUX
+    if (m_mountInfoFd < 0) return table;
+    // 从头重新读取；读取同时让内核重新开始报告之后的变化
+    QByteArray content;
+    char buffer[16 * 1024];
+    ::lseek(m_mountInfoFd, 0, SEEK_SET);
+    for (;;) {
+        const ssize_t n = ::read(m_mountInfoFd, buffer, sizeof(buffer));
+        if (n <= 0) break;
+        content.append(buffer, int(n));
+    }
+    // 格式：ID 父ID 主:次设备号 根 挂载点 选项 [可选字段...] - 文件系统类型 来源 超级块选项
+    for (const QByteArray &line : content.split('\n')) {
+        const QList<QByteArray> fields = line.split(' ');
+        const int separator = fields.indexOf("-");
+        if (fields.size() < 5 || separator < 6 || separator + 2 >= fields.size()) continue;
+        MountEntry mount;
+        mount.mountId = QString::fromLatin1(fields[0]);
+        mount.rootPath = decodeMountField(fields[4]);
+        mount.fileSystemType = QString::fromLatin1(fields[separator + 1]);
+        mount.device = decodeMountField(fields[separator + 2]);
+        table.append(mount);
+    }
+#else
+    // 其它平台的挂载表由 QStorageInfo 枚举，不会查询容量
+    for (const QStorageInfo &storage : QStorageInfo::mountedVolumes()) {
+        MountEntry mount;
+        mount.mountId = storage.rootPath();
+        mount.rootPath = storage.rootPath();
+        mount.fileSystemType = QString::fromLatin1(storage.fileSystemType());
+        mount.device = QString::fromLatin1(storage.device());
+        table.append(mount);
+    }
+#endif
+    return table;
+}
+
+void VolumeMonitor::readMountChanges() {
+    // 按挂载顺序列出，同一挂载点后出现的覆盖先出现的
+    QHash<QString, MountEntry> current;
+    for (const MountEntry &mount : readMountTable()) current.insert(mount.rootPath, mount);
+
+    for (auto it = m_mounts.begin(); it != m_mounts.end();) {
+        const auto now = current.constFind(it.key());
+        if (now != current.constEnd() && now->mountId == it->mountId && now->device == it->device) {
+            current.remove(it.key());
+            ++it;
+            continue;
+        }
+        // 已卸载或被另一次挂载替换；尚未返回的查询结果会因编号不符被丢弃
+        finishInitialProbe(it->probe);
+        if (m_volumes.remove(it.key())) emit volumeRemoved(it.key());
+        it = m_mounts.erase(it);
+    }
+
+    for (MountEntry &mount : current) {
+        if (!isPseudoFileSystem(mount)) {
+            mount.probe = ++m_nextProbe;
+            probe(mount);
+        }
+        m_mounts.insert(mount.rootPath, mount);
+    }
+}
+
+void VolumeMonitor::probe(const MountEntry &mount) {
+    // 首次发现时每个挂载点最多等待 kProbeTimeoutMs；之后出现的挂载点查到后直接加入，无需等待
+    if (!m_started) {
+        m_initialProbes.insert(mount.probe);
+        QTimer::singleShot(kProbeTimeoutMs, this, [this, root = mount.rootPath, id = mount.probe]() {
+            onProbeTimeout(root, id);
+        });
+    }
+
+    // 无响应的网络文件系统上 statvfs 可能永远不返回，用独立线程而不是线程池，
+    // 卡住的线程不会占用其它任务的线程，退出程序时也不必等待它
+    std::thread([channel = m_channel, mount]() {
+        const QStorageInfo storage(mount.rootPath);
+        const bool ready = storage.isValid() && storage.isReady();
+        VolumeInfo volume;
+        volume.rootPath = mount.rootPath;
+        volume.fileSystemType = mount.fileSystemType;
+        volume.device = mount.device;
+        if (ready) {
+            volume.displayName = storage.displayName();
+            volume.bytesTotal = storage.bytesTotal();
+            volume.readOnly = storage.isReadOnly();
+        }
+        QMutexLocker locker(&channel->mutex);
+        if (!channel->owner) return;
+        VolumeMonitor *owner = channel->owner;
+        QMetaObject::invokeMethod(owner, [owner, root = mount.rootPath, id = mount.probe, ready, volume]() {
+            owner->onProbed(root, id, ready, volume);
+        }, Qt::QueuedConnection);
+    }).detach();
+}
+
+void VolumeMonitor::onProbed(const QString &rootPath, quint64 probe, bool ready, const VolumeInfo &volume) {
+    finishInitialProbe(probe);
+    const auto mount = m_mounts.constFind(rootPath);
+    if (mount == m_mounts.constEnd() || mount->probe != probe || !ready) return;
+    m_volumes.insert(rootPath, volume);
+    emit volumeAdded(volume);
+}
+
+void VolumeMonitor::onProbeTimeout(const QString &rootPath, quint64 probe) {
+    if (!m_initialProbes.contains(probe)) return;
+    qWarning() << "Volume not responding, skipped for now:" << rootPath;
+    finishInitialProbe(probe);
+}
+
+void VolumeMonitor::finishInitialProbe(quint64 probe) {
+    if (!m_initialProbes.remove(probe)) return;
+    if (m_started && m_initialProbes.isEmpty()) emit initialScanFinished();
+}
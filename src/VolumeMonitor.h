@@ -0,0 +1,78 @@
+#ifndef VOLUMEMONITOR_H
+#define VOLUMEMONITOR_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+#include <memory>
+
+class QSocketNotifier;
+
+// 已挂载且可访问的卷
+struct VolumeInfo {
+    QString rootPath;
+    QString displayName;
+    QString fileSystemType;
+    QString device;
+    qint64 bytesTotal {0};
+    bool readOnly {false};
+};
+
+// 在后台发现已挂载的卷，结果逐个通过信号送回界面线程。
+// 挂载表读自 /proc/self/mountinfo（procfs，不会访问各个文件系统）；每个挂载点各用一个线程查询容量，
+// 超过 kProbeTimeoutMs 没有返回（无响应的 NFS/CIFS 等）就不再等待，之后若返回仍会补上。
+// 挂载表变化时内核在 mountinfo 上产生 POLLPRI，只比较挂载表的差异、查询新出现的挂载点，热插拔的磁盘无需重启即可出现
+class VolumeMonitor : public QObject {
+    Q_OBJECT
+public:
+    explicit VolumeMonitor(QObject *parent = nullptr);
+    ~VolumeMonitor() override;
+
+    // 开始首次发现并监视挂载表的变化
+    void start();
+    // 目前已确认可访问的卷
+    QList<VolumeInfo> volumes() const { return m_volumes.values(); }
+    bool isInitialScanDone() const { return m_started && m_initialProbes.isEmpty(); }
+
+signals:
+    void volumeAdded(const VolumeInfo &volume);
+    void volumeRemoved(const QString &rootPath);
+    // 首次发现的每个挂载点都已返回或超时
+    void initialScanFinished();
+
+private:
+    struct MountEntry {
+        QString mountId;  // mountinfo 第一列
+        QString rootPath;
+        QString fileSystemType;
+        QString device;
+        quint64 probe {0};  // 本次挂载的查询编号，0 表示不需要查询
+    };
+    // 查询线程与监视器之间的通道：线程可能一直卡在无响应的挂载点上，监视器析构后其结果直接丢弃
+    struct Channel;
+
+    static constexpr int kProbeTimeoutMs = 3000;
+
+    static bool isPseudoFileSystem(const MountEntry &mount);
+    QList<MountEntry> readMountTable() const;
+    // 重新读取挂载表，只处理与上次相比消失、替换和新出现的挂载点
+    void readMountChanges();
+    void probe(const MountEntry &mount);
+    void onProbed(const QString &rootPath, quint64 probe, bool ready, const VolumeInfo &volume);
+    void onProbeTimeout(const QString &rootPath, quint64 probe);
+    void finishInitialProbe(quint64 probe);
+
+    QHash<QString, MountEntry> m_mounts;   // 挂载点 -> 当前挂载（重叠挂载取最上层）
+    QHash<QString, VolumeInfo> m_volumes;  // 挂载点 -> 可访问的卷
+    QSet<quint64> m_initialProbes;         // 首次发现中尚未返回也未超时的查询
+    quint64 m_nextProbe {0};
+    bool m_started {false};
+    std::shared_ptr<Channel> m_channel;
+    int m_mountInfoFd {-1};
+    QSocketNotifier *m_notifier {nullptr};
+};
+
+#endif // VOLUMEMONITOR_H